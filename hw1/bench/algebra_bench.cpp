@@ -0,0 +1,152 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+#include "algebra.h"
+#include "matrix.h"
+
+// Benchmarks of the algebra routines for int, float and double, on the
+// legacy MATRIX<T> and on the contiguous Matrix<T>.
+// Every benchmark takes (size, shape) arguments; the result of an operation
+// is size x size (square), size x 32 (tall-skinny) or 32 x size (wide), and
+// products use an inner dimension of size (square) or 32.
+// Besides the time, each run reports FLOPS (arithmetic rate, shown as
+// G/s) and bytes_per_second (matrix data read and written). Compare two
+// commits with the JSON output, e.g.
+//   algebra_bench --benchmark_out=before.json --benchmark_out_format=json
+// and Google Benchmark's tools/compare.py.
+
+using namespace algebra;
+
+namespace {
+enum Shape : int64_t { Square, TallSkinny, Wide };
+
+constexpr int64_t NARROW = 32;
+
+struct Dims {
+  std::size_t m, k, n;  // result m x n, inner dimension k
+};
+
+Dims dims(const benchmark::State& state) {
+  const std::size_t s = state.range(0);
+  switch (state.range(1)) {
+    case TallSkinny:
+      return {s, NARROW, NARROW};
+    case Wide:
+      return {NARROW, NARROW, s};
+    default:
+      return {s, s, s};
+  }
+}
+
+const char* shape_name(int64_t shape) {
+  switch (shape) {
+    case TallSkinny:
+      return "tall-skinny";
+    case Wide:
+      return "wide";
+    default:
+      return "square";
+  }
+}
+
+template <typename T, template <typename> class Storage>
+Storage<T> random_matrix(std::size_t rows, std::size_t cols) {
+  if constexpr (is_matrix_v<Storage<T>>)
+    return create_matrix<Storage<T>>(rows, cols, MatrixType::Random, T(-10),
+                                     T(10));
+  else
+    return create_matrix<T>(rows, cols, MatrixType::Random, T(-10), T(10));
+}
+
+void report(benchmark::State& state, double flops, double bytes) {
+  state.SetLabel(shape_name(state.range(1)));
+  state.counters["FLOPS"] = benchmark::Counter(
+      flops, benchmark::Counter::kIsIterationInvariantRate,
+      benchmark::Counter::OneK::kIs1000);
+  state.SetBytesProcessed(static_cast<int64_t>(bytes) * state.iterations());
+}
+
+// Sizes 8, 32, 128, 512, 2048 and 4096 in every shape
+void shapes(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"size", "shape"});
+  for (int64_t shape : {Square, TallSkinny, Wide}) {
+    for (int64_t size = 8; size <= 2048; size *= 4) b->Args({size, shape});
+    b->Args({4096, shape});
+  }
+}
+
+template <typename T, template <typename> class Storage>
+void BM_CreateMatrix(benchmark::State& state) {
+  const Dims d = dims(state);
+  for (auto _ : state) {
+    auto m = random_matrix<T, Storage>(d.m, d.n);
+    benchmark::DoNotOptimize(m);
+  }
+  report(state, 0, d.m * d.n * sizeof(T));
+}
+
+template <typename T, template <typename> class Storage>
+void BM_Multiply(benchmark::State& state) {
+  const Dims d = dims(state);
+  const auto a = random_matrix<T, Storage>(d.m, d.k);
+  const auto b = random_matrix<T, Storage>(d.k, d.n);
+  for (auto _ : state) {
+    auto c = multiply(a, b);
+    benchmark::DoNotOptimize(c);
+  }
+  report(state, 2.0 * d.m * d.k * d.n,
+         (d.m * d.k + d.k * d.n + d.m * d.n) * sizeof(T));
+}
+
+template <typename T, template <typename> class Storage>
+void BM_SumSub(benchmark::State& state) {
+  const Dims d = dims(state);
+  const auto a = random_matrix<T, Storage>(d.m, d.n);
+  const auto b = random_matrix<T, Storage>(d.m, d.n);
+  for (auto _ : state) {
+    auto c = sum_sub(a, b);
+    benchmark::DoNotOptimize(c);
+  }
+  report(state, double(d.m * d.n), 3 * d.m * d.n * sizeof(T));
+}
+
+template <typename T, template <typename> class Storage>
+void BM_Transpose(benchmark::State& state) {
+  const Dims d = dims(state);
+  const auto a = random_matrix<T, Storage>(d.m, d.n);
+  for (auto _ : state) {
+    auto c = transpose(a);
+    benchmark::DoNotOptimize(c);
+  }
+  report(state, 0, 2 * d.m * d.n * sizeof(T));
+}
+}  // namespace
+
+#define ALGEBRA_BENCH(name, T)                               \
+  BENCHMARK_TEMPLATE(name, T, MATRIX)->Apply(shapes);        \
+  BENCHMARK_TEMPLATE(name, T, Matrix)->Apply(shapes);
+
+#define ALGEBRA_BENCH_TYPES(name) \
+  ALGEBRA_BENCH(name, int)        \
+  ALGEBRA_BENCH(name, float)      \
+  ALGEBRA_BENCH(name, double)
+
+ALGEBRA_BENCH_TYPES(BM_CreateMatrix)
+ALGEBRA_BENCH_TYPES(BM_SumSub)
+ALGEBRA_BENCH_TYPES(BM_Transpose)
+
+// the square 4096 products take seconds per iteration; report milliseconds
+#define ALGEBRA_BENCH_MULTIPLY(T)                                          \
+  BENCHMARK_TEMPLATE(BM_Multiply, T, MATRIX)                               \
+      ->Apply(shapes)                                                      \
+      ->Unit(benchmark::kMillisecond);                                     \
+  BENCHMARK_TEMPLATE(BM_Multiply, T, Matrix)                               \
+      ->Apply(shapes)                                                      \
+      ->Unit(benchmark::kMillisecond);
+
+ALGEBRA_BENCH_MULTIPLY(int)
+ALGEBRA_BENCH_MULTIPLY(float)
+ALGEBRA_BENCH_MULTIPLY(double)
+
+BENCHMARK_MAIN();
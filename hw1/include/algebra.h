@@ -4,9 +4,15 @@
 #include <format>
 #include <iostream>
 #include <optional>
-#include <random>
+#include <utility>
 #include <vector>
 
+#include "gemm.h"
+#include "random.h"
+#include "simd.h"
+#include "thread_pool.h"
+#include "transpose.h"
+
 namespace algebra {
 // Matrix data structure
 template <typename T>
@@ -15,17 +21,35 @@ using MATRIX = std::vector<std::vector<T>>;
 // Matrix initialization types
 enum class MatrixType { Zeros, Ones, Identity, Random };
 
-// generate random value in matrix
-template <typename T, typename dist_type>
-static void gen_random_matrix(MATRIX<T>& matrix, std::mt19937& engine,
-                              dist_type& dist);
+// Contiguous matrix storage (see matrix.h)
+template <typename T>
+class Matrix;
+
+// True for the contiguous matrix type, used to pick create_matrix overloads
+template <typename T>
+inline constexpr bool is_matrix_v = false;
 
-// Function template for matrix initialization
 template <typename T>
+inline constexpr bool is_matrix_v<Matrix<T>> = true;
+
+// generate random value in matrix; element (i, j) is value i * cols + j of
+// the stream for `seed` (see random.h), so rows are filled in parallel
+template <typename T>
+static void gen_random_matrix(MATRIX<T>& matrix, std::uint64_t seed,
+                              T lowerBound, T upperBound);
+
+// Function template for matrix initialization. Random matrices with the
+// same seed are identical; without one a fresh seed is drawn.
+template <typename T>
+  requires(!is_matrix_v<T>)
 MATRIX<T> create_matrix(std::size_t rows, std::size_t columns,
                         std::optional<MatrixType> type = MatrixType::Zeros,
                         std::optional<T> lowerBound = std::nullopt,
-                        std::optional<T> upperBound = std::nullopt);
+                        std::optional<T> upperBound = std::nullopt,
+                        std::optional<std::uint64_t> seed = std::nullopt);
+
+// Print a single matrix cell (shared by every display overload)
+inline void display_element(double elem);
 
 // Function template for matrix display
 template <typename T>
@@ -57,25 +81,68 @@ MATRIX<T> transpose(const MATRIX<T>& matrix);
 template <typename T>
 T trace(const MATRIX<T>& matrix);
 
+// In-place variants; the first argument receives the result
+template <typename T>
+void add_inplace(MATRIX<T>& matrixA, const MATRIX<T>& matrixB);
+
+template <typename T>
+void sub_inplace(MATRIX<T>& matrixA, const MATRIX<T>& matrixB);
+
+template <typename T>
+void scale_inplace(MATRIX<T>& matrix, const T scalar);
+
+template <typename T>
+void hadamard_inplace(MATRIX<T>& matrixA, const MATRIX<T>& matrixB);
+
+// Overloads for temporaries: the result reuses the storage of an rvalue
+// argument, e.g. sum_sub(multiply(A, 2), B) allocates a single matrix
+template <typename T>
+MATRIX<T> sum_sub(MATRIX<T>&& matrixA, const MATRIX<T>& matrixB,
+                  std::optional<std::string> operation = "sum");
+
+template <typename T>
+MATRIX<T> sum_sub(const MATRIX<T>& matrixA, MATRIX<T>&& matrixB,
+                  std::optional<std::string> operation = "sum");
+
+template <typename T>
+MATRIX<T> sum_sub(MATRIX<T>&& matrixA, MATRIX<T>&& matrixB,
+                  std::optional<std::string> operation = "sum");
+
+template <typename T>
+MATRIX<T> multiply(MATRIX<T>&& matrix, const T scalar);
+
+template <typename T>
+MATRIX<T> hadamard_product(MATRIX<T>&& matrixA, const MATRIX<T>& matrixB);
+
+template <typename T>
+MATRIX<T> hadamard_product(const MATRIX<T>& matrixA, MATRIX<T>&& matrixB);
+
+template <typename T>
+MATRIX<T> hadamard_product(MATRIX<T>&& matrixA, MATRIX<T>&& matrixB);
+
 ////////////////////////////
 ////// Implementation //////
 ////////////////////////////
 
-template <typename T, typename dist_type>
-static void gen_random_matrix(MATRIX<T>& matrix, std::mt19937& engine,
-                              dist_type& dist) {
-  for (size_t i = 0; i < matrix.size(); i++) {
-    for (size_t j = 0; j < matrix[0].size(); j++) {
-      matrix[i][j] = dist(engine);
-    }
-  }
+template <typename T>
+static void gen_random_matrix(MATRIX<T>& matrix, std::uint64_t seed,
+                              T lowerBound, T upperBound) {
+  const std::size_t cols = matrix[0].size();
+  parallel_for(matrix.size(), parallel_row_grain(cols),
+               [&](std::size_t begin, std::size_t end) {
+                 for (std::size_t i = begin; i < end; i++)
+                   random_uniform(seed, i * cols, cols, lowerBound, upperBound,
+                                  matrix[i].data());
+               });
 }
 
 template <typename T>
+  requires(!is_matrix_v<T>)
 MATRIX<T> create_matrix(std::size_t rows, std::size_t columns,
                         std::optional<MatrixType> type,
                         std::optional<T> lowerBound,
-                        std::optional<T> upperBound) {
+                        std::optional<T> upperBound,
+                        std::optional<std::uint64_t> seed) {
   // check matrix dimension
   if (rows == 0 or columns == 0) {
     if (rows == columns) {
@@ -122,14 +189,10 @@ MATRIX<T> create_matrix(std::size_t rows, std::size_t columns,
         throw std::logic_error(
             "The lower bound must be smaller than the upper one.");
       }
-      std::random_device rd;
-      std::mt19937 engine(rd());
-      if constexpr (std::is_integral<T>::value) {
-        std::uniform_int_distribution<T> dist(*lowerBound, *upperBound);
-        gen_random_matrix(m, engine, dist);
-      } else if (std::is_floating_point<T>::value) {
-        std::uniform_real_distribution<T> dist(*lowerBound, *upperBound);
-        gen_random_matrix(m, engine, dist);
+      if constexpr (std::is_integral<T>::value or
+                    std::is_floating_point<T>::value) {
+        gen_random_matrix(m, seed ? *seed : random_seed(), *lowerBound,
+                          *upperBound);
       } else {
         throw std::logic_error(
             "The template type must be integer or floating point number.");
@@ -139,20 +202,22 @@ MATRIX<T> create_matrix(std::size_t rows, std::size_t columns,
   return m;
 }
 
+inline void display_element(double elem) {
+  const int max_width = 7;
+  int num_width = max_width;
+  if (elem < 0) num_width -= 1;  // negative sign
+  std::string str = std::format("{:^{}.{}}", elem, max_width, num_width);
+  if (str.length() > max_width) {
+    num_width -= 5;  // scientific format
+    str = std::format("{:^{}.{}}", elem, max_width, num_width);
+  }
+  std::cout << "|" << str;
+}
+
 template <typename T>
 void display(const MATRIX<T>& matrix) {
   for (const auto& row : matrix) {
-    for (const double elem : row) {
-      const int max_width = 7;
-      int num_width = max_width;
-      if (elem < 0) num_width -= 1;  // negative sign
-      std::string str = std::format("{:^{}.{}}", elem, max_width, num_width);
-      if (str.length() > max_width) {
-        num_width -= 5;  // scientific format
-        str = std::format("{:^{}.{}}", elem, max_width, num_width);
-      }
-      std::cout << "|" << str;
-    }
+    for (const double elem : row) display_element(elem);
     std::cout << "|\n";
   }
 }
@@ -167,35 +232,15 @@ std::pair<size_t, size_t> matrix_size(const MATRIX<T>& matrix) {
 template <typename T>
 MATRIX<T> sum_sub(const MATRIX<T>& matrixA, const MATRIX<T>& matrixB,
                   std::optional<std::string> operation) {
-  auto sizeA = matrix_size(matrixA);
-  auto sizeB = matrix_size(matrixB);
-  if (sizeA != sizeB) {
+  if (matrix_size(matrixA) != matrix_size(matrixB)) {
     throw std::logic_error("Matrix dimensions are not same.");
   }
-  if (!operation.has_value() or
-      !(operation.value() == "sum" or operation.value() == "sub")) {
-    operation = "sum";
-  }
-
-  MATRIX<T> res = matrixA;
-  size_t rowsA = sizeA.first;
-  size_t columnsA = sizeA.second;
-  if (operation.value() == "sum") {
-    for (size_t i = 0; i < rowsA; i++)
-      for (size_t j = 0; j < columnsA; j++) res[i][j] += matrixB[i][j];
-  } else {
-    for (size_t i = 0; i < rowsA; i++)
-      for (size_t j = 0; j < columnsA; j++) res[i][j] -= matrixB[i][j];
-  }
-  return res;
+  return sum_sub(MATRIX<T>(matrixA), matrixB, operation);
 }
 
 template <typename T>
 MATRIX<T> multiply(const MATRIX<T>& matrix, const T scalar) {
-  MATRIX<T> res = matrix;
-  for (auto& row : res)
-    for (auto& elem : row) elem *= scalar;
-  return res;
+  return multiply(MATRIX<T>(matrix), scalar);
 }
 
 template <typename T>
@@ -211,6 +256,14 @@ MATRIX<T> multiply(const MATRIX<T>& matrixA, const MATRIX<T>& matrixB) {
 
   MATRIX<T> res =
       create_matrix<T>(sizeA.first, sizeB.second, MatrixType::Zeros);
+  if (sizeA.first * sizeA.second * sizeB.second >= gemm_blocked_min_ops()) {
+    gemm_blocked<T>(
+        sizeA.first, sizeB.second, sizeA.second,
+        [&](size_t i, size_t k) { return matrixA[i][k]; },
+        [&](size_t k, size_t j) { return matrixB[k][j]; },
+        [&](size_t i, size_t j) -> T& { return res[i][j]; });
+    return res;
+  }
   for (size_t i = 0; i < sizeA.first; i++) {
     for (size_t k = 0; k < sizeA.second; k++) {
       T tmp = matrixA[i][k];
@@ -224,23 +277,37 @@ MATRIX<T> multiply(const MATRIX<T>& matrixA, const MATRIX<T>& matrixB) {
 
 template <typename T>
 MATRIX<T> hadamard_product(const MATRIX<T>& matrixA, const MATRIX<T>& matrixB) {
-  const auto sizeA = matrix_size(matrixA);
-  const auto sizeB = matrix_size(matrixB);
-  if (sizeA != sizeB) throw std::logic_error("Matrix dimensions do not match.");
-
-  MATRIX<T> res = matrixA;
-  for (size_t i = 0; i < sizeA.first; i++)
-    for (size_t j = 0; j < sizeA.second; j++) res[i][j] *= matrixB[i][j];
-  return res;
+  if (matrix_size(matrixA) != matrix_size(matrixB))
+    throw std::logic_error("Matrix dimensions do not match.");
+  return hadamard_product(MATRIX<T>(matrixA), matrixB);
 }
 
 template <typename T>
 MATRIX<T> transpose(const MATRIX<T>& matrix) {
-  const auto size_m = matrix_size(matrix);
-  MATRIX<T> res =
-      create_matrix<T>(size_m.second, size_m.first, MatrixType::Zeros);
-  for (size_t i = 0; i < size_m.first; i++)
-    for (size_t j = 0; j < size_m.second; j++) res[j][i] = matrix[i][j];
+  const auto [rows, cols] = matrix_size(matrix);
+  // the rows are separate vectors, so each square tile is gathered into a
+  // buffer, transposed by simd_transpose() like the leaves of
+  // transpose_blocked(), and scattered into the result rows
+  constexpr size_t tile = 32;
+  MATRIX<T> res(cols);
+  parallel_for(cols, std::max(parallel_row_grain(rows), tile),
+               [&](size_t begin, size_t end) {
+                 std::vector<T> in(tile * tile), out(tile * tile);
+                 for (size_t j = begin; j < end; j++) res[j].resize(rows);
+                 for (size_t jj = begin; jj < end; jj += tile) {
+                   const size_t w = std::min(tile, end - jj);
+                   for (size_t ii = 0; ii < rows; ii += tile) {
+                     const size_t h = std::min(tile, rows - ii);
+                     for (size_t i = 0; i < h; i++)
+                       std::copy_n(matrix[ii + i].begin() + jj, w,
+                                   in.begin() + i * tile);
+                     simd_transpose(in.data(), tile, out.data(), tile, h, w);
+                     for (size_t j = 0; j < w; j++)
+                       std::copy_n(out.begin() + j * tile, h,
+                                   res[jj + j].begin() + ii);
+                   }
+                 }
+               });
   return res;
 }
 
@@ -256,6 +323,119 @@ T trace(const MATRIX<T>& matrix) {
   return res;
 }
 
+template <typename T>
+void add_inplace(MATRIX<T>& matrixA, const MATRIX<T>& matrixB) {
+  const auto size_m = matrix_size(matrixA);
+  if (size_m != matrix_size(matrixB)) {
+    throw std::logic_error("Matrix dimensions are not same.");
+  }
+  parallel_for(size_m.first, parallel_row_grain(size_m.second),
+               [&](size_t begin, size_t end) {
+                 for (size_t i = begin; i < end; i++)
+                   simd_add(matrixA[i].data(), matrixB[i].data(),
+                            matrixA[i].data(), size_m.second);
+               });
+}
+
+template <typename T>
+void sub_inplace(MATRIX<T>& matrixA, const MATRIX<T>& matrixB) {
+  const auto size_m = matrix_size(matrixA);
+  if (size_m != matrix_size(matrixB)) {
+    throw std::logic_error("Matrix dimensions are not same.");
+  }
+  parallel_for(size_m.first, parallel_row_grain(size_m.second),
+               [&](size_t begin, size_t end) {
+                 for (size_t i = begin; i < end; i++)
+                   simd_sub(matrixA[i].data(), matrixB[i].data(),
+                            matrixA[i].data(), size_m.second);
+               });
+}
+
+template <typename T>
+void scale_inplace(MATRIX<T>& matrix, const T scalar) {
+  const size_t columns = matrix_size(matrix).second;
+  parallel_for(matrix.size(), parallel_row_grain(columns),
+               [&](size_t begin, size_t end) {
+                 for (size_t i = begin; i < end; i++)
+                   simd_scale(matrix[i].data(), scalar, matrix[i].data(),
+                              columns);
+               });
+}
+
+template <typename T>
+void hadamard_inplace(MATRIX<T>& matrixA, const MATRIX<T>& matrixB) {
+  const auto size_m = matrix_size(matrixA);
+  if (size_m != matrix_size(matrixB))
+    throw std::logic_error("Matrix dimensions do not match.");
+  parallel_for(size_m.first, parallel_row_grain(size_m.second),
+               [&](size_t begin, size_t end) {
+                 for (size_t i = begin; i < end; i++)
+                   simd_mul(matrixA[i].data(), matrixB[i].data(),
+                            matrixA[i].data(), size_m.second);
+               });
+}
+
+template <typename T>
+MATRIX<T> sum_sub(MATRIX<T>&& matrixA, const MATRIX<T>& matrixB,
+                  std::optional<std::string> operation) {
+  // anything but "sub" is a sum, as in the copying overload
+  if (operation.has_value() and operation.value() == "sub")
+    sub_inplace(matrixA, matrixB);
+  else
+    add_inplace(matrixA, matrixB);
+  return std::move(matrixA);
+}
+
+template <typename T>
+MATRIX<T> sum_sub(const MATRIX<T>& matrixA, MATRIX<T>&& matrixB,
+                  std::optional<std::string> operation) {
+  if (!(operation.has_value() and operation.value() == "sub")) {
+    add_inplace(matrixB, matrixA);
+    return std::move(matrixB);
+  }
+  const auto size_m = matrix_size(matrixA);
+  if (size_m != matrix_size(matrixB)) {
+    throw std::logic_error("Matrix dimensions are not same.");
+  }
+  // B = A - B, written over B
+  parallel_for(size_m.first, parallel_row_grain(size_m.second),
+               [&](size_t begin, size_t end) {
+                 for (size_t i = begin; i < end; i++)
+                   simd_sub(matrixA[i].data(), matrixB[i].data(),
+                            matrixB[i].data(), size_m.second);
+               });
+  return std::move(matrixB);
+}
+
+template <typename T>
+MATRIX<T> sum_sub(MATRIX<T>&& matrixA, MATRIX<T>&& matrixB,
+                  std::optional<std::string> operation) {
+  return sum_sub(std::move(matrixA), std::as_const(matrixB), operation);
+}
+
+template <typename T>
+MATRIX<T> multiply(MATRIX<T>&& matrix, const T scalar) {
+  scale_inplace(matrix, scalar);
+  return std::move(matrix);
+}
+
+template <typename T>
+MATRIX<T> hadamard_product(MATRIX<T>&& matrixA, const MATRIX<T>& matrixB) {
+  hadamard_inplace(matrixA, matrixB);
+  return std::move(matrixA);
+}
+
+template <typename T>
+MATRIX<T> hadamard_product(const MATRIX<T>& matrixA, MATRIX<T>&& matrixB) {
+  hadamard_inplace(matrixB, matrixA);
+  return std::move(matrixB);
+}
+
+template <typename T>
+MATRIX<T> hadamard_product(MATRIX<T>&& matrixA, MATRIX<T>&& matrixB) {
+  return hadamard_product(std::move(matrixA), std::as_const(matrixB));
+}
+
 }  // namespace algebra
 
 #endif  // AUT_AP_2024_Spring_HW1
@@ -0,0 +1,114 @@
+#ifndef AUT_AP_2024_Spring_HW1_ARENA
+#define AUT_AP_2024_Spring_HW1_ARENA
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace algebra {
+// Alignment of every block handed out by an arena (a cache line)
+inline constexpr std::size_t ARENA_ALIGNMENT = 64;
+
+// Size of the first chunk an arena takes from the heap
+inline constexpr std::size_t ARENA_CHUNK_BYTES = std::size_t(1) << 20;
+
+// Counters of a MatrixArena, in bytes unless noted.
+// allocations:     blocks handed out (count);
+// bytes_allocated: size of those blocks, rounded up to ARENA_ALIGNMENT;
+// bytes_reused:    part of bytes_allocated served from memory an earlier,
+//                  already freed block occupied, i.e. what malloc was
+//                  spared;
+// bytes_reserved:  chunk memory currently held from the heap;
+// chunks:          chunks currently held (count);
+// live_bytes:      blocks handed out and not freed yet;
+// peak_bytes:      largest live_bytes seen;
+// rewinds:         times the arena was emptied and restarted (count).
+struct ArenaStats {
+  std::size_t allocations = 0;
+  std::size_t bytes_allocated = 0;
+  std::size_t bytes_reused = 0;
+  std::size_t bytes_reserved = 0;
+  std::size_t chunks = 0;
+  std::size_t live_bytes = 0;
+  std::size_t peak_bytes = 0;
+  std::size_t rewinds = 0;
+};
+
+// Bump allocator for the buffers of matrix temporaries.
+// Blocks are carved one after the other out of large aligned chunks;
+// freeing a block only updates a counter, and once every block is free
+// the whole arena is rewound at once and its chunks are reused by the next
+// allocations. Chunks go back to the heap in release() or the destructor.
+// A long-lived block therefore keeps the arena from rewinding: give results
+// that must outlive the computation a heap buffer (copy them outside the
+// ArenaScope). The arena must outlive every matrix allocated from it.
+// All members may be called from any thread.
+class MatrixArena {
+ public:
+  explicit MatrixArena(std::size_t chunk_bytes = ARENA_CHUNK_BYTES);
+  ~MatrixArena();
+
+  MatrixArena(const MatrixArena&) = delete;
+  MatrixArena& operator=(const MatrixArena&) = delete;
+
+  // `bytes` bytes aligned to ARENA_ALIGNMENT; never returns nullptr
+  void* allocate(std::size_t bytes);
+  // Return a block of `bytes` bytes obtained from allocate()
+  void deallocate(void* ptr, std::size_t bytes) noexcept;
+
+  // Give every chunk back to the heap; throws std::logic_error while blocks
+  // are still live
+  void release();
+
+  ArenaStats stats() const;
+  // Zero the running counters; reserved and live memory stay as they are
+  void reset_stats();
+
+ private:
+  struct Chunk {
+    std::byte* data;
+    std::size_t size;
+    std::size_t high_water;  // end of the furthest block ever placed here
+  };
+
+  mutable std::mutex mutex_;
+  std::size_t chunk_bytes_;
+  std::vector<Chunk> chunks_;
+  std::size_t current_ = 0;  // chunk the next block is carved from
+  std::size_t offset_ = 0;   // first free byte of that chunk
+  std::size_t live_blocks_ = 0;
+  ArenaStats stats_;
+
+  void rewind();
+  void free_chunks() noexcept;
+};
+
+// Arena that new matrices on this thread take their buffers from, or
+// nullptr for the heap
+MatrixArena* current_arena();
+
+// Route the matrices created on this thread to `arena` for the lifetime of
+// the scope; the previous arena (or the heap) is restored on exit. Scopes
+// nest. Matrices created on pool workers still use the heap.
+//
+//   MatrixArena arena;
+//   for (...) {
+//     ArenaScope scope(arena);
+//     auto t = multiply(a, b);  // bump-allocated
+//     ...                       // freed together at the end of the body
+//   }
+class ArenaScope {
+ public:
+  explicit ArenaScope(MatrixArena& arena);
+  ~ArenaScope();
+
+  ArenaScope(const ArenaScope&) = delete;
+  ArenaScope& operator=(const ArenaScope&) = delete;
+
+ private:
+  MatrixArena* previous_;
+};
+
+}  // namespace algebra
+
+#endif  // AUT_AP_2024_Spring_HW1_ARENA
@@ -0,0 +1,106 @@
+#ifndef AUT_AP_2024_Spring_HW1_BATCHED
+#define AUT_AP_2024_Spring_HW1_BATCHED
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "fixed_matrix.h"
+#include "simd.h"
+#include "thread_pool.h"
+
+namespace algebra {
+// Many small products of one shape in a single call, e.g. a layer applied
+// to thousands of inputs. The batch is split over the thread pool, with no
+// per-matrix allocation or dispatch. Shapes known only at run time go
+// through one SIMD kernel call per task; fixed-size matrices use the
+// unrolled FixedMatrix multiply, which is faster for tiny shapes.
+
+// C_i = A_i * B_i for i < batch, where the dense row-major A_i (m x k)
+// starts at a + i * stride_a, B_i (k x n) at b + i * stride_b and C_i
+// (m x n) at c + i * stride_c. A stride of 0 reuses one operand for the
+// whole batch (shared weights).
+template <typename T>
+void multiply_batched(std::size_t batch, std::size_t m, std::size_t n,
+                      std::size_t k, const T* a, std::size_t stride_a,
+                      const T* b, std::size_t stride_b, T* c,
+                      std::size_t stride_c);
+
+// Matrices stored back to back
+template <typename T>
+void multiply_batched(std::size_t batch, std::size_t m, std::size_t n,
+                      std::size_t k, const T* a, const T* b, T* c);
+
+// Element-wise over two batches of fixed-size matrices of equal length
+template <typename T, std::size_t R, std::size_t K, std::size_t C>
+std::vector<FixedMatrix<T, R, C>> multiply_batched(
+    const std::vector<FixedMatrix<T, R, K>>& matrixA,
+    const std::vector<FixedMatrix<T, K, C>>& matrixB);
+
+// Every matrix of a batch times one shared matrix
+template <typename T, std::size_t R, std::size_t K, std::size_t C>
+std::vector<FixedMatrix<T, R, C>> multiply_batched(
+    const std::vector<FixedMatrix<T, R, K>>& matrixA,
+    const FixedMatrix<T, K, C>& matrixB);
+
+////////////////////////////
+////// Implementation //////
+////////////////////////////
+
+template <typename T>
+void multiply_batched(std::size_t batch, std::size_t m, std::size_t n,
+                      std::size_t k, const T* a, std::size_t stride_a,
+                      const T* b, std::size_t stride_b, T* c,
+                      std::size_t stride_c) {
+  if (batch == 0 or m == 0 or n == 0) return;
+  const std::size_t work = std::max<std::size_t>(m * n * k, 1);
+  parallel_for(batch, std::max<std::size_t>(parallel_min_elements() / work, 1),
+               [&](std::size_t begin, std::size_t end) {
+                 simd_gemm_batched(end - begin, m, n, k,
+                                   a + begin * stride_a, stride_a,
+                                   b + begin * stride_b, stride_b,
+                                   c + begin * stride_c, stride_c);
+               });
+}
+
+template <typename T>
+void multiply_batched(std::size_t batch, std::size_t m, std::size_t n,
+                      std::size_t k, const T* a, const T* b, T* c) {
+  multiply_batched(batch, m, n, k, a, m * k, b, k * n, c, m * n);
+}
+
+template <typename T, std::size_t R, std::size_t K, std::size_t C>
+std::vector<FixedMatrix<T, R, C>> multiply_batched(
+    const std::vector<FixedMatrix<T, R, K>>& matrixA,
+    const std::vector<FixedMatrix<T, K, C>>& matrixB) {
+  if (matrixA.size() != matrixB.size()) {
+    throw std::logic_error("Batch sizes do not match.");
+  }
+  std::vector<FixedMatrix<T, R, C>> res(matrixA.size());
+  parallel_for(res.size(),
+               std::max<std::size_t>(parallel_min_elements() / (R * K * C), 1),
+               [&](std::size_t begin, std::size_t end) {
+                 for (std::size_t s = begin; s < end; s++)
+                   res[s] = multiply(matrixA[s], matrixB[s]);
+               });
+  return res;
+}
+
+template <typename T, std::size_t R, std::size_t K, std::size_t C>
+std::vector<FixedMatrix<T, R, C>> multiply_batched(
+    const std::vector<FixedMatrix<T, R, K>>& matrixA,
+    const FixedMatrix<T, K, C>& matrixB) {
+  std::vector<FixedMatrix<T, R, C>> res(matrixA.size());
+  parallel_for(res.size(),
+               std::max<std::size_t>(parallel_min_elements() / (R * K * C), 1),
+               [&](std::size_t begin, std::size_t end) {
+                 for (std::size_t s = begin; s < end; s++)
+                   res[s] = multiply(matrixA[s], matrixB);
+               });
+  return res;
+}
+
+}  // namespace algebra
+
+#endif  // AUT_AP_2024_Spring_HW1_BATCHED
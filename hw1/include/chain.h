@@ -0,0 +1,201 @@
+#ifndef AUT_AP_2024_Spring_HW1_CHAIN
+#define AUT_AP_2024_Spring_HW1_CHAIN
+
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "view.h"
+
+namespace algebra {
+// Cost of one (m x k) * (k x n) product. The planner minimizes the sum over
+// all the products of a chain, so a model built from measured kernel
+// timings can replace the flop count.
+using ChainCost =
+    std::function<double(std::size_t m, std::size_t k, std::size_t n)>;
+
+// 2 * m * k * n floating-point operations
+inline double chain_flops(std::size_t m, std::size_t k, std::size_t n);
+
+// Cheapest parenthesization of a chain of `count` matrices.
+// split(i, j) is the last product of the sub-chain [i, j]: it multiplies
+// [i, split] by [split + 1, j].
+struct ChainPlan {
+  std::size_t count = 0;
+  double cost = 0;
+  std::vector<std::size_t> splits;  // count x count, upper triangle used
+
+  std::size_t split(std::size_t i, std::size_t j) const {
+    return splits[i * count + j];
+  }
+  // e.g. "((0 1) 2)"
+  std::string to_string() const;
+};
+
+// Dynamic program over the shapes (O(count^3)): matrix i of the chain is
+// dims[i] x dims[i + 1]
+inline ChainPlan plan_chain(const std::vector<std::size_t>& dims,
+                            const ChainCost& cost = chain_flops);
+
+// Product of a chain in its cheapest order. Every intermediate lives only
+// until the product that consumes it.
+template <typename T>
+Matrix<T> multiply_chain(const std::vector<MatrixView<T>>& chain,
+                         const ChainCost& cost = chain_flops);
+
+template <dense_matrix... M>
+  requires(sizeof...(M) >= 2)
+auto multiply_chain(const M&... matrices);
+
+template <typename T>
+MATRIX<T> multiply_chain(const std::vector<MATRIX<T>>& chain,
+                         const ChainCost& cost = chain_flops);
+
+// Shapes of the chain as plan_chain() wants them; throws if two
+// neighbours cannot be multiplied
+template <typename T>
+std::vector<std::size_t> chain_dims(const std::vector<MatrixView<T>>& chain);
+
+template <typename T>
+std::vector<std::size_t> chain_dims(const std::vector<MATRIX<T>>& chain);
+
+// Evaluate the sub-chain [i, j] of a plan
+template <typename T>
+Matrix<T> chain_evaluate(const std::vector<MatrixView<T>>& chain,
+                         const ChainPlan& plan, std::size_t i, std::size_t j);
+
+template <typename T>
+MATRIX<T> chain_evaluate(const std::vector<MATRIX<T>>& chain,
+                         const ChainPlan& plan, std::size_t i, std::size_t j);
+
+////////////////////////////
+////// Implementation //////
+////////////////////////////
+
+inline double chain_flops(std::size_t m, std::size_t k, std::size_t n) {
+  return 2.0 * double(m) * double(k) * double(n);
+}
+
+inline std::string ChainPlan::to_string() const {
+  if (count == 0) return "";
+  std::function<std::string(std::size_t, std::size_t)> format =
+      [&](std::size_t i, std::size_t j) -> std::string {
+    if (i == j) return std::to_string(i);
+    return "(" + format(i, split(i, j)) + " " + format(split(i, j) + 1, j) +
+           ")";
+  };
+  return format(0, count - 1);
+}
+
+inline ChainPlan plan_chain(const std::vector<std::size_t>& dims,
+                            const ChainCost& cost) {
+  if (dims.size() < 2) throw std::logic_error("Matrix is empty.");
+  const std::size_t n = dims.size() - 1;
+  ChainPlan plan{.count = n, .cost = 0, .splits = {}};
+  plan.splits.assign(n * n, 0);
+  // best[i * n + j]: cheapest cost of the sub-chain [i, j], by length
+  std::vector<double> best(n * n, 0);
+  for (std::size_t len = 2; len <= n; len++) {
+    for (std::size_t i = 0; i + len <= n; i++) {
+      const std::size_t j = i + len - 1;
+      double& b = best[i * n + j];
+      b = std::numeric_limits<double>::infinity();
+      for (std::size_t s = i; s < j; s++) {
+        const double c = best[i * n + s] + best[(s + 1) * n + j] +
+                         cost(dims[i], dims[s + 1], dims[j + 1]);
+        if (c < b) {
+          b = c;
+          plan.splits[i * n + j] = s;
+        }
+      }
+    }
+  }
+  plan.cost = best[n - 1];
+  return plan;
+}
+
+template <typename T>
+std::vector<std::size_t> chain_dims(const std::vector<MatrixView<T>>& chain) {
+  if (chain.empty()) throw std::logic_error("Matrix is empty.");
+  std::vector<std::size_t> dims{chain[0].rows()};
+  for (std::size_t i = 0; i < chain.size(); i++) {
+    if (chain[i].empty()) throw std::logic_error("Matrix is empty.");
+    if (chain[i].rows() != dims.back()) {
+      throw std::logic_error("Matrix dimensions do not match.");
+    }
+    dims.push_back(chain[i].cols());
+  }
+  return dims;
+}
+
+template <typename T>
+std::vector<std::size_t> chain_dims(const std::vector<MATRIX<T>>& chain) {
+  if (chain.empty()) throw std::logic_error("Matrix is empty.");
+  std::vector<std::size_t> dims{matrix_size(chain[0]).first};
+  for (const auto& matrix : chain) {
+    const auto [rows, cols] = matrix_size(matrix);
+    if (rows == 0 or cols == 0) throw std::logic_error("Matrix is empty.");
+    if (rows != dims.back()) {
+      throw std::logic_error("Matrix dimensions do not match.");
+    }
+    dims.push_back(cols);
+  }
+  return dims;
+}
+
+template <typename T>
+Matrix<T> chain_evaluate(const std::vector<MatrixView<T>>& chain,
+                         const ChainPlan& plan, std::size_t i, std::size_t j) {
+  if (i == j) return to_matrix(chain[i]);
+  const std::size_t s = plan.split(i, j);
+  // single matrices are used in place, sub-chains through a temporary
+  Matrix<T> left, right;
+  const MatrixView<T> a =
+      s == i ? chain[i] : view(left = chain_evaluate(chain, plan, i, s));
+  const MatrixView<T> b =
+      s + 1 == j ? chain[j]
+                 : view(right = chain_evaluate(chain, plan, s + 1, j));
+  return multiply(a, b);
+}
+
+template <typename T>
+MATRIX<T> chain_evaluate(const std::vector<MATRIX<T>>& chain,
+                         const ChainPlan& plan, std::size_t i, std::size_t j) {
+  if (i == j) return chain[i];
+  const std::size_t s = plan.split(i, j);
+  MATRIX<T> left, right;
+  const MATRIX<T>& a =
+      s == i ? chain[i] : (left = chain_evaluate(chain, plan, i, s));
+  const MATRIX<T>& b =
+      s + 1 == j ? chain[j] : (right = chain_evaluate(chain, plan, s + 1, j));
+  return multiply(a, b);
+}
+
+template <typename T>
+Matrix<T> multiply_chain(const std::vector<MatrixView<T>>& chain,
+                         const ChainCost& cost) {
+  const ChainPlan plan = plan_chain(chain_dims(chain), cost);
+  return chain_evaluate(chain, plan, 0, chain.size() - 1);
+}
+
+template <dense_matrix... M>
+  requires(sizeof...(M) >= 2)
+auto multiply_chain(const M&... matrices) {
+  using T = typename std::tuple_element_t<0, std::tuple<M...>>::value_type;
+  return multiply_chain(std::vector<MatrixView<T>>{view(matrices)...});
+}
+
+template <typename T>
+MATRIX<T> multiply_chain(const std::vector<MATRIX<T>>& chain,
+                         const ChainCost& cost) {
+  const ChainPlan plan = plan_chain(chain_dims(chain), cost);
+  return chain_evaluate(chain, plan, 0, chain.size() - 1);
+}
+
+}  // namespace algebra
+
+#endif  // AUT_AP_2024_Spring_HW1_CHAIN
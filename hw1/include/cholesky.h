@@ -0,0 +1,174 @@
+#ifndef AUT_AP_2024_Spring_HW1_CHOLESKY
+#define AUT_AP_2024_Spring_HW1_CHOLESKY
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <stdexcept>
+
+#include "gemm.h"
+#include "view.h"
+
+namespace algebra {
+// Columns factorized per step by the blocked Cholesky
+inline constexpr std::size_t CHOLESKY_BLOCK = 64;
+
+// Cholesky factorization A = L * L^T of a symmetric positive definite
+// matrix; returns L with zeros above the diagonal. Only the lower triangle
+// of A is read. Throws if A is not positive definite.
+template <std::floating_point T>
+Matrix<T> cholesky(const Matrix<T>& matrix);
+
+template <std::floating_point T>
+MATRIX<T> cholesky(const MATRIX<T>& matrix);
+
+// In-place variant: the lower triangle of `a` (contiguous rows) is
+// overwritten with L, the strictly upper triangle is not touched
+template <std::floating_point T>
+void cholesky_inplace(MatrixSpan<T> a, std::size_t block = CHOLESKY_BLOCK);
+
+// X with L * L^T * X = B, for the factor returned by cholesky()
+template <std::floating_point T>
+Matrix<T> cholesky_solve(const Matrix<T>& l, const Matrix<T>& b);
+
+// Unblocked factorization of the diagonal block at (k, k)
+template <std::floating_point T>
+void cholesky_block(MatrixSpan<T> a, std::size_t k, std::size_t width);
+
+////////////////////////////
+////// Implementation //////
+////////////////////////////
+
+template <std::floating_point T>
+void cholesky_block(MatrixSpan<T> a, std::size_t k, std::size_t width) {
+  for (std::size_t j = k; j < k + width; j++) {
+    const T* lj = a.row(j);
+    T d = lj[j];
+    for (std::size_t p = k; p < j; p++) d -= lj[p] * lj[p];
+    // also catches NaN
+    if (!(d > T(0))) {
+      throw std::logic_error("Matrix is not positive definite.");
+    }
+    const T ljj = std::sqrt(d);
+    a(j, j) = ljj;
+    for (std::size_t i = j + 1; i < k + width; i++) {
+      T* li = a.row(i);
+      T s = li[j];
+      for (std::size_t p = k; p < j; p++) s -= li[p] * lj[p];
+      li[j] = s / ljj;
+    }
+  }
+}
+
+template <std::floating_point T>
+void cholesky_inplace(MatrixSpan<T> a, std::size_t block) {
+  if (a.empty()) throw std::logic_error("Matrix is empty.");
+  if (a.rows() != a.cols()) throw std::logic_error("Matrix must be square.");
+  if (!a.contiguous_rows()) {
+    throw std::logic_error("The rows of the matrix must be contiguous.");
+  }
+  const std::size_t n = a.rows();
+  block = std::max<std::size_t>(block, 1);
+  for (std::size_t k = 0; k < n; k += block) {
+    const std::size_t kb = std::min(block, n - k);
+    cholesky_block(a, k, kb);
+    const std::size_t rest = n - k - kb;
+    if (rest == 0) break;
+
+    // L21 = A21 * L11^-T, one independent row at a time
+    const auto l21 = a.block(k + kb, k, rest, kb);
+    parallel_for(rest, parallel_row_grain(kb * kb / 2 + 1),
+                 [&](std::size_t begin, std::size_t end) {
+                   for (std::size_t i = begin; i < end; i++) {
+                     T* x = l21.row(i);
+                     for (std::size_t j = 0; j < kb; j++) {
+                       const T* l11 = a.row(k + j) + k;
+                       T s = x[j];
+                       for (std::size_t p = 0; p < j; p++) s -= x[p] * l11[p];
+                       x[j] = s / l11[j];
+                     }
+                   }
+                 });
+
+    // lower triangle of A22 -= L21 * L21^T, by strips of `block` rows: the
+    // part left of the diagonal block goes straight through the GEMM, the
+    // diagonal block through a scratch tile so the upper half stays intact
+    const auto a22 = a.block(k + kb, k + kb, rest, rest);
+    Matrix<T> diag(std::min(block, rest), std::min(block, rest));
+    for (std::size_t i0 = 0; i0 < rest; i0 += block) {
+      const std::size_t h = std::min(block, rest - i0);
+      gemm_blocked<T>(
+          h, i0, kb,
+          [&](std::size_t i, std::size_t p) { return -l21(i0 + i, p); },
+          [&](std::size_t p, std::size_t j) { return l21(j, p); },
+          [&](std::size_t i, std::size_t j) -> T& { return a22(i0 + i, j); });
+      for (std::size_t i = 0; i < h; i++) std::fill_n(diag.row(i), h, T(0));
+      gemm_blocked<T>(
+          h, h, kb,
+          [&](std::size_t i, std::size_t p) { return l21(i0 + i, p); },
+          [&](std::size_t p, std::size_t j) { return l21(i0 + j, p); },
+          [&](std::size_t i, std::size_t j) -> T& { return diag(i, j); });
+      for (std::size_t i = 0; i < h; i++)
+        for (std::size_t j = 0; j <= i; j++) a22(i0 + i, i0 + j) -= diag(i, j);
+    }
+  }
+}
+
+template <std::floating_point T>
+Matrix<T> cholesky(const Matrix<T>& matrix) {
+  Matrix<T> l = matrix;
+  cholesky_inplace(span(l));
+  for (std::size_t i = 0; i < l.rows(); i++)
+    std::fill(l.row(i) + i + 1, l.row(i) + l.cols(), T(0));
+  return l;
+}
+
+template <std::floating_point T>
+MATRIX<T> cholesky(const MATRIX<T>& matrix) {
+  if (matrix.empty()) throw std::logic_error("Matrix is empty.");
+  return cholesky(to_matrix(matrix)).to_legacy();
+}
+
+template <std::floating_point T>
+Matrix<T> cholesky_solve(const Matrix<T>& l, const Matrix<T>& b) {
+  if (l.empty() or b.empty()) throw std::logic_error("Matrix is empty.");
+  if (l.rows() != l.cols()) throw std::logic_error("Matrix must be square.");
+  if (b.rows() != l.rows()) {
+    throw std::logic_error("Matrix dimensions do not match.");
+  }
+  const std::size_t n = l.rows(), m = b.cols();
+  Matrix<T> x = b;
+  // L * Y = B, then L^T * X = Y, on whole rows; columns over the pool
+  parallel_for(m, std::max<std::size_t>(parallel_min_elements() / n, 1),
+               [&](std::size_t begin, std::size_t end) {
+                 for (std::size_t i = 0; i < n; i++) {
+                   T* dst = x.row(i);
+                   for (std::size_t p = 0; p < i; p++) {
+                     const T lip = l(i, p);
+                     const T* src = x.row(p);
+                     for (std::size_t c = begin; c < end; c++)
+                       dst[c] -= lip * src[c];
+                   }
+                   const T inv = T(1) / l(i, i);
+                   for (std::size_t c = begin; c < end; c++) dst[c] *= inv;
+                 }
+                 for (std::size_t i = n; i-- > 0;) {
+                   T* dst = x.row(i);
+                   const T inv = T(1) / l(i, i);
+                   for (std::size_t c = begin; c < end; c++) dst[c] *= inv;
+                   // row i is final: remove it from the rows above
+                   for (std::size_t p = 0; p < i; p++) {
+                     const T lip = l(i, p);
+                     T* above = x.row(p);
+                     for (std::size_t c = begin; c < end; c++)
+                       above[c] -= lip * dst[c];
+                   }
+                 }
+               });
+  return x;
+}
+
+}  // namespace algebra
+
+#endif  // AUT_AP_2024_Spring_HW1_CHOLESKY
@@ -0,0 +1,326 @@
+#ifndef AUT_AP_2024_Spring_HW1_EXPR
+#define AUT_AP_2024_Spring_HW1_EXPR
+
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+#include "view.h"
+
+namespace algebra {
+// Expression templates for element-wise chains.
+// `A * 2.0 + hadamard_product(B, C)` on Matrix<T> or view operands only
+// records the operations; the result is computed element by element, in one
+// pass and without intermediate matrices, when it is assigned to a Matrix<T>
+// (or converted with evaluate()/to_legacy()). Expressions hold references to
+// their operands, so they must be evaluated before those go away.
+
+// Leaf referring to a Matrix<T>
+template <typename M>
+class MatrixRef {
+ public:
+  using expression_tag = void;
+  using value_type = typename M::value_type;
+
+  explicit MatrixRef(const M& matrix) : matrix_(&matrix) {}
+
+  std::size_t rows() const { return matrix_->rows(); }
+  std::size_t cols() const { return matrix_->cols(); }
+  value_type operator()(std::size_t i, std::size_t j) const {
+    return (*matrix_)(i, j);
+  }
+  bool references(const void* begin, const void* end) const {
+    return matrix_->data() >= begin and matrix_->data() < end;
+  }
+  // same layout as a destination of the same shape
+  bool aliases(const void*, const void*) const { return false; }
+
+ private:
+  const M* matrix_;
+};
+
+// Leaf referring to a legacy MATRIX<T>
+template <typename T>
+class LegacyRef {
+ public:
+  using expression_tag = void;
+  using value_type = T;
+
+  explicit LegacyRef(const MATRIX<T>& matrix)
+      : matrix_(&matrix), size_(matrix_size(matrix)) {}
+
+  std::size_t rows() const { return size_.first; }
+  std::size_t cols() const { return size_.second; }
+  T operator()(std::size_t i, std::size_t j) const { return (*matrix_)[i][j]; }
+  bool references(const void*, const void*) const { return false; }
+  bool aliases(const void*, const void*) const { return false; }
+
+ private:
+  const MATRIX<T>* matrix_;
+  std::pair<size_t, size_t> size_;
+};
+
+// Leaf holding a view (views are cheap to copy and may be temporaries)
+template <typename T>
+class ViewRef {
+ public:
+  using expression_tag = void;
+  using value_type = std::remove_const_t<T>;
+
+  explicit ViewRef(MatrixSpan<T> span) : view_(span) {}
+
+  std::size_t rows() const { return view_.rows(); }
+  std::size_t cols() const { return view_.cols(); }
+  value_type operator()(std::size_t i, std::size_t j) const {
+    return view_(i, j);
+  }
+  bool references(const void* begin, const void* end) const {
+    if (view_.empty()) return false;
+    const void* last = &view_(view_.rows() - 1, view_.cols() - 1);
+    return view_.data() < end and last >= begin;
+  }
+  // a view may be shifted or transposed against the destination
+  bool aliases(const void* begin, const void* end) const {
+    return references(begin, end);
+  }
+
+ private:
+  MatrixSpan<T> view_;
+};
+
+// Anything that may appear inside an expression
+template <typename M>
+concept matrix_operand = lazy_expression<M> or dense_matrix<M>;
+
+// Expressions and views are stored by value, matrices by reference
+template <typename M>
+struct operand_traits {
+  using type = MatrixRef<M>;
+};
+
+template <lazy_expression M>
+struct operand_traits<M> {
+  using type = M;
+};
+
+template <typename T>
+struct operand_traits<MatrixSpan<T>> {
+  using type = ViewRef<T>;
+};
+
+template <typename M>
+using operand_t = typename operand_traits<std::remove_cvref_t<M>>::type;
+
+template <matrix_operand M>
+operand_t<M> as_operand(const M& m);
+
+// Element-wise binary node: +, - or Hadamard product
+enum class ElementwiseOp { Sum, Sub, Hadamard };
+
+template <ElementwiseOp Op, typename L, typename R>
+class ElementwiseExpr {
+ public:
+  using expression_tag = void;
+  using value_type =
+      std::common_type_t<typename L::value_type, typename R::value_type>;
+
+  ElementwiseExpr(L lhs, R rhs) : lhs_(lhs), rhs_(rhs) {
+    if (lhs_.rows() != rhs_.rows() or lhs_.cols() != rhs_.cols())
+      throw std::logic_error("Matrix dimensions are not same.");
+  }
+
+  std::size_t rows() const { return lhs_.rows(); }
+  std::size_t cols() const { return lhs_.cols(); }
+  value_type operator()(std::size_t i, std::size_t j) const {
+    if constexpr (Op == ElementwiseOp::Sum) return lhs_(i, j) + rhs_(i, j);
+    if constexpr (Op == ElementwiseOp::Sub) return lhs_(i, j) - rhs_(i, j);
+    if constexpr (Op == ElementwiseOp::Hadamard) return lhs_(i, j) * rhs_(i, j);
+  }
+  bool references(const void* begin, const void* end) const {
+    return lhs_.references(begin, end) or rhs_.references(begin, end);
+  }
+  bool aliases(const void* begin, const void* end) const {
+    return lhs_.aliases(begin, end) or rhs_.aliases(begin, end);
+  }
+
+ private:
+  L lhs_;
+  R rhs_;
+};
+
+// Scalar multiplication node
+template <typename E, typename S>
+class ScaledExpr {
+ public:
+  using expression_tag = void;
+  using value_type = std::common_type_t<typename E::value_type, S>;
+
+  ScaledExpr(E expr, S scalar) : expr_(expr), scalar_(scalar) {}
+
+  std::size_t rows() const { return expr_.rows(); }
+  std::size_t cols() const { return expr_.cols(); }
+  value_type operator()(std::size_t i, std::size_t j) const {
+    return expr_(i, j) * scalar_;
+  }
+  bool references(const void* begin, const void* end) const {
+    return expr_.references(begin, end);
+  }
+  bool aliases(const void* begin, const void* end) const {
+    return expr_.aliases(begin, end);
+  }
+
+ private:
+  E expr_;
+  S scalar_;
+};
+
+// Transposed view of an expression; nothing is copied
+template <typename E>
+class TransposeExpr {
+ public:
+  using expression_tag = void;
+  using value_type = typename E::value_type;
+
+  explicit TransposeExpr(E expr) : expr_(expr) {}
+
+  std::size_t rows() const { return expr_.cols(); }
+  std::size_t cols() const { return expr_.rows(); }
+  value_type operator()(std::size_t i, std::size_t j) const {
+    return expr_(j, i);
+  }
+  bool references(const void* begin, const void* end) const {
+    return expr_.references(begin, end);
+  }
+  // element (i, j) reads (j, i) of every operand
+  bool aliases(const void* begin, const void* end) const {
+    return expr_.references(begin, end);
+  }
+
+ private:
+  E expr_;
+};
+
+// Start an expression from any operand, e.g. lazy(legacy) * 2.0
+template <matrix_operand M>
+operand_t<M> lazy(const M& m);
+
+template <typename T>
+LegacyRef<T> lazy(const MATRIX<T>& matrix);
+
+template <matrix_operand L, matrix_operand R>
+ElementwiseExpr<ElementwiseOp::Sum, operand_t<L>, operand_t<R>> operator+(
+    const L& lhs, const R& rhs);
+
+template <matrix_operand L, matrix_operand R>
+ElementwiseExpr<ElementwiseOp::Sub, operand_t<L>, operand_t<R>> operator-(
+    const L& lhs, const R& rhs);
+
+template <matrix_operand E, typename S>
+  requires std::is_arithmetic_v<S>
+ScaledExpr<operand_t<E>, S> operator*(const E& expr, S scalar);
+
+template <matrix_operand E, typename S>
+  requires std::is_arithmetic_v<S>
+ScaledExpr<operand_t<E>, S> operator*(S scalar, const E& expr);
+
+template <matrix_operand E>
+ScaledExpr<operand_t<E>, typename E::value_type> operator-(const E& expr);
+
+// Lazy overloads of the eager API; used as soon as one operand is an
+// expression (two plain Matrix<T> still go through matrix.h)
+template <matrix_operand L, matrix_operand R>
+  requires(lazy_expression<L> or lazy_expression<R>)
+ElementwiseExpr<ElementwiseOp::Hadamard, operand_t<L>, operand_t<R>>
+hadamard_product(const L& lhs, const R& rhs);
+
+template <lazy_expression E>
+TransposeExpr<E> transpose(const E& expr);
+
+// Evaluate into the contiguous or into the legacy representation
+template <lazy_expression E>
+Matrix<typename E::value_type> evaluate(const E& expr);
+
+template <lazy_expression E>
+MATRIX<typename E::value_type> to_legacy(const E& expr);
+
+////////////////////////////
+////// Implementation //////
+////////////////////////////
+
+template <matrix_operand M>
+operand_t<M> as_operand(const M& m) {
+  return operand_t<M>(m);
+}
+
+template <matrix_operand M>
+operand_t<M> lazy(const M& m) {
+  return as_operand(m);
+}
+
+template <typename T>
+LegacyRef<T> lazy(const MATRIX<T>& matrix) {
+  return LegacyRef<T>(matrix);
+}
+
+template <matrix_operand L, matrix_operand R>
+ElementwiseExpr<ElementwiseOp::Sum, operand_t<L>, operand_t<R>> operator+(
+    const L& lhs, const R& rhs) {
+  return {as_operand(lhs), as_operand(rhs)};
+}
+
+template <matrix_operand L, matrix_operand R>
+ElementwiseExpr<ElementwiseOp::Sub, operand_t<L>, operand_t<R>> operator-(
+    const L& lhs, const R& rhs) {
+  return {as_operand(lhs), as_operand(rhs)};
+}
+
+template <matrix_operand E, typename S>
+  requires std::is_arithmetic_v<S>
+ScaledExpr<operand_t<E>, S> operator*(const E& expr, S scalar) {
+  return {as_operand(expr), scalar};
+}
+
+template <matrix_operand E, typename S>
+  requires std::is_arithmetic_v<S>
+ScaledExpr<operand_t<E>, S> operator*(S scalar, const E& expr) {
+  return {as_operand(expr), scalar};
+}
+
+template <matrix_operand E>
+ScaledExpr<operand_t<E>, typename E::value_type> operator-(const E& expr) {
+  return {as_operand(expr), typename E::value_type(-1)};
+}
+
+template <matrix_operand L, matrix_operand R>
+  requires(lazy_expression<L> or lazy_expression<R>)
+ElementwiseExpr<ElementwiseOp::Hadamard, operand_t<L>, operand_t<R>>
+hadamard_product(const L& lhs, const R& rhs) {
+  return {as_operand(lhs), as_operand(rhs)};
+}
+
+template <lazy_expression E>
+TransposeExpr<E> transpose(const E& expr) {
+  return TransposeExpr<E>(expr);
+}
+
+template <lazy_expression E>
+Matrix<typename E::value_type> evaluate(const E& expr) {
+  return Matrix<typename E::value_type>(expr);
+}
+
+template <lazy_expression E>
+MATRIX<typename E::value_type> to_legacy(const E& expr) {
+  using T = typename E::value_type;
+  MATRIX<T> res(expr.rows(), std::vector<T>(expr.cols()));
+  parallel_for(expr.rows(), parallel_row_grain(expr.cols()),
+               [&](std::size_t begin, std::size_t end) {
+                 for (std::size_t i = begin; i < end; i++)
+                   for (std::size_t j = 0; j < expr.cols(); j++)
+                     res[i][j] = expr(i, j);
+               });
+  return res;
+}
+
+}  // namespace algebra
+
+#endif  // AUT_AP_2024_Spring_HW1_EXPR
@@ -0,0 +1,328 @@
+#ifndef AUT_AP_2024_Spring_HW1_FIXED_MATRIX
+#define AUT_AP_2024_Spring_HW1_FIXED_MATRIX
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "view.h"
+
+namespace algebra {
+// Matrix whose shape is part of its type, for small transforms (3x3, 4x4)
+// that are created by the million. Elements live inside the object, every
+// operation is constexpr and fully unrolled, and mismatched shapes fail to
+// compile instead of throwing. Large shapes should use Matrix<T>: the
+// unrolled multiply grows with R * C * K.
+template <typename T, std::size_t R, std::size_t C>
+class FixedMatrix {
+  static_assert(R > 0 and C > 0, "A fixed matrix cannot be empty.");
+
+ public:
+  using value_type = T;
+
+  // Zero matrix
+  constexpr FixedMatrix() = default;
+  // Row by row, e.g. FixedMatrix<int, 2, 2> m = {{1, 2}, {3, 4}}; a wrong
+  // shape is a compile error in constant expressions and throws otherwise
+  constexpr FixedMatrix(std::initializer_list<std::initializer_list<T>> init);
+  // Copy of a dynamic matrix of the same shape
+  explicit FixedMatrix(const Matrix<T>& matrix);
+  explicit FixedMatrix(const MATRIX<T>& matrix);
+
+  static constexpr FixedMatrix filled(const T& value);
+  static constexpr FixedMatrix identity()
+    requires(R == C);
+
+  static constexpr std::size_t rows() { return R; }
+  static constexpr std::size_t cols() { return C; }
+  static constexpr std::size_t stride() { return C; }
+  static constexpr std::size_t size() { return R * C; }
+
+  constexpr T* data() { return data_.data(); }
+  constexpr const T* data() const { return data_.data(); }
+  constexpr T* row(std::size_t i) { return data_.data() + i * C; }
+  constexpr const T* row(std::size_t i) const { return data_.data() + i * C; }
+
+  constexpr T& operator()(std::size_t i, std::size_t j) {
+    return data_[i * C + j];
+  }
+  constexpr const T& operator()(std::size_t i, std::size_t j) const {
+    return data_[i * C + j];
+  }
+
+  Matrix<T> to_matrix() const;
+  MATRIX<T> to_legacy() const;
+
+  constexpr bool operator==(const FixedMatrix&) const = default;
+
+ private:
+  std::array<T, R * C> data_{};
+};
+
+template <typename T>
+using FixedMatrix3 = FixedMatrix<T, 3, 3>;
+
+template <typename T>
+using FixedMatrix4 = FixedMatrix<T, 4, 4>;
+
+template <typename T>
+inline constexpr bool is_fixed_matrix_v = false;
+
+template <typename T, std::size_t R, std::size_t C>
+inline constexpr bool is_fixed_matrix_v<FixedMatrix<T, R, C>> = true;
+
+// Call f(std::integral_constant<std::size_t, I>{}) for I = 0 .. N - 1,
+// unrolled at compile time
+template <std::size_t N, typename F>
+constexpr void fixed_unroll(F&& f);
+
+// Conversions and views; the views work with every view.h routine
+template <typename T, std::size_t R, std::size_t C>
+Matrix<T> to_matrix(const FixedMatrix<T, R, C>& matrix);
+
+template <typename T, std::size_t R, std::size_t C>
+MATRIX<T> to_legacy(const FixedMatrix<T, R, C>& matrix);
+
+template <typename T, std::size_t R, std::size_t C>
+MatrixView<T> view(const FixedMatrix<T, R, C>& matrix);
+
+template <typename T, std::size_t R, std::size_t C>
+MatrixSpan<T> span(FixedMatrix<T, R, C>& matrix);
+
+template <typename T, std::size_t R, std::size_t C>
+void display(const FixedMatrix<T, R, C>& matrix);
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr std::pair<size_t, size_t> matrix_size(const FixedMatrix<T, R, C>&);
+
+// Same contract as the MATRIX<T> overload; the shapes must already agree
+template <typename T, std::size_t R, std::size_t C>
+FixedMatrix<T, R, C> sum_sub(const FixedMatrix<T, R, C>& matrixA,
+                             const FixedMatrix<T, R, C>& matrixB,
+                             std::optional<std::string> operation = "sum");
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr FixedMatrix<T, R, C> operator+(const FixedMatrix<T, R, C>& matrixA,
+                                         const FixedMatrix<T, R, C>& matrixB);
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr FixedMatrix<T, R, C> operator-(const FixedMatrix<T, R, C>& matrixA,
+                                         const FixedMatrix<T, R, C>& matrixB);
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr FixedMatrix<T, R, C> multiply(const FixedMatrix<T, R, C>& matrix,
+                                        const T scalar);
+
+template <typename T, std::size_t R, std::size_t K, std::size_t C>
+constexpr FixedMatrix<T, R, C> multiply(const FixedMatrix<T, R, K>& matrixA,
+                                        const FixedMatrix<T, K, C>& matrixB);
+
+template <typename T, std::size_t R, std::size_t K, std::size_t C>
+constexpr FixedMatrix<T, R, C> operator*(const FixedMatrix<T, R, K>& matrixA,
+                                         const FixedMatrix<T, K, C>& matrixB);
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr FixedMatrix<T, R, C> hadamard_product(
+    const FixedMatrix<T, R, C>& matrixA, const FixedMatrix<T, R, C>& matrixB);
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr FixedMatrix<T, C, R> transpose(const FixedMatrix<T, R, C>& matrix);
+
+template <typename T, std::size_t N>
+constexpr T trace(const FixedMatrix<T, N, N>& matrix);
+
+////////////////////////////
+////// Implementation //////
+////////////////////////////
+
+template <std::size_t N, typename F>
+constexpr void fixed_unroll(F&& f) {
+  [&]<std::size_t... I>(std::index_sequence<I...>) {
+    (f(std::integral_constant<std::size_t, I>{}), ...);
+  }(std::make_index_sequence<N>{});
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr FixedMatrix<T, R, C>::FixedMatrix(
+    std::initializer_list<std::initializer_list<T>> init) {
+  if (init.size() != R)
+    throw std::logic_error("Matrix dimensions do not match.");
+  std::size_t i = 0;
+  for (const auto& row : init) {
+    if (row.size() != C)
+      throw std::logic_error("Matrix dimensions do not match.");
+    std::size_t j = 0;
+    for (const T& value : row) (*this)(i, j++) = value;
+    i++;
+  }
+}
+
+template <typename T, std::size_t R, std::size_t C>
+FixedMatrix<T, R, C>::FixedMatrix(const Matrix<T>& matrix) {
+  if (matrix.rows() != R or matrix.cols() != C)
+    throw std::logic_error("Matrix dimensions are not same.");
+  for (std::size_t i = 0; i < R; i++)
+    std::copy(matrix.row(i), matrix.row(i) + C, row(i));
+}
+
+template <typename T, std::size_t R, std::size_t C>
+FixedMatrix<T, R, C>::FixedMatrix(const MATRIX<T>& matrix) {
+  if (matrix_size(matrix) != std::make_pair(R, C))
+    throw std::logic_error("Matrix dimensions are not same.");
+  for (std::size_t i = 0; i < R; i++) {
+    // a longer later row would run past the fixed storage
+    if (matrix[i].size() != C) {
+      throw std::logic_error("Matrix dimensions are not same.");
+    }
+    std::copy(matrix[i].begin(), matrix[i].end(), row(i));
+  }
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr FixedMatrix<T, R, C> FixedMatrix<T, R, C>::filled(const T& value) {
+  FixedMatrix res;
+  res.data_.fill(value);
+  return res;
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr FixedMatrix<T, R, C> FixedMatrix<T, R, C>::identity()
+  requires(R == C)
+{
+  FixedMatrix res;
+  fixed_unroll<R>([&](auto i) { res(i, i) = T(1); });
+  return res;
+}
+
+template <typename T, std::size_t R, std::size_t C>
+Matrix<T> FixedMatrix<T, R, C>::to_matrix() const {
+  Matrix<T> res(R, C);
+  for (std::size_t i = 0; i < R; i++)
+    std::copy(row(i), row(i) + C, res.row(i));
+  return res;
+}
+
+template <typename T, std::size_t R, std::size_t C>
+MATRIX<T> FixedMatrix<T, R, C>::to_legacy() const {
+  MATRIX<T> res(R, std::vector<T>(C));
+  for (std::size_t i = 0; i < R; i++)
+    std::copy(row(i), row(i) + C, res[i].begin());
+  return res;
+}
+
+template <typename T, std::size_t R, std::size_t C>
+Matrix<T> to_matrix(const FixedMatrix<T, R, C>& matrix) {
+  return matrix.to_matrix();
+}
+
+template <typename T, std::size_t R, std::size_t C>
+MATRIX<T> to_legacy(const FixedMatrix<T, R, C>& matrix) {
+  return matrix.to_legacy();
+}
+
+template <typename T, std::size_t R, std::size_t C>
+MatrixView<T> view(const FixedMatrix<T, R, C>& matrix) {
+  return MatrixView<T>(matrix.data(), R, C, C);
+}
+
+template <typename T, std::size_t R, std::size_t C>
+MatrixSpan<T> span(FixedMatrix<T, R, C>& matrix) {
+  return MatrixSpan<T>(matrix.data(), R, C, C);
+}
+
+template <typename T, std::size_t R, std::size_t C>
+void display(const FixedMatrix<T, R, C>& matrix) {
+  display(view(matrix));
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr std::pair<size_t, size_t> matrix_size(const FixedMatrix<T, R, C>&) {
+  return std::make_pair(R, C);
+}
+
+template <typename T, std::size_t R, std::size_t C>
+FixedMatrix<T, R, C> sum_sub(const FixedMatrix<T, R, C>& matrixA,
+                             const FixedMatrix<T, R, C>& matrixB,
+                             std::optional<std::string> operation) {
+  if (operation.has_value() and operation.value() == "sub")
+    return matrixA - matrixB;
+  return matrixA + matrixB;
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr FixedMatrix<T, R, C> operator+(const FixedMatrix<T, R, C>& matrixA,
+                                         const FixedMatrix<T, R, C>& matrixB) {
+  FixedMatrix<T, R, C> res;
+  fixed_unroll<R * C>(
+      [&](auto k) { res.data()[k] = matrixA.data()[k] + matrixB.data()[k]; });
+  return res;
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr FixedMatrix<T, R, C> operator-(const FixedMatrix<T, R, C>& matrixA,
+                                         const FixedMatrix<T, R, C>& matrixB) {
+  FixedMatrix<T, R, C> res;
+  fixed_unroll<R * C>(
+      [&](auto k) { res.data()[k] = matrixA.data()[k] - matrixB.data()[k]; });
+  return res;
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr FixedMatrix<T, R, C> multiply(const FixedMatrix<T, R, C>& matrix,
+                                        const T scalar) {
+  FixedMatrix<T, R, C> res;
+  fixed_unroll<R * C>(
+      [&](auto k) { res.data()[k] = matrix.data()[k] * scalar; });
+  return res;
+}
+
+template <typename T, std::size_t R, std::size_t K, std::size_t C>
+constexpr FixedMatrix<T, R, C> multiply(const FixedMatrix<T, R, K>& matrixA,
+                                        const FixedMatrix<T, K, C>& matrixB) {
+  FixedMatrix<T, R, C> res;
+  fixed_unroll<R * C>([&](auto ij) {
+    const std::size_t i = ij / C, j = ij % C;
+    T acc = 0;
+    fixed_unroll<K>([&](auto k) { acc += matrixA(i, k) * matrixB(k, j); });
+    res(i, j) = acc;
+  });
+  return res;
+}
+
+template <typename T, std::size_t R, std::size_t K, std::size_t C>
+constexpr FixedMatrix<T, R, C> operator*(const FixedMatrix<T, R, K>& matrixA,
+                                         const FixedMatrix<T, K, C>& matrixB) {
+  return multiply(matrixA, matrixB);
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr FixedMatrix<T, R, C> hadamard_product(
+    const FixedMatrix<T, R, C>& matrixA, const FixedMatrix<T, R, C>& matrixB) {
+  FixedMatrix<T, R, C> res;
+  fixed_unroll<R * C>(
+      [&](auto k) { res.data()[k] = matrixA.data()[k] * matrixB.data()[k]; });
+  return res;
+}
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr FixedMatrix<T, C, R> transpose(const FixedMatrix<T, R, C>& matrix) {
+  FixedMatrix<T, C, R> res;
+  fixed_unroll<R * C>(
+      [&](auto ij) { res(ij % C, ij / C) = matrix.data()[ij]; });
+  return res;
+}
+
+template <typename T, std::size_t N>
+constexpr T trace(const FixedMatrix<T, N, N>& matrix) {
+  T res = 0;
+  fixed_unroll<N>([&](auto i) { res += matrix(i, i); });
+  return res;
+}
+
+}  // namespace algebra
+
+#endif  // AUT_AP_2024_Spring_HW1_FIXED_MATRIX
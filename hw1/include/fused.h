@@ -0,0 +1,132 @@
+#ifndef AUT_AP_2024_Spring_HW1_FUSED
+#define AUT_AP_2024_Spring_HW1_FUSED
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "gemm.h"
+#include "simd.h"
+#include "view.h"
+
+namespace algebra {
+// BLAS-style product in place:
+// C = epilogue(alpha * A * B + beta * C)
+// in one pass over C, without temporaries. C is not read when beta is 0 and
+// must not overlap A or B. The epilogue is called once per element of C as
+// f(value) or f(value, i, j), e.g. to add a bias and apply an activation,
+// while the freshly computed tile is still in registers; it may be called
+// from several threads at once.
+//
+//   gemm(1.0f, x, w, 0.0f, y, [&](float v, std::size_t, std::size_t j) {
+//     return std::max(v + bias[j], 0.0f);
+//   });
+template <dense_matrix A, dense_matrix B, typename C,
+          typename Epilogue = std::identity>
+  requires dense_matrix<std::remove_cvref_t<C>>
+void gemm(typename A::value_type alpha, const A& matrixA, const B& matrixB,
+          typename A::value_type beta, C&& matrixC, Epilogue epilogue = {});
+
+template <typename T, typename Epilogue = std::identity>
+void gemm(T alpha, const MATRIX<T>& matrixA, const MATRIX<T>& matrixB, T beta,
+          MATRIX<T>& matrixC, Epilogue epilogue = {});
+
+// The kernel behind gemm() on strided views
+template <typename T, typename Epilogue = std::identity>
+void gemm_into(MatrixView<T> a, MatrixView<T> b, MatrixSpan<T> c, T alpha = 1,
+               T beta = 0, Epilogue epilogue = {});
+
+////////////////////////////
+////// Implementation //////
+////////////////////////////
+
+template <typename T, typename Epilogue>
+void gemm_into(MatrixView<T> a, MatrixView<T> b, MatrixSpan<T> c, T alpha,
+               T beta, Epilogue epilogue) {
+  if (a.empty() or b.empty()) throw std::logic_error("Matrix is empty.");
+  if (a.cols() != b.rows() or c.rows() != a.rows() or c.cols() != b.cols())
+    throw std::logic_error("Matrix dimensions do not match.");
+  const std::size_t m = a.rows(), n = b.cols(), k = a.cols();
+
+  if (m * n * k >= gemm_blocked_min_ops()) {
+    const GemmScaleStore<T, Epilogue> store{alpha, beta, std::move(epilogue)};
+    if (a.contiguous_rows() and b.contiguous_rows() and c.contiguous_rows()) {
+      // unit column strides spare the packing a multiply per element
+      gemm_blocked_store<T>(
+          m, n, k, [&](std::size_t i, std::size_t p) { return a.row(i)[p]; },
+          [&](std::size_t p, std::size_t j) { return b.row(p)[j]; },
+          [&](std::size_t i, std::size_t j) -> T& { return c.row(i)[j]; },
+          store);
+    } else {
+      gemm_blocked_store<T>(
+          m, n, k, [&](std::size_t i, std::size_t p) { return a(i, p); },
+          [&](std::size_t p, std::size_t j) { return b(p, j); },
+          [&](std::size_t i, std::size_t j) -> T& { return c(i, j); }, store);
+    }
+    return;
+  }
+  // small products: each row of C is scaled, accumulated and finished while
+  // it stays in L1
+  const bool contiguous = b.contiguous_rows() and c.contiguous_rows();
+  for (std::size_t i = 0; i < m; i++) {
+    if (contiguous) {
+      T* r = c.row(i);
+      if (beta == T(0)) {
+        std::fill_n(r, n, T(0));
+      } else {
+        simd_scale(r, beta, r, n);
+      }
+      for (std::size_t p = 0; p < k; p++)
+        simd_axpy(alpha * a(i, p), b.row(p), r, n);
+    } else {
+      for (std::size_t j = 0; j < n; j++)
+        c(i, j) = beta == T(0) ? T(0) : beta * c(i, j);
+      for (std::size_t p = 0; p < k; p++) {
+        const T t = alpha * a(i, p);
+        for (std::size_t j = 0; j < n; j++) c(i, j) += t * b(p, j);
+      }
+    }
+    if constexpr (!std::is_same_v<Epilogue, std::identity>) {
+      for (std::size_t j = 0; j < n; j++)
+        c(i, j) = gemm_apply_epilogue(epilogue, c(i, j), i, j);
+    }
+  }
+}
+
+template <dense_matrix A, dense_matrix B, typename C, typename Epilogue>
+  requires dense_matrix<std::remove_cvref_t<C>>
+void gemm(typename A::value_type alpha, const A& matrixA, const B& matrixB,
+          typename A::value_type beta, C&& matrixC, Epilogue epilogue) {
+  using T = typename A::value_type;
+  static_assert(std::is_same_v<T, typename B::value_type>);
+  static_assert(
+      std::is_same_v<T, typename std::remove_cvref_t<C>::value_type>);
+  gemm_into(view(matrixA), view(matrixB), MatrixSpan<T>(matrixC), alpha, beta,
+            std::move(epilogue));
+}
+
+template <typename T, typename Epilogue>
+void gemm(T alpha, const MATRIX<T>& matrixA, const MATRIX<T>& matrixB, T beta,
+          MATRIX<T>& matrixC, Epilogue epilogue) {
+  const auto sizeA = matrix_size(matrixA);
+  const auto sizeB = matrix_size(matrixB);
+  if (sizeA.first == 0 or sizeA.second == 0 or sizeB.first == 0 or
+      sizeB.second == 0)
+    throw std::logic_error("Matrix is empty.");
+  if (sizeA.second != sizeB.first or
+      matrix_size(matrixC) != std::make_pair(sizeA.first, sizeB.second))
+    throw std::logic_error("Matrix dimensions do not match.");
+  gemm_blocked_store<T>(
+      sizeA.first, sizeB.second, sizeA.second,
+      [&](std::size_t i, std::size_t p) { return matrixA[i][p]; },
+      [&](std::size_t p, std::size_t j) { return matrixB[p][j]; },
+      [&](std::size_t i, std::size_t j) -> T& { return matrixC[i][j]; },
+      GemmScaleStore<T, Epilogue>{alpha, beta, std::move(epilogue)});
+}
+
+}  // namespace algebra
+
+#endif  // AUT_AP_2024_Spring_HW1_FUSED
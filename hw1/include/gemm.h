@@ -0,0 +1,318 @@
+#ifndef AUT_AP_2024_Spring_HW1_GEMM
+#define AUT_AP_2024_Spring_HW1_GEMM
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+#include "thread_pool.h"
+#include "tune.h"
+
+namespace algebra {
+// Width of the registers the micro-kernel is written for
+#if defined(__AVX512F__)
+inline constexpr std::size_t GEMM_VECTOR_BYTES = 64;
+#elif defined(__AVX__)
+inline constexpr std::size_t GEMM_VECTOR_BYTES = 32;
+#else
+inline constexpr std::size_t GEMM_VECTOR_BYTES = 16;
+#endif
+
+// Register tile (MR x NR) and default blocking for element type T.
+// Arithmetic types get a tile of MR x 2 vector registers; anything else uses
+// a small scalar tile.
+template <typename T>
+struct GemmTraits {
+  static constexpr bool vectorized =
+      std::is_arithmetic_v<T> and GEMM_VECTOR_BYTES % sizeof(T) == 0 and
+      sizeof(T) >= 4;
+  static constexpr std::size_t lanes =
+      vectorized ? GEMM_VECTOR_BYTES / sizeof(T) : 1;
+  static constexpr std::size_t MR = 4;
+  static constexpr std::size_t NR = vectorized ? 2 * lanes : 4;
+  static constexpr GemmBlocking blocking{sizeof(T) <= 4 ? 128 : 96,
+                                         sizeof(T) <= 4 ? 384 : 256, 2048};
+};
+
+// Products with at least this many multiply-adds go through gemm_blocked()
+inline constexpr std::size_t GEMM_BLOCKED_MIN_OPS = 48 * 48 * 48;
+
+// The blocking (see GemmBlocking in tune.h) and cutoff in use: the ones
+// tune() measured for 4- and 8-byte vectorized types, the defaults above
+// otherwise
+template <typename T>
+GemmBlocking gemm_blocking();
+
+inline std::size_t gemm_blocked_min_ops();
+
+// C(m x n) += A(m x k) * B(k x n).
+// a(i, p) and b(p, j) return elements, c(i, j) returns a reference into C, so
+// any storage (nested vectors, strided buffers) can feed the kernel; operands
+// are copied into packed panels before the micro-kernel touches them.
+// Output tiles are spread over the shared thread pool; the accessors must be
+// safe to call from several threads at once.
+template <typename T, typename AccA, typename AccB, typename AccC>
+void gemm_blocked(std::size_t m, std::size_t n, std::size_t k, AccA a, AccB b,
+                  AccC c, GemmBlocking blocking = gemm_blocking<T>());
+
+// How one row of a finished register tile of A * B, ab[0:nr], is written
+// into C(i, j:j+nr).
+// `first`: this is the first panel of k summed into the elements;
+// `last`:  it is the last one, the elements are final once they are stored.
+// GemmAccumulate adds to C (the gemm_blocked() contract), GemmScaleStore
+// computes epilogue(alpha * A * B + beta * C) while the tile is still in
+// registers.
+struct GemmAccumulate {
+  template <typename T, typename AccC>
+  void operator()(AccC& c, std::size_t i, std::size_t j, const T* ab,
+                  std::size_t nr, bool first, bool last) const;
+};
+
+template <typename T, typename Epilogue = std::identity>
+struct GemmScaleStore {
+  T alpha = 1;
+  T beta = 0;  // C is not read when beta is 0
+  Epilogue epilogue{};
+
+  template <typename AccC>
+  void operator()(AccC& c, std::size_t i, std::size_t j, const T* ab,
+                  std::size_t nr, bool first, bool last) const;
+};
+
+// Element-wise epilogues are called either as f(value) or, to apply a bias
+// or anything else that depends on the position, as f(value, i, j)
+template <typename T, typename Epilogue>
+T gemm_apply_epilogue(const Epilogue& epilogue, T value, std::size_t i,
+                      std::size_t j);
+
+// gemm_blocked() writing its tiles through `store`; every element of C is
+// visited, so `store` also covers the beta * C part for the whole matrix
+template <typename T, typename AccA, typename AccB, typename AccC,
+          typename Store>
+void gemm_blocked_store(std::size_t m, std::size_t n, std::size_t k, AccA a,
+                        AccB b, AccC c, const Store& store,
+                        GemmBlocking blocking = gemm_blocking<T>());
+
+// Packing and micro-kernel building blocks of gemm_blocked()
+template <typename T, std::size_t MR, typename AccA>
+void gemm_pack_a(std::size_t mc, std::size_t kc, std::size_t ic,
+                 std::size_t pc, AccA& a, T* packed);
+
+template <typename T, std::size_t NR, typename AccB>
+void gemm_pack_b(std::size_t kc, std::size_t nc, std::size_t pc,
+                 std::size_t jc, AccB& b, T* packed);
+
+template <typename T, std::size_t MR, std::size_t NR>
+void gemm_micro_kernel(std::size_t kc, const T* __restrict packedA,
+                       const T* __restrict packedB, T (&ab)[MR][NR]);
+
+// C[ic:ic+mc, jc:jc+nc] += A[ic:ic+mc, :] * B[:, jc:jc+nc], or whatever
+// `store` makes of it
+template <typename T, typename AccA, typename AccB, typename AccC,
+          typename Store = GemmAccumulate>
+void gemm_tile(std::size_t ic, std::size_t mc, std::size_t jc, std::size_t nc,
+               std::size_t k, AccA& a, AccB& b, AccC& c, std::size_t kc_block,
+               const Store& store = {});
+
+////////////////////////////
+////// Implementation //////
+////////////////////////////
+
+template <typename T>
+GemmBlocking gemm_blocking() {
+  if constexpr (GemmTraits<T>::vectorized and
+                (sizeof(T) == 4 or sizeof(T) == 8)) {
+    const GemmBlocking& tuned =
+        sizeof(T) == 4 ? tuning().gemm4 : tuning().gemm8;
+    if (tuned.mc != 0 and tuned.kc != 0 and tuned.nc != 0) return tuned;
+  }
+  return GemmTraits<T>::blocking;
+}
+
+inline std::size_t gemm_blocked_min_ops() {
+  const std::size_t tuned = tuning().gemm_min_ops;
+  return tuned != 0 ? tuned : GEMM_BLOCKED_MIN_OPS;
+}
+
+template <typename T, std::size_t MR, typename AccA>
+void gemm_pack_a(std::size_t mc, std::size_t kc, std::size_t ic,
+                 std::size_t pc, AccA& a, T* packed) {
+  // MR-row slivers, stored column by column; the last one is zero padded
+  for (std::size_t ir = 0; ir < mc; ir += MR) {
+    const std::size_t mr = std::min(MR, mc - ir);
+    for (std::size_t p = 0; p < kc; p++) {
+      std::size_t i = 0;
+      for (; i < mr; i++) packed[i] = a(ic + ir + i, pc + p);
+      for (; i < MR; i++) packed[i] = T(0);
+      packed += MR;
+    }
+  }
+}
+
+template <typename T, std::size_t NR, typename AccB>
+void gemm_pack_b(std::size_t kc, std::size_t nc, std::size_t pc,
+                 std::size_t jc, AccB& b, T* packed) {
+  // NR-column slivers, stored row by row; the last one is zero padded
+  for (std::size_t jr = 0; jr < nc; jr += NR) {
+    const std::size_t nr = std::min(NR, nc - jr);
+    for (std::size_t p = 0; p < kc; p++) {
+      std::size_t j = 0;
+      for (; j < nr; j++) packed[j] = b(pc + p, jc + jr + j);
+      for (; j < NR; j++) packed[j] = T(0);
+      packed += NR;
+    }
+  }
+}
+
+template <typename T, std::size_t MR, std::size_t NR>
+void gemm_micro_kernel(std::size_t kc, const T* __restrict packedA,
+                       const T* __restrict packedB, T (&ab)[MR][NR]) {
+  if constexpr (GemmTraits<T>::vectorized) {
+    // each row of the tile lives in NR / lanes vector registers
+    constexpr std::size_t L = GemmTraits<T>::lanes;
+    constexpr std::size_t NV = NR / L;
+    using V [[gnu::vector_size(GEMM_VECTOR_BYTES)]] = T;
+    V acc[MR][NV] = {};
+    for (std::size_t p = 0; p < kc; p++) {
+      V b[NV];
+      std::memcpy(b, packedB, sizeof(b));
+      for (std::size_t i = 0; i < MR; i++)
+        for (std::size_t v = 0; v < NV; v++) acc[i][v] += packedA[i] * b[v];
+      packedA += MR;
+      packedB += NR;
+    }
+    for (std::size_t i = 0; i < MR; i++)
+      std::memcpy(ab[i], acc[i], sizeof(ab[i]));
+  } else {
+    T acc[MR][NR] = {};
+    for (std::size_t p = 0; p < kc; p++) {
+      for (std::size_t i = 0; i < MR; i++) {
+        const T ai = packedA[i];
+        for (std::size_t j = 0; j < NR; j++) acc[i][j] += ai * packedB[j];
+      }
+      packedA += MR;
+      packedB += NR;
+    }
+    for (std::size_t i = 0; i < MR; i++)
+      for (std::size_t j = 0; j < NR; j++) ab[i][j] = acc[i][j];
+  }
+}
+
+template <typename T, typename AccC>
+void GemmAccumulate::operator()(AccC& c, std::size_t i, std::size_t j,
+                                const T* ab, std::size_t nr, bool,
+                                bool) const {
+  for (std::size_t jj = 0; jj < nr; jj++) c(i, j + jj) += ab[jj];
+}
+
+template <typename T, typename Epilogue>
+T gemm_apply_epilogue(const Epilogue& epilogue, T value, std::size_t i,
+                      std::size_t j) {
+  if constexpr (std::is_invocable_v<const Epilogue&, T, std::size_t,
+                                    std::size_t>) {
+    return static_cast<T>(std::invoke(epilogue, value, i, j));
+  } else {
+    return static_cast<T>(std::invoke(epilogue, value));
+  }
+}
+
+template <typename T, typename Epilogue>
+template <typename AccC>
+void GemmScaleStore<T, Epilogue>::operator()(AccC& c, std::size_t i,
+                                             std::size_t j, const T* ab,
+                                             std::size_t nr, bool first,
+                                             bool last) const {
+  // the branches stay outside the loops so each of them vectorizes
+  const T scale = first ? beta : T(1);
+  T value[GemmTraits<T>::NR];
+  if (scale == T(0)) {
+    for (std::size_t jj = 0; jj < nr; jj++) value[jj] = alpha * ab[jj];
+  } else {
+    for (std::size_t jj = 0; jj < nr; jj++)
+      value[jj] = alpha * ab[jj] + scale * c(i, j + jj);
+  }
+  if (last) {
+    for (std::size_t jj = 0; jj < nr; jj++)
+      value[jj] = gemm_apply_epilogue(epilogue, value[jj], i, j + jj);
+  }
+  for (std::size_t jj = 0; jj < nr; jj++) c(i, j + jj) = value[jj];
+}
+
+template <typename T, typename AccA, typename AccB, typename AccC,
+          typename Store>
+void gemm_tile(std::size_t ic, std::size_t mc, std::size_t jc, std::size_t nc,
+               std::size_t k, AccA& a, AccB& b, AccC& c, std::size_t kc_block,
+               const Store& store) {
+  constexpr std::size_t MR = GemmTraits<T>::MR;
+  constexpr std::size_t NR = GemmTraits<T>::NR;
+  const std::size_t kc_max = std::min(kc_block, k);
+  thread_local std::vector<T> packedA, packedB;
+  packedA.resize((mc + MR - 1) / MR * MR * kc_max);
+  packedB.resize((nc + NR - 1) / NR * NR * kc_max);
+
+  for (std::size_t pc = 0; pc < k; pc += kc_block) {
+    const std::size_t kc = std::min(kc_block, k - pc);
+    const bool first = pc == 0, last = pc + kc == k;
+    gemm_pack_b<T, NR>(kc, nc, pc, jc, b, packedB.data());
+    gemm_pack_a<T, MR>(mc, kc, ic, pc, a, packedA.data());
+
+    for (std::size_t jr = 0; jr < nc; jr += NR) {
+      const std::size_t nr = std::min(NR, nc - jr);
+      for (std::size_t ir = 0; ir < mc; ir += MR) {
+        const std::size_t mr = std::min(MR, mc - ir);
+        T ab[MR][NR];
+        gemm_micro_kernel<T, MR, NR>(kc, packedA.data() + ir * kc,
+                                     packedB.data() + jr * kc, ab);
+        for (std::size_t i = 0; i < mr; i++)
+          store(c, ic + ir + i, jc + jr, ab[i], nr, first, last);
+      }
+    }
+  }
+}
+
+template <typename T, typename AccA, typename AccB, typename AccC>
+void gemm_blocked(std::size_t m, std::size_t n, std::size_t k, AccA a, AccB b,
+                  AccC c, GemmBlocking blocking) {
+  gemm_blocked_store<T>(m, n, k, a, b, c, GemmAccumulate{}, blocking);
+}
+
+template <typename T, typename AccA, typename AccB, typename AccC,
+          typename Store>
+void gemm_blocked_store(std::size_t m, std::size_t n, std::size_t k, AccA a,
+                        AccB b, AccC c, const Store& store,
+                        GemmBlocking blocking) {
+  if (m == 0 or n == 0 or k == 0) return;
+
+  // Each mc x nc tile of C is owned by one task and accumulated over k in
+  // the same order as on one thread, so the result does not depend on the
+  // number of threads.
+  constexpr std::size_t NR = GemmTraits<T>::NR;
+  const std::size_t row_tiles = (m + blocking.mc - 1) / blocking.mc;
+  std::size_t nc = blocking.nc;
+  const std::size_t threads = get_num_threads();
+  if (threads > 1 and m * n * k >= gemm_blocked_min_ops()) {
+    // narrower column tiles until every thread has a few tiles to work on
+    const std::size_t wanted = (4 * threads + row_tiles - 1) / row_tiles;
+    const std::size_t width = (n + wanted - 1) / wanted;
+    nc = std::min(nc, std::max(NR, (width + NR - 1) / NR * NR));
+  }
+  const std::size_t col_tiles = (n + nc - 1) / nc;
+
+  parallel_for(row_tiles * col_tiles, 1,
+               [&](std::size_t begin, std::size_t end) {
+                 for (std::size_t t = begin; t < end; t++) {
+                   const std::size_t ic = (t % row_tiles) * blocking.mc;
+                   const std::size_t jc = (t / row_tiles) * nc;
+                   gemm_tile<T>(ic, std::min(blocking.mc, m - ic), jc,
+                                std::min(nc, n - jc), k, a, b, c,
+                                blocking.kc, store);
+                 }
+               });
+}
+
+}  // namespace algebra
+
+#endif  // AUT_AP_2024_Spring_HW1_GEMM
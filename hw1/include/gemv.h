@@ -0,0 +1,184 @@
+#ifndef AUT_AP_2024_Spring_HW1_GEMV
+#define AUT_AP_2024_Spring_HW1_GEMV
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "simd.h"
+#include "thread_pool.h"
+#include "view.h"
+
+namespace algebra {
+// Columns of y each task of gevm() keeps hot while it walks the rows of A
+inline constexpr std::size_t GEVM_COLUMN_BLOCK = 2048;
+
+// Matrix-vector products on plain vectors, without going through an n x 1
+// matrix.
+// y = A * x
+template <dense_matrix M>
+std::vector<typename M::value_type> gemv(
+    const M& matrix, const std::vector<typename M::value_type>& x);
+
+template <typename T>
+std::vector<T> gemv(const MATRIX<T>& matrix, const std::vector<T>& x);
+
+// y = x^T * A, i.e. A^T * x without forming the transpose
+template <dense_matrix M>
+std::vector<typename M::value_type> gevm(
+    const std::vector<typename M::value_type>& x, const M& matrix);
+
+template <typename T>
+std::vector<T> gevm(const std::vector<T>& x, const MATRIX<T>& matrix);
+
+// BLAS-style kernels: y = alpha * A * x + beta * y (rows() elements of y)
+// and y = alpha * x^T * A + beta * y (cols() elements). y is not read when
+// beta is 0. Rows are split over the thread pool for gemv_into, columns for
+// gevm_into, so each y[i] is computed by one task and the result does not
+// depend on the thread count.
+template <typename T>
+void gemv_into(MatrixView<T> a, const T* x, T* y, T alpha = 1, T beta = 0);
+
+template <typename T>
+void gevm_into(const T* x, MatrixView<T> a, T* y, T alpha = 1, T beta = 0);
+
+////////////////////////////
+////// Implementation //////
+////////////////////////////
+
+// Column chunks of gevm() start on a multiple of the widest vector, so
+// every column goes through the same kernel lanes for any thread count
+template <typename T>
+constexpr std::size_t gevm_lanes() {
+  return std::max<std::size_t>(1, MATRIX_ALIGNMENT / sizeof(T));
+}
+
+template <typename T>
+void gemv_into(MatrixView<T> a, const T* x, T* y, T alpha, T beta) {
+  // a transposed view is a row-major matrix read the other way around
+  if (!a.contiguous_rows() and a.row_stride() == 1) {
+    gevm_into(x, a.transposed(), y, alpha, beta);
+    return;
+  }
+  parallel_for(a.rows(), parallel_row_grain(a.cols()),
+               [&](std::size_t begin, std::size_t end) {
+                 for (std::size_t i = begin; i < end; i++) {
+                   T dot = 0;
+                   if (a.contiguous_rows()) {
+                     dot = simd_dot(a.row(i), x, a.cols());
+                   } else {
+                     for (std::size_t j = 0; j < a.cols(); j++)
+                       dot += a(i, j) * x[j];
+                   }
+                   y[i] = beta == T(0) ? alpha * dot
+                                       : alpha * dot + beta * y[i];
+                 }
+               });
+}
+
+template <typename T>
+void gevm_into(const T* x, MatrixView<T> a, T* y, T alpha, T beta) {
+  if (!a.contiguous_rows() and a.row_stride() == 1) {
+    gemv_into(a.transposed(), x, y, alpha, beta);
+    return;
+  }
+  const std::size_t m = a.rows(), n = a.cols();
+  // every task owns a range of columns and accumulates them row by row
+  parallel_for_aligned(
+      n, std::max(parallel_row_grain(m), std::min(n, GEVM_COLUMN_BLOCK / 8)),
+      gevm_lanes<T>(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t j0 = begin; j0 < end; j0 += GEVM_COLUMN_BLOCK) {
+          const std::size_t j1 = std::min(end, j0 + GEVM_COLUMN_BLOCK);
+          if (beta == T(0)) {
+            std::fill(y + j0, y + j1, T(0));
+          } else if (beta != T(1)) {
+            simd_scale(y + j0, beta, y + j0, j1 - j0);
+          }
+          for (std::size_t i = 0; i < m; i++) {
+            const T xi = alpha * x[i];
+            if (a.contiguous_rows()) {
+              simd_axpy(xi, a.row(i) + j0, y + j0, j1 - j0);
+            } else {
+              for (std::size_t j = j0; j < j1; j++) y[j] += xi * a(i, j);
+            }
+          }
+        }
+      });
+}
+
+template <dense_matrix M>
+std::vector<typename M::value_type> gemv(
+    const M& matrix, const std::vector<typename M::value_type>& x) {
+  using T = typename M::value_type;
+  const MatrixView<T> a = view(matrix);
+  if (a.empty()) throw std::logic_error("Matrix is empty.");
+  if (x.size() != a.cols()) {
+    throw std::logic_error("Matrix dimensions do not match.");
+  }
+  std::vector<T> y(a.rows());
+  gemv_into(a, x.data(), y.data());
+  return y;
+}
+
+template <typename T>
+std::vector<T> gemv(const MATRIX<T>& matrix, const std::vector<T>& x) {
+  if (matrix.empty() or matrix[0].empty()) {
+    throw std::logic_error("Matrix is empty.");
+  }
+  for (const auto& row : matrix)
+    if (row.size() != x.size()) {
+      throw std::logic_error("Matrix dimensions do not match.");
+    }
+  std::vector<T> y(matrix.size());
+  parallel_for(matrix.size(), parallel_row_grain(x.size()),
+               [&](std::size_t begin, std::size_t end) {
+                 for (std::size_t i = begin; i < end; i++)
+                   y[i] = simd_dot(matrix[i].data(), x.data(), x.size());
+               });
+  return y;
+}
+
+template <dense_matrix M>
+std::vector<typename M::value_type> gevm(
+    const std::vector<typename M::value_type>& x, const M& matrix) {
+  using T = typename M::value_type;
+  const MatrixView<T> a = view(matrix);
+  if (a.empty()) throw std::logic_error("Matrix is empty.");
+  if (x.size() != a.rows()) {
+    throw std::logic_error("Matrix dimensions do not match.");
+  }
+  std::vector<T> y(a.cols());
+  gevm_into(x.data(), a, y.data());
+  return y;
+}
+
+template <typename T>
+std::vector<T> gevm(const std::vector<T>& x, const MATRIX<T>& matrix) {
+  if (matrix.empty() or matrix[0].empty()) {
+    throw std::logic_error("Matrix is empty.");
+  }
+  if (x.size() != matrix.size()) {
+    throw std::logic_error("Matrix dimensions do not match.");
+  }
+  const std::size_t n = matrix[0].size();
+  for (const auto& row : matrix)
+    if (row.size() != n) {
+      throw std::logic_error("Matrix dimensions are not same.");
+    }
+  std::vector<T> y(n);
+  parallel_for_aligned(n,
+                       std::max(parallel_row_grain(x.size()),
+                                std::min(n, GEVM_COLUMN_BLOCK / 8)),
+                       gevm_lanes<T>(),
+                       [&](std::size_t begin, std::size_t end) {
+                         for (std::size_t i = 0; i < matrix.size(); i++)
+                           simd_axpy(x[i], matrix[i].data() + begin,
+                                     y.data() + begin, end - begin);
+                       });
+  return y;
+}
+
+}  // namespace algebra
+
+#endif  // AUT_AP_2024_Spring_HW1_GEMV
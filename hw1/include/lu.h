@@ -0,0 +1,266 @@
+#ifndef AUT_AP_2024_Spring_HW1_LU
+#define AUT_AP_2024_Spring_HW1_LU
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "gemm.h"
+#include "view.h"
+
+namespace algebra {
+// Columns factorized per panel by the blocked LU
+inline constexpr std::size_t LU_BLOCK = 64;
+
+// LU factorization with partial pivoting, P * A = L * U.
+// L (unit diagonal, below it) and U (on and above the diagonal) share one
+// matrix, as in LAPACK's getrf; pivots()[j] is the row swapped with row j
+// at step j. A factorization can be reused for any number of solves.
+// A matrix with an exactly zero pivot is singular: determinant() is 0 and
+// solve() and inverse() throw.
+template <std::floating_point T>
+class LU {
+ public:
+  explicit LU(Matrix<T> matrix);
+
+  std::size_t size() const { return factors_.rows(); }
+  const Matrix<T>& factors() const { return factors_; }
+  const std::vector<std::size_t>& pivots() const { return pivots_; }
+  bool singular() const { return singular_; }
+
+  T determinant() const;
+  // X with A * X = B, for every column of B
+  Matrix<T> solve(const Matrix<T>& b) const;
+  Matrix<T> inverse() const;
+
+ private:
+  Matrix<T> factors_;
+  std::vector<std::size_t> pivots_;
+  bool singular_ = false;
+};
+
+template <std::floating_point T>
+LU<T> lu(const Matrix<T>& matrix);
+
+template <std::floating_point T>
+LU<T> lu(const MATRIX<T>& matrix);
+
+// In-place blocked factorization of a square span with contiguous rows;
+// returns false if a pivot is exactly zero
+template <std::floating_point T>
+bool lu_factorize(MatrixSpan<T> a, std::vector<std::size_t>& pivots,
+                  std::size_t block = LU_BLOCK);
+
+// Unblocked factorization of columns [col, col + width) of rows [col, n),
+// swapping whole rows of `a`
+template <std::floating_point T>
+bool lu_panel(MatrixSpan<T> a, std::size_t col, std::size_t width,
+              std::vector<std::size_t>& pivots);
+
+// Determinant, inverse and solve(A, B) through an LU factorization
+template <std::floating_point T>
+T determinant(const Matrix<T>& matrix);
+
+template <std::floating_point T>
+T determinant(const MATRIX<T>& matrix);
+
+template <std::floating_point T>
+Matrix<T> inverse(const Matrix<T>& matrix);
+
+template <std::floating_point T>
+MATRIX<T> inverse(const MATRIX<T>& matrix);
+
+template <std::floating_point T>
+Matrix<T> solve(const Matrix<T>& matrixA, const Matrix<T>& matrixB);
+
+template <std::floating_point T>
+MATRIX<T> solve(const MATRIX<T>& matrixA, const MATRIX<T>& matrixB);
+
+////////////////////////////
+////// Implementation //////
+////////////////////////////
+
+template <std::floating_point T>
+bool lu_panel(MatrixSpan<T> a, std::size_t col, std::size_t width,
+              std::vector<std::size_t>& pivots) {
+  const std::size_t n = a.rows();
+  bool regular = true;
+  for (std::size_t j = col; j < col + width; j++) {
+    std::size_t p = j;
+    for (std::size_t i = j + 1; i < n; i++)
+      if (std::abs(a(i, j)) > std::abs(a(p, j))) p = i;
+    pivots[j] = p;
+    if (p != j) std::swap_ranges(a.row(j), a.row(j) + n, a.row(p));
+    if (a(j, j) == T(0)) {
+      regular = false;
+      continue;
+    }
+    // multipliers, then a rank-1 update of the rest of the panel
+    const T inv = T(1) / a(j, j);
+    const T* pivot_row = a.row(j);
+    for (std::size_t i = j + 1; i < n; i++) {
+      T* row = a.row(i);
+      const T l = row[j] *= inv;
+      for (std::size_t c = j + 1; c < col + width; c++)
+        row[c] -= l * pivot_row[c];
+    }
+  }
+  return regular;
+}
+
+template <std::floating_point T>
+bool lu_factorize(MatrixSpan<T> a, std::vector<std::size_t>& pivots,
+                  std::size_t block) {
+  if (a.rows() != a.cols()) throw std::logic_error("Matrix must be square.");
+  if (!a.contiguous_rows()) {
+    throw std::logic_error("The rows of the matrix must be contiguous.");
+  }
+  const std::size_t n = a.rows();
+  block = std::max<std::size_t>(block, 1);
+  pivots.resize(n);
+  bool regular = true;
+  for (std::size_t k = 0; k < n; k += block) {
+    const std::size_t kb = std::min(block, n - k);
+    regular &= lu_panel(a, k, kb, pivots);
+    const std::size_t rest = n - k - kb;
+    if (rest == 0) break;
+
+    // U12 = L11^-1 * A12, split by columns over the pool
+    const auto u12 = a.block(k, k + kb, kb, rest);
+    parallel_for(rest, std::max<std::size_t>(parallel_min_elements() / kb, 1),
+                 [&](std::size_t begin, std::size_t end) {
+                   for (std::size_t i = 1; i < kb; i++)
+                     for (std::size_t p = 0; p < i; p++) {
+                       const T l = a(k + i, k + p);
+                       T* dst = u12.row(i);
+                       const T* src = u12.row(p);
+                       for (std::size_t c = begin; c < end; c++)
+                         dst[c] -= l * src[c];
+                     }
+                 });
+
+    // right-looking update A22 -= L21 * U12 with the blocked GEMM
+    const auto l21 = a.block(k + kb, k, rest, kb);
+    const auto a22 = a.block(k + kb, k + kb, rest, rest);
+    gemm_blocked<T>(
+        rest, rest, kb,
+        [&](std::size_t i, std::size_t p) { return -l21(i, p); },
+        [&](std::size_t p, std::size_t j) { return u12(p, j); },
+        [&](std::size_t i, std::size_t j) -> T& { return a22(i, j); });
+  }
+  return regular;
+}
+
+template <std::floating_point T>
+LU<T>::LU(Matrix<T> matrix) : factors_(std::move(matrix)) {
+  if (factors_.empty()) throw std::logic_error("Matrix is empty.");
+  singular_ = !lu_factorize(span(factors_), pivots_);
+}
+
+template <std::floating_point T>
+T LU<T>::determinant() const {
+  if (singular_) return T(0);
+  T det = 1;
+  for (std::size_t j = 0; j < size(); j++) {
+    det *= factors_(j, j);
+    if (pivots_[j] != j) det = -det;
+  }
+  return det;
+}
+
+template <std::floating_point T>
+Matrix<T> LU<T>::solve(const Matrix<T>& b) const {
+  if (b.rows() != size()) {
+    throw std::logic_error("Matrix dimensions do not match.");
+  }
+  if (singular_) throw std::logic_error("Matrix is singular.");
+  const std::size_t n = size(), m = b.cols();
+  Matrix<T> x = b;
+  for (std::size_t j = 0; j < n; j++)
+    if (pivots_[j] != j)
+      std::swap_ranges(x.row(j), x.row(j) + m, x.row(pivots_[j]));
+
+  // forward then backward substitution on whole rows of X, which the
+  // right-hand sides share; the columns are split over the pool
+  parallel_for(m, std::max<std::size_t>(parallel_min_elements() / n, 1),
+               [&](std::size_t begin, std::size_t end) {
+                 for (std::size_t i = 1; i < n; i++) {
+                   T* dst = x.row(i);
+                   for (std::size_t p = 0; p < i; p++) {
+                     const T l = factors_(i, p);
+                     const T* src = x.row(p);
+                     for (std::size_t c = begin; c < end; c++)
+                       dst[c] -= l * src[c];
+                   }
+                 }
+                 for (std::size_t i = n; i-- > 0;) {
+                   T* dst = x.row(i);
+                   for (std::size_t p = i + 1; p < n; p++) {
+                     const T u = factors_(i, p);
+                     const T* src = x.row(p);
+                     for (std::size_t c = begin; c < end; c++)
+                       dst[c] -= u * src[c];
+                   }
+                   const T inv = T(1) / factors_(i, i);
+                   for (std::size_t c = begin; c < end; c++) dst[c] *= inv;
+                 }
+               });
+  return x;
+}
+
+template <std::floating_point T>
+Matrix<T> LU<T>::inverse() const {
+  Matrix<T> identity(size(), size());
+  for (std::size_t i = 0; i < size(); i++) identity(i, i) = 1;
+  return solve(identity);
+}
+
+template <std::floating_point T>
+LU<T> lu(const Matrix<T>& matrix) {
+  return LU<T>(matrix);
+}
+
+template <std::floating_point T>
+LU<T> lu(const MATRIX<T>& matrix) {
+  if (matrix.empty()) throw std::logic_error("Matrix is empty.");
+  return LU<T>(to_matrix(matrix));
+}
+
+template <std::floating_point T>
+T determinant(const Matrix<T>& matrix) {
+  return lu(matrix).determinant();
+}
+
+template <std::floating_point T>
+T determinant(const MATRIX<T>& matrix) {
+  return lu(matrix).determinant();
+}
+
+template <std::floating_point T>
+Matrix<T> inverse(const Matrix<T>& matrix) {
+  return lu(matrix).inverse();
+}
+
+template <std::floating_point T>
+MATRIX<T> inverse(const MATRIX<T>& matrix) {
+  return lu(matrix).inverse().to_legacy();
+}
+
+template <std::floating_point T>
+Matrix<T> solve(const Matrix<T>& matrixA, const Matrix<T>& matrixB) {
+  return lu(matrixA).solve(matrixB);
+}
+
+template <std::floating_point T>
+MATRIX<T> solve(const MATRIX<T>& matrixA, const MATRIX<T>& matrixB) {
+  if (matrixB.empty()) throw std::logic_error("Matrix is empty.");
+  return lu(matrixA).solve(to_matrix(matrixB)).to_legacy();
+}
+
+}  // namespace algebra
+
+#endif  // AUT_AP_2024_Spring_HW1_LU
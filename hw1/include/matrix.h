@@ -0,0 +1,654 @@
+#ifndef AUT_AP_2024_Spring_HW1_MATRIX
+#define AUT_AP_2024_Spring_HW1_MATRIX
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "algebra.h"
+#include "arena.h"
+#include "simd.h"
+
+namespace algebra {
+// Alignment of the matrix buffer and of every row inside it (a cache line)
+inline constexpr std::size_t MATRIX_ALIGNMENT = 64;
+static_assert(ARENA_ALIGNMENT % MATRIX_ALIGNMENT == 0);
+
+// Lazy matrix expressions (see expr.h) are recognized by this tag
+template <typename E>
+concept lazy_expression = requires { typename E::expression_tag; };
+
+// Dense row-major matrix kept in a single aligned buffer.
+// Each row is padded to `stride()` elements so that rows start on a cache
+// line; padding cells are value-initialized and never part of the result.
+// The buffer comes from the heap, or from current_arena() when the matrix
+// is created inside an ArenaScope; copies take theirs from wherever the
+// copy is made, moves keep the original one.
+template <typename T>
+class Matrix {
+ public:
+  using value_type = T;
+
+  Matrix() = default;
+  Matrix(std::size_t rows, std::size_t cols);
+  Matrix(std::size_t rows, std::size_t cols, const T& value);
+  Matrix(std::initializer_list<std::initializer_list<T>> init);
+  explicit Matrix(const MATRIX<T>& matrix);
+
+  // Evaluate a lazy expression in a single pass, without temporaries
+  template <lazy_expression E>
+  Matrix(const E& expr);
+  template <lazy_expression E>
+  Matrix& operator=(const E& expr);
+
+  Matrix(const Matrix& other);
+  Matrix(Matrix&& other) noexcept;
+  Matrix& operator=(const Matrix& other);
+  Matrix& operator=(Matrix&& other) noexcept;
+  ~Matrix();
+
+  std::size_t rows() const { return rows_; }
+  std::size_t cols() const { return cols_; }
+  std::size_t stride() const { return stride_; }
+  std::size_t size() const { return rows_ * cols_; }
+  bool empty() const { return rows_ == 0 or cols_ == 0; }
+  // Arena holding the buffer, nullptr for the heap
+  MatrixArena* arena() const { return arena_; }
+
+  T* data() { return data_; }
+  const T* data() const { return data_; }
+  T* row(std::size_t i) { return data_ + i * stride_; }
+  const T* row(std::size_t i) const { return data_ + i * stride_; }
+
+  T& operator()(std::size_t i, std::size_t j) { return data_[i * stride_ + j]; }
+  const T& operator()(std::size_t i, std::size_t j) const {
+    return data_[i * stride_ + j];
+  }
+
+  // Copy back into the legacy vector-of-vectors representation
+  MATRIX<T> to_legacy() const;
+
+  void swap(Matrix& other) noexcept;
+
+  bool operator==(const Matrix& other) const;
+
+ private:
+  std::size_t rows_ = 0;
+  std::size_t cols_ = 0;
+  std::size_t stride_ = 0;
+  T* data_ = nullptr;
+  MatrixArena* arena_ = nullptr;
+
+  // Row length rounded up so that the next row stays aligned
+  static std::size_t padded_stride(std::size_t cols);
+  // Buffer from current_arena() or the heap; sets arena_ accordingly
+  T* allocate(std::size_t count);
+  void deallocate(T* ptr, std::size_t count) noexcept;
+
+  template <typename E>
+  void assign_from(const E& expr);
+};
+
+// Conversions between the legacy and the contiguous representation
+template <typename T>
+Matrix<T> to_matrix(const MATRIX<T>& matrix);
+
+template <typename T>
+MATRIX<T> to_legacy(const Matrix<T>& matrix);
+
+// Same contract as the MATRIX<T> overloads in algebra.h; a seeded random
+// matrix has the same elements as the MATRIX<T> one with that seed
+template <typename M>
+  requires is_matrix_v<M>
+M create_matrix(std::size_t rows, std::size_t columns,
+                std::optional<MatrixType> type = MatrixType::Zeros,
+                std::optional<typename M::value_type> lowerBound = std::nullopt,
+                std::optional<typename M::value_type> upperBound = std::nullopt,
+                std::optional<std::uint64_t> seed = std::nullopt);
+
+template <typename T>
+void display(const Matrix<T>& matrix);
+
+template <typename T>
+std::pair<size_t, size_t> matrix_size(const Matrix<T>& matrix);
+
+template <typename T>
+Matrix<T> sum_sub(const Matrix<T>& matrixA, const Matrix<T>& matrixB,
+                  std::optional<std::string> operation = "sum");
+
+template <typename T>
+Matrix<T> multiply(const Matrix<T>& matrix, const T scalar);
+
+template <typename T>
+Matrix<T> multiply(const Matrix<T>& matrixA, const Matrix<T>& matrixB);
+
+template <typename T>
+Matrix<T> hadamard_product(const Matrix<T>& matrixA, const Matrix<T>& matrixB);
+
+template <typename T>
+Matrix<T> transpose(const Matrix<T>& matrix);
+
+template <typename T>
+T trace(const Matrix<T>& matrix);
+
+// In-place variants; the first argument receives the result
+template <typename T>
+void add_inplace(Matrix<T>& matrixA, const Matrix<T>& matrixB);
+
+template <typename T>
+void sub_inplace(Matrix<T>& matrixA, const Matrix<T>& matrixB);
+
+template <typename T>
+void scale_inplace(Matrix<T>& matrix, const T scalar);
+
+template <typename T>
+void hadamard_inplace(Matrix<T>& matrixA, const Matrix<T>& matrixB);
+
+// Square matrices only: the padded layout of a transposed non-square
+// matrix does not fit its buffer (see transpose_dense_inplace() for dense
+// arrays)
+template <typename T>
+void transpose_inplace(Matrix<T>& matrix);
+
+// Overloads for temporaries; the result takes over the rvalue's buffer
+template <typename T>
+Matrix<T> sum_sub(Matrix<T>&& matrixA, const Matrix<T>& matrixB,
+                  std::optional<std::string> operation = "sum");
+
+template <typename T>
+Matrix<T> sum_sub(const Matrix<T>& matrixA, Matrix<T>&& matrixB,
+                  std::optional<std::string> operation = "sum");
+
+template <typename T>
+Matrix<T> sum_sub(Matrix<T>&& matrixA, Matrix<T>&& matrixB,
+                  std::optional<std::string> operation = "sum");
+
+template <typename T>
+Matrix<T> multiply(Matrix<T>&& matrix, const T scalar);
+
+template <typename T>
+Matrix<T> hadamard_product(Matrix<T>&& matrixA, const Matrix<T>& matrixB);
+
+template <typename T>
+Matrix<T> hadamard_product(const Matrix<T>& matrixA, Matrix<T>&& matrixB);
+
+template <typename T>
+Matrix<T> hadamard_product(Matrix<T>&& matrixA, Matrix<T>&& matrixB);
+
+////////////////////////////
+////// Implementation //////
+////////////////////////////
+
+template <typename T>
+std::size_t Matrix<T>::padded_stride(std::size_t cols) {
+  if constexpr (MATRIX_ALIGNMENT % sizeof(T) == 0) {
+    const std::size_t lanes = MATRIX_ALIGNMENT / sizeof(T);
+    return (cols + lanes - 1) / lanes * lanes;
+  } else {
+    return cols;
+  }
+}
+
+template <typename T>
+T* Matrix<T>::allocate(std::size_t count) {
+  arena_ = nullptr;
+  if (count == 0) return nullptr;
+  const std::size_t bytes =
+      (count * sizeof(T) + MATRIX_ALIGNMENT - 1) / MATRIX_ALIGNMENT *
+      MATRIX_ALIGNMENT;
+  MatrixArena* arena = current_arena();
+  T* ptr = static_cast<T*>(
+      arena != nullptr
+          ? arena->allocate(bytes)
+          : ::operator new(bytes, std::align_val_t{MATRIX_ALIGNMENT}));
+  arena_ = arena;
+  std::uninitialized_value_construct_n(ptr, count);
+  return ptr;
+}
+
+template <typename T>
+void Matrix<T>::deallocate(T* ptr, std::size_t count) noexcept {
+  if (ptr == nullptr) return;
+  std::destroy_n(ptr, count);
+  if (arena_ != nullptr) {
+    arena_->deallocate(ptr, count * sizeof(T));
+  } else {
+    ::operator delete(ptr, std::align_val_t{MATRIX_ALIGNMENT});
+  }
+}
+
+template <typename T>
+Matrix<T>::Matrix(std::size_t rows, std::size_t cols)
+    : rows_(rows), cols_(cols), stride_(padded_stride(cols)) {
+  if ((rows == 0) != (cols == 0)) {
+    throw std::logic_error("The matrix dimension must be larger than 0.");
+  }
+  data_ = allocate(rows_ * stride_);
+}
+
+template <typename T>
+Matrix<T>::Matrix(std::size_t rows, std::size_t cols, const T& value)
+    : Matrix(rows, cols) {
+  for (std::size_t i = 0; i < rows_; i++)
+    std::fill_n(row(i), cols_, value);
+}
+
+// The delegating constructors below may throw from their bodies: the target
+// constructor has already finished, so ~Matrix() releases the buffer.
+template <typename T>
+Matrix<T>::Matrix(std::initializer_list<std::initializer_list<T>> init)
+    : Matrix(init.size(), init.size() == 0 ? 0 : init.begin()->size()) {
+  std::size_t i = 0;
+  for (const auto& r : init) {
+    if (r.size() != cols_) {
+      throw std::logic_error("All rows must have the same length.");
+    }
+    std::copy(r.begin(), r.end(), row(i++));
+  }
+}
+
+template <typename T>
+Matrix<T>::Matrix(const MATRIX<T>& matrix)
+    : Matrix(matrix_size(matrix).first, matrix_size(matrix).second) {
+  for (std::size_t i = 0; i < rows_; i++) {
+    if (matrix[i].size() != cols_) {
+      throw std::logic_error("All rows must have the same length.");
+    }
+    std::copy(matrix[i].begin(), matrix[i].end(), row(i));
+  }
+}
+
+template <typename T>
+template <lazy_expression E>
+Matrix<T>::Matrix(const E& expr) : Matrix(expr.rows(), expr.cols()) {
+  assign_from(expr);
+}
+
+template <typename T>
+template <lazy_expression E>
+Matrix<T>& Matrix<T>::operator=(const E& expr) {
+  // an expression that reads our elements out of place (a transpose or a
+  // view of *this) would see values we already overwrote
+  if (expr.aliases(data_, data_ + rows_ * stride_) or rows_ != expr.rows() or
+      cols_ != expr.cols()) {
+    Matrix tmp(expr);
+    swap(tmp);
+  } else {
+    assign_from(expr);
+  }
+  return *this;
+}
+
+template <typename T>
+template <typename E>
+void Matrix<T>::assign_from(const E& expr) {
+  parallel_for(rows_, parallel_row_grain(cols_),
+               [&](std::size_t begin, std::size_t end) {
+                 for (std::size_t i = begin; i < end; i++) {
+                   T* r = row(i);
+                   for (std::size_t j = 0; j < cols_; j++)
+                     r[j] = static_cast<T>(expr(i, j));
+                 }
+               });
+}
+
+template <typename T>
+Matrix<T>::Matrix(const Matrix& other)
+    : rows_(other.rows_), cols_(other.cols_), stride_(other.stride_) {
+  data_ = allocate(rows_ * stride_);
+  std::copy_n(other.data_, rows_ * stride_, data_);
+}
+
+template <typename T>
+Matrix<T>::Matrix(Matrix&& other) noexcept
+    : rows_(std::exchange(other.rows_, 0)),
+      cols_(std::exchange(other.cols_, 0)),
+      stride_(std::exchange(other.stride_, 0)),
+      data_(std::exchange(other.data_, nullptr)),
+      arena_(std::exchange(other.arena_, nullptr)) {}
+
+template <typename T>
+Matrix<T>& Matrix<T>::operator=(const Matrix& other) {
+  if (this != &other) {
+    if (rows_ * stride_ == other.rows_ * other.stride_) {
+      // same footprint: reuse the buffer
+      rows_ = other.rows_;
+      cols_ = other.cols_;
+      stride_ = other.stride_;
+      std::copy_n(other.data_, rows_ * stride_, data_);
+    } else {
+      Matrix tmp(other);
+      swap(tmp);
+    }
+  }
+  return *this;
+}
+
+template <typename T>
+Matrix<T>& Matrix<T>::operator=(Matrix&& other) noexcept {
+  Matrix tmp(std::move(other));
+  swap(tmp);
+  return *this;
+}
+
+template <typename T>
+Matrix<T>::~Matrix() {
+  deallocate(data_, rows_ * stride_);
+}
+
+template <typename T>
+MATRIX<T> Matrix<T>::to_legacy() const {
+  MATRIX<T> res(rows_);
+  for (std::size_t i = 0; i < rows_; i++)
+    res[i].assign(row(i), row(i) + cols_);
+  return res;
+}
+
+template <typename T>
+void Matrix<T>::swap(Matrix& other) noexcept {
+  std::swap(rows_, other.rows_);
+  std::swap(cols_, other.cols_);
+  std::swap(stride_, other.stride_);
+  std::swap(data_, other.data_);
+  std::swap(arena_, other.arena_);
+}
+
+template <typename T>
+bool Matrix<T>::operator==(const Matrix& other) const {
+  if (rows_ != other.rows_ or cols_ != other.cols_) return false;
+  for (std::size_t i = 0; i < rows_; i++)
+    if (!std::equal(row(i), row(i) + cols_, other.row(i))) return false;
+  return true;
+}
+
+template <typename T>
+Matrix<T> to_matrix(const MATRIX<T>& matrix) {
+  return Matrix<T>(matrix);
+}
+
+template <typename T>
+MATRIX<T> to_legacy(const Matrix<T>& matrix) {
+  return matrix.to_legacy();
+}
+
+template <typename M>
+  requires is_matrix_v<M>
+M create_matrix(std::size_t rows, std::size_t columns,
+                std::optional<MatrixType> type,
+                std::optional<typename M::value_type> lowerBound,
+                std::optional<typename M::value_type> upperBound,
+                std::optional<std::uint64_t> seed) {
+  using T = typename M::value_type;
+  if (rows == 0 or columns == 0) {
+    if (rows == columns) return M();
+    throw std::logic_error("The matrix dimension must be larger than 0.");
+  }
+
+  M m(rows, columns);
+  switch (type.value()) {
+    case MatrixType::Zeros:
+      break;  // storage is value-initialized
+    case MatrixType::Ones:
+      for (size_t i = 0; i < rows; i++) std::fill_n(m.row(i), columns, T(1));
+      break;
+    case MatrixType::Identity:
+      if (rows != columns) {
+        throw std::logic_error("An identity matrix must be square.");
+      }
+      for (size_t i = 0; i < rows; i++) m(i, i) = 1;
+      break;
+    case MatrixType::Random:
+      if (!(lowerBound.has_value() && upperBound.has_value())) {
+        throw std::logic_error("The value bound must be set.");
+      }
+      if (!(*lowerBound < *upperBound)) {
+        throw std::logic_error(
+            "The lower bound must be smaller than the upper one.");
+      }
+      if constexpr (std::is_integral<T>::value or
+                    std::is_floating_point<T>::value) {
+        const std::uint64_t s = seed ? *seed : random_seed();
+        parallel_for(rows, parallel_row_grain(columns),
+                     [&](std::size_t begin, std::size_t end) {
+                       for (std::size_t i = begin; i < end; i++)
+                         random_uniform(s, i * columns, columns, *lowerBound,
+                                        *upperBound, m.row(i));
+                     });
+      } else {
+        throw std::logic_error(
+            "The template type must be integer or floating point number.");
+      }
+      break;
+  }
+  return m;
+}
+
+template <typename T>
+void display(const Matrix<T>& matrix) {
+  for (size_t i = 0; i < matrix.rows(); i++) {
+    for (size_t j = 0; j < matrix.cols(); j++) display_element(matrix(i, j));
+    std::cout << "|\n";
+  }
+}
+
+template <typename T>
+std::pair<size_t, size_t> matrix_size(const Matrix<T>& matrix) {
+  return std::make_pair(matrix.rows(), matrix.cols());
+}
+
+template <typename T>
+Matrix<T> sum_sub(const Matrix<T>& matrixA, const Matrix<T>& matrixB,
+                  std::optional<std::string> operation) {
+  if (matrix_size(matrixA) != matrix_size(matrixB)) {
+    throw std::logic_error("Matrix dimensions are not same.");
+  }
+  const bool sub = operation.has_value() and operation.value() == "sub";
+
+  Matrix<T> res(matrixA.rows(), matrixA.cols());
+  parallel_for(res.rows(), parallel_row_grain(res.cols()),
+               [&](size_t begin, size_t end) {
+                 for (size_t i = begin; i < end; i++) {
+                   if (sub)
+                     simd_sub(matrixA.row(i), matrixB.row(i), res.row(i),
+                              res.cols());
+                   else
+                     simd_add(matrixA.row(i), matrixB.row(i), res.row(i),
+                              res.cols());
+                 }
+               });
+  return res;
+}
+
+template <typename T>
+Matrix<T> multiply(const Matrix<T>& matrix, const T scalar) {
+  Matrix<T> res(matrix.rows(), matrix.cols());
+  parallel_for(res.rows(), parallel_row_grain(res.cols()),
+               [&](size_t begin, size_t end) {
+                 for (size_t i = begin; i < end; i++)
+                   simd_scale(matrix.row(i), scalar, res.row(i), res.cols());
+               });
+  return res;
+}
+
+template <typename T>
+Matrix<T> multiply(const Matrix<T>& matrixA, const Matrix<T>& matrixB) {
+  if (matrixA.empty() or matrixB.empty()) {
+    throw std::logic_error("Matrix is empty.");
+  }
+  if (matrixA.cols() != matrixB.rows()) {
+    throw std::logic_error("Matrix dimensions do not match.");
+  }
+
+  Matrix<T> res(matrixA.rows(), matrixB.cols());
+  if (matrixA.rows() * matrixA.cols() * matrixB.cols() >=
+      gemm_blocked_min_ops()) {
+    gemm_blocked<T>(
+        matrixA.rows(), matrixB.cols(), matrixA.cols(),
+        [&](size_t i, size_t k) { return matrixA(i, k); },
+        [&](size_t k, size_t j) { return matrixB(k, j); },
+        [&](size_t i, size_t j) -> T& { return res(i, j); });
+    return res;
+  }
+  for (size_t i = 0; i < matrixA.rows(); i++) {
+    T* r = res.row(i);
+    for (size_t k = 0; k < matrixA.cols(); k++) {
+      const T tmp = matrixA(i, k);
+      const T* b = matrixB.row(k);
+      for (size_t j = 0; j < matrixB.cols(); j++) r[j] += tmp * b[j];
+    }
+  }
+  return res;
+}
+
+template <typename T>
+Matrix<T> hadamard_product(const Matrix<T>& matrixA, const Matrix<T>& matrixB) {
+  if (matrix_size(matrixA) != matrix_size(matrixB))
+    throw std::logic_error("Matrix dimensions do not match.");
+
+  Matrix<T> res(matrixA.rows(), matrixA.cols());
+  parallel_for(res.rows(), parallel_row_grain(res.cols()),
+               [&](size_t begin, size_t end) {
+                 for (size_t i = begin; i < end; i++)
+                   simd_mul(matrixA.row(i), matrixB.row(i), res.row(i),
+                            res.cols());
+               });
+  return res;
+}
+
+template <typename T>
+Matrix<T> transpose(const Matrix<T>& matrix) {
+  Matrix<T> res(matrix.cols(), matrix.rows());
+  transpose_blocked(matrix.rows(), matrix.cols(), matrix.data(),
+                    matrix.stride(), res.data(), res.stride());
+  return res;
+}
+
+template <typename T>
+T trace(const Matrix<T>& matrix) {
+  if (matrix.empty()) throw std::logic_error("Matrix is empty.");
+  if (matrix.rows() != matrix.cols())
+    throw std::logic_error("Matrix must be square.");
+
+  return simd_strided_sum(matrix.data(), matrix.stride() + 1, matrix.rows());
+}
+
+template <typename T>
+void add_inplace(Matrix<T>& matrixA, const Matrix<T>& matrixB) {
+  if (matrix_size(matrixA) != matrix_size(matrixB)) {
+    throw std::logic_error("Matrix dimensions are not same.");
+  }
+  parallel_for(matrixA.rows(), parallel_row_grain(matrixA.cols()),
+               [&](size_t begin, size_t end) {
+                 for (size_t i = begin; i < end; i++)
+                   simd_add(matrixA.row(i), matrixB.row(i), matrixA.row(i),
+                            matrixA.cols());
+               });
+}
+
+template <typename T>
+void sub_inplace(Matrix<T>& matrixA, const Matrix<T>& matrixB) {
+  if (matrix_size(matrixA) != matrix_size(matrixB)) {
+    throw std::logic_error("Matrix dimensions are not same.");
+  }
+  parallel_for(matrixA.rows(), parallel_row_grain(matrixA.cols()),
+               [&](size_t begin, size_t end) {
+                 for (size_t i = begin; i < end; i++)
+                   simd_sub(matrixA.row(i), matrixB.row(i), matrixA.row(i),
+                            matrixA.cols());
+               });
+}
+
+template <typename T>
+void scale_inplace(Matrix<T>& matrix, const T scalar) {
+  parallel_for(matrix.rows(), parallel_row_grain(matrix.cols()),
+               [&](size_t begin, size_t end) {
+                 for (size_t i = begin; i < end; i++)
+                   simd_scale(matrix.row(i), scalar, matrix.row(i),
+                              matrix.cols());
+               });
+}
+
+template <typename T>
+void hadamard_inplace(Matrix<T>& matrixA, const Matrix<T>& matrixB) {
+  if (matrix_size(matrixA) != matrix_size(matrixB))
+    throw std::logic_error("Matrix dimensions do not match.");
+  parallel_for(matrixA.rows(), parallel_row_grain(matrixA.cols()),
+               [&](size_t begin, size_t end) {
+                 for (size_t i = begin; i < end; i++)
+                   simd_mul(matrixA.row(i), matrixB.row(i), matrixA.row(i),
+                            matrixA.cols());
+               });
+}
+
+template <typename T>
+void transpose_inplace(Matrix<T>& matrix) {
+  if (matrix.rows() != matrix.cols())
+    throw std::logic_error("Matrix must be square.");
+  transpose_square_inplace(matrix.rows(), matrix.data(), matrix.stride());
+}
+
+template <typename T>
+Matrix<T> sum_sub(Matrix<T>&& matrixA, const Matrix<T>& matrixB,
+                  std::optional<std::string> operation) {
+  if (operation.has_value() and operation.value() == "sub")
+    sub_inplace(matrixA, matrixB);
+  else
+    add_inplace(matrixA, matrixB);
+  return std::move(matrixA);
+}
+
+template <typename T>
+Matrix<T> sum_sub(const Matrix<T>& matrixA, Matrix<T>&& matrixB,
+                  std::optional<std::string> operation) {
+  if (!(operation.has_value() and operation.value() == "sub")) {
+    add_inplace(matrixB, matrixA);
+    return std::move(matrixB);
+  }
+  if (matrix_size(matrixA) != matrix_size(matrixB)) {
+    throw std::logic_error("Matrix dimensions are not same.");
+  }
+  // B = A - B, written over B
+  parallel_for(matrixB.rows(), parallel_row_grain(matrixB.cols()),
+               [&](size_t begin, size_t end) {
+                 for (size_t i = begin; i < end; i++)
+                   simd_sub(matrixA.row(i), matrixB.row(i), matrixB.row(i),
+                            matrixB.cols());
+               });
+  return std::move(matrixB);
+}
+
+template <typename T>
+Matrix<T> sum_sub(Matrix<T>&& matrixA, Matrix<T>&& matrixB,
+                  std::optional<std::string> operation) {
+  return sum_sub(std::move(matrixA), std::as_const(matrixB), operation);
+}
+
+template <typename T>
+Matrix<T> multiply(Matrix<T>&& matrix, const T scalar) {
+  scale_inplace(matrix, scalar);
+  return std::move(matrix);
+}
+
+template <typename T>
+Matrix<T> hadamard_product(Matrix<T>&& matrixA, const Matrix<T>& matrixB) {
+  hadamard_inplace(matrixA, matrixB);
+  return std::move(matrixA);
+}
+
+template <typename T>
+Matrix<T> hadamard_product(const Matrix<T>& matrixA, Matrix<T>&& matrixB) {
+  hadamard_inplace(matrixB, matrixA);
+  return std::move(matrixB);
+}
+
+template <typename T>
+Matrix<T> hadamard_product(Matrix<T>&& matrixA, Matrix<T>&& matrixB) {
+  return hadamard_product(std::move(matrixA), std::as_const(matrixB));
+}
+
+}  // namespace algebra
+
+#endif  // AUT_AP_2024_Spring_HW1_MATRIX
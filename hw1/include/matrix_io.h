@@ -0,0 +1,296 @@
+#ifndef AUT_AP_2024_Spring_HW1_MATRIX_IO
+#define AUT_AP_2024_Spring_HW1_MATRIX_IO
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "matrix.h"
+#include "view.h"
+
+namespace algebra {
+// Binary matrix files.
+// A file is a 128-byte header followed by the elements, row-major, in the
+// machine's (little-endian) byte order:
+//   magic "AUTMATRX", version, dtype, rows, cols, row and column stride (in
+//   elements), alignment, offset and size of the element data, checksum.
+// The data starts at a multiple of the alignment, so a memory-mapped file
+// can be read in place. Rows are `row_stride` elements apart; padded rows
+// (see MatrixFileOptions) start on an alignment boundary as well.
+
+// Element type of a matrix file
+enum class DType : std::uint32_t {
+  Int8 = 1,
+  UInt8,
+  Int16,
+  UInt16,
+  Int32,
+  UInt32,
+  Int64,
+  UInt64,
+  Float32,
+  Float64
+};
+
+// File dtype of an element type (integers by size and signedness)
+template <typename T>
+constexpr DType dtype_of();
+
+std::size_t dtype_size(DType dtype);
+const char* dtype_name(DType dtype);
+
+enum class ChecksumKind : std::uint32_t { None = 0, Fletcher64 = 1 };
+
+struct MatrixFileHeader {
+  char magic[8];
+  std::uint32_t version;
+  DType dtype;
+  std::uint64_t rows;
+  std::uint64_t cols;
+  std::uint64_t row_stride;
+  std::uint64_t col_stride;
+  std::uint64_t alignment;
+  std::uint64_t data_offset;
+  std::uint64_t data_bytes;
+  ChecksumKind checksum_kind;
+  std::uint32_t reserved;
+  std::uint64_t checksum;
+  unsigned char padding[40];
+};
+static_assert(sizeof(MatrixFileHeader) == 128);
+
+// Settings of a written file.
+// alignment: power of two the data offset is a multiple of;
+// pad_rows:  pad every row so that each one starts on an alignment boundary;
+// checksum:  store a Fletcher-64 checksum of the data.
+struct MatrixFileOptions {
+  std::size_t alignment = MATRIX_ALIGNMENT;
+  bool pad_rows = false;
+  bool checksum = true;
+};
+
+// Running Fletcher-64 over 32-bit little-endian words; a trailing partial
+// word is padded with zeros
+class Fletcher64 {
+ public:
+  void update(const void* data, std::size_t bytes);
+  std::uint64_t value() const;
+
+ private:
+  std::uint64_t sum1_ = 0;
+  std::uint64_t sum2_ = 0;
+  unsigned char tail_[4] = {};
+  std::size_t tail_size_ = 0;
+};
+
+// Writes a matrix file row by row, so a matrix never has to be in memory
+// at once. finish() completes the header; a file whose writer is destroyed
+// before that is rejected by the readers.
+class MatrixFileWriter {
+ public:
+  MatrixFileWriter(const std::string& path, DType dtype, std::size_t rows,
+                   std::size_t cols, MatrixFileOptions options = {});
+  ~MatrixFileWriter();
+
+  MatrixFileWriter(const MatrixFileWriter&) = delete;
+  MatrixFileWriter& operator=(const MatrixFileWriter&) = delete;
+
+  // Append the next row (cols elements of the file dtype)
+  void write_row(const void* row);
+  void finish();
+
+  std::size_t rows_written() const { return rows_written_; }
+  const MatrixFileHeader& header() const { return header_; }
+
+ private:
+  std::ofstream file_;
+  MatrixFileHeader header_{};
+  Fletcher64 checksum_;
+  std::size_t rows_written_ = 0;
+  bool finished_ = false;
+};
+
+// Typed front end of MatrixFileWriter
+template <typename T>
+class MatrixWriter {
+ public:
+  MatrixWriter(const std::string& path, std::size_t rows, std::size_t cols,
+               MatrixFileOptions options = {})
+      : writer_(path, dtype_of<T>(), rows, cols, options) {}
+
+  void write_row(const T* row) { writer_.write_row(row); }
+  // Append every row of `rows`
+  void write_rows(MatrixView<T> rows);
+  void finish() { writer_.finish(); }
+
+  std::size_t rows_written() const { return writer_.rows_written(); }
+
+ private:
+  MatrixFileWriter writer_;
+};
+
+// Read-only memory mapping of a whole matrix file; the header is checked
+// when the file is opened, the checksum only if asked for
+class MappedMatrixFile {
+ public:
+  explicit MappedMatrixFile(const std::string& path,
+                            bool verify_checksum = false);
+  ~MappedMatrixFile();
+
+  MappedMatrixFile(MappedMatrixFile&& other) noexcept;
+  MappedMatrixFile& operator=(MappedMatrixFile&& other) noexcept;
+
+  const MatrixFileHeader& header() const { return header_; }
+  const void* data() const;
+
+  // Drop the pages of a range that is not needed for now; they are read
+  // from the file again when touched. Keeps the resident set of a streamed
+  // file small.
+  void release(const void* begin, std::size_t bytes) const;
+
+ private:
+  void* map_ = nullptr;
+  std::size_t map_size_ = 0;
+  MatrixFileHeader header_{};
+};
+
+// Matrix file mapped into memory; view() reads the elements in place,
+// without copying them. The view is valid while the MappedMatrix lives.
+template <typename T>
+class MappedMatrix {
+ public:
+  explicit MappedMatrix(const std::string& path, bool verify_checksum = false);
+
+  std::size_t rows() const { return file_.header().rows; }
+  std::size_t cols() const { return file_.header().cols; }
+  const MatrixFileHeader& header() const { return file_.header(); }
+  MatrixView<T> view() const;
+  // See MappedMatrixFile::release(); rows [begin, end)
+  void release_rows(std::size_t begin, std::size_t end) const;
+
+ private:
+  MappedMatrixFile file_;
+};
+
+// Header of a matrix file, checked like MappedMatrixFile does
+MatrixFileHeader read_matrix_header(const std::string& path);
+
+// Whole-matrix helpers
+template <dense_matrix M>
+void save_matrix(const std::string& path, const M& matrix,
+                 MatrixFileOptions options = {});
+
+template <typename T>
+void save_matrix(const std::string& path, const MATRIX<T>& matrix,
+                 MatrixFileOptions options = {});
+
+// Copy of a stored matrix; the file dtype must match T
+template <typename T>
+Matrix<T> load_matrix(const std::string& path, bool verify_checksum = true);
+
+////////////////////////////
+////// Implementation //////
+////////////////////////////
+
+template <typename T>
+constexpr DType dtype_of() {
+  static_assert(std::is_arithmetic_v<T> and !std::is_same_v<T, bool>,
+                "Matrix files hold integers or floating point numbers.");
+  if constexpr (std::is_floating_point_v<T>) {
+    static_assert(sizeof(T) == 4 or sizeof(T) == 8,
+                  "Only float and double are supported.");
+    return sizeof(T) == 4 ? DType::Float32 : DType::Float64;
+  } else {
+    constexpr bool is_signed = std::is_signed_v<T>;
+    switch (sizeof(T)) {
+      case 1:
+        return is_signed ? DType::Int8 : DType::UInt8;
+      case 2:
+        return is_signed ? DType::Int16 : DType::UInt16;
+      case 4:
+        return is_signed ? DType::Int32 : DType::UInt32;
+      default:
+        return is_signed ? DType::Int64 : DType::UInt64;
+    }
+  }
+}
+
+template <typename T>
+void MatrixWriter<T>::write_rows(MatrixView<T> rows) {
+  if (rows.cols() != writer_.header().cols) {
+    throw std::logic_error("Matrix dimensions do not match.");
+  }
+  if (rows.contiguous_rows()) {
+    for (std::size_t i = 0; i < rows.rows(); i++) write_row(rows.row(i));
+    return;
+  }
+  std::vector<T> buffer(rows.cols());
+  for (std::size_t i = 0; i < rows.rows(); i++) {
+    for (std::size_t j = 0; j < rows.cols(); j++) buffer[j] = rows(i, j);
+    write_row(buffer.data());
+  }
+}
+
+template <typename T>
+MappedMatrix<T>::MappedMatrix(const std::string& path, bool verify_checksum)
+    : file_(path, verify_checksum) {
+  if (file_.header().dtype != dtype_of<T>()) {
+    throw std::logic_error(std::string("The matrix file holds ") +
+                           dtype_name(file_.header().dtype) + " elements.");
+  }
+}
+
+template <typename T>
+MatrixView<T> MappedMatrix<T>::view() const {
+  const MatrixFileHeader& h = file_.header();
+  return MatrixView<T>(static_cast<const T*>(file_.data()), h.rows, h.cols,
+                       h.row_stride, h.col_stride);
+}
+
+template <typename T>
+void MappedMatrix<T>::release_rows(std::size_t begin, std::size_t end) const {
+  if (begin >= end) return;
+  const MatrixView<T> v = view();
+  file_.release(v.row(begin), ((end - begin - 1) * v.row_stride() +
+                               (v.cols() - 1) * v.col_stride() + 1) *
+                                  sizeof(T));
+}
+
+template <dense_matrix M>
+void save_matrix(const std::string& path, const M& matrix,
+                 MatrixFileOptions options) {
+  using T = typename M::value_type;
+  const MatrixView<T> v = view(matrix);
+  MatrixWriter<T> writer(path, v.rows(), v.cols(), options);
+  writer.write_rows(v);
+  writer.finish();
+}
+
+template <typename T>
+void save_matrix(const std::string& path, const MATRIX<T>& matrix,
+                 MatrixFileOptions options) {
+  const std::size_t cols = matrix.empty() ? 0 : matrix[0].size();
+  MatrixWriter<T> writer(path, matrix.size(), cols, options);
+  for (const auto& row : matrix) {
+    if (row.size() != cols) {
+      throw std::logic_error("Matrix dimensions are not same.");
+    }
+    writer.write_row(row.data());
+  }
+  writer.finish();
+}
+
+template <typename T>
+Matrix<T> load_matrix(const std::string& path, bool verify_checksum) {
+  const MappedMatrix<T> file(path, verify_checksum);
+  if (file.rows() == 0 or file.cols() == 0) return Matrix<T>();
+  return to_matrix(file.view());
+}
+
+}  // namespace algebra
+
+#endif  // AUT_AP_2024_Spring_HW1_MATRIX_IO
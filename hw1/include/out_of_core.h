@@ -0,0 +1,158 @@
+#ifndef AUT_AP_2024_Spring_HW1_OUT_OF_CORE
+#define AUT_AP_2024_Spring_HW1_OUT_OF_CORE
+
+#include <algorithm>
+#include <cstddef>
+#include <future>
+#include <stdexcept>
+#include <string>
+
+#include "gemm.h"
+#include "matrix_io.h"
+
+namespace algebra {
+// Settings of the out-of-core multiply.
+// memory_bytes: budget for the buffers it allocates (the output panel and
+//               two sets of input tiles);
+// inner_tile:   largest slice of the inner dimension loaded per step;
+// output:       layout of the written result file.
+struct OutOfCoreOptions {
+  std::size_t memory_bytes = std::size_t(1) << 30;
+  std::size_t inner_tile = 256;
+  MatrixFileOptions output = {};
+};
+
+// Tiling of an out-of-core product: C is produced panel_rows rows at a time;
+// each step loads a panel_rows x inner_tile tile of A and the matching
+// inner_tile x n block of B. bytes is the memory all buffers take.
+struct OutOfCorePlan {
+  std::size_t panel_rows;
+  std::size_t inner_tile;
+  std::size_t bytes;
+};
+
+template <typename T>
+OutOfCorePlan plan_out_of_core(std::size_t m, std::size_t k, std::size_t n,
+                               const OutOfCoreOptions& options = {});
+
+// C = A * B for matrix files (see matrix_io.h) that need not fit in memory.
+// A and B are mapped and copied tile by tile into in-memory buffers while
+// the previous tiles are multiplied (double buffering); C is streamed to
+// its file one row panel at a time. A row of C has to fit in the budget.
+template <typename T>
+void multiply_out_of_core(const std::string& pathA, const std::string& pathB,
+                          const std::string& pathC,
+                          const OutOfCoreOptions& options = {});
+
+template <typename T>
+void multiply_out_of_core(const MappedMatrix<T>& matrixA,
+                          const MappedMatrix<T>& matrixB,
+                          const std::string& pathC,
+                          const OutOfCoreOptions& options = {});
+
+////////////////////////////
+////// Implementation //////
+////////////////////////////
+
+template <typename T>
+OutOfCorePlan plan_out_of_core(std::size_t m, std::size_t k, std::size_t n,
+                               const OutOfCoreOptions& options) {
+  // elements of the C panel plus two A tiles and two B blocks, with rows
+  // padded like Matrix<T> pads them
+  const std::size_t lanes =
+      std::max<std::size_t>(MATRIX_ALIGNMENT / sizeof(T), 1);
+  auto padded = [&](std::size_t cols) {
+    return (cols + lanes - 1) / lanes * lanes;
+  };
+  auto elements = [&](std::size_t rows, std::size_t tile) {
+    return rows * padded(n) + 2 * (rows * padded(tile) + tile * padded(n));
+  };
+  const std::size_t budget = options.memory_bytes / sizeof(T);
+  std::size_t tile = std::clamp<std::size_t>(options.inner_tile, 1, k);
+  while (tile > 1 and elements(1, tile) > budget) tile /= 2;
+  if (elements(1, tile) > budget) {
+    throw std::logic_error("The memory budget is too small.");
+  }
+  const std::size_t rows = std::min(
+      m, (budget - 2 * tile * padded(n)) / (padded(n) + 2 * padded(tile)));
+  return {rows, tile, elements(rows, tile) * sizeof(T)};
+}
+
+template <typename T>
+void multiply_out_of_core(const MappedMatrix<T>& matrixA,
+                          const MappedMatrix<T>& matrixB,
+                          const std::string& pathC,
+                          const OutOfCoreOptions& options) {
+  const MatrixView<T> a = matrixA.view(), b = matrixB.view();
+  if (a.empty() or b.empty()) throw std::logic_error("Matrix is empty.");
+  if (a.cols() != b.rows()) {
+    throw std::logic_error("Matrix dimensions do not match.");
+  }
+  const std::size_t m = a.rows(), k = a.cols(), n = b.cols();
+  const OutOfCorePlan plan = plan_out_of_core<T>(m, k, n, options);
+  const std::size_t panels = (m + plan.panel_rows - 1) / plan.panel_rows;
+  const std::size_t slices = (k + plan.inner_tile - 1) / plan.inner_tile;
+
+  // Step s loads slice s % slices of row panel s / slices
+  struct Tiles {
+    Matrix<T> a, b;
+  };
+  Tiles tiles[2];
+  // free the old buffer first, so that two never exist at once
+  auto reshape = [](Matrix<T>& buffer, std::size_t rows, std::size_t cols) {
+    if (buffer.rows() == rows and buffer.cols() == cols) return;
+    buffer = Matrix<T>();
+    buffer = Matrix<T>(rows, cols);
+  };
+  auto load = [&](std::size_t step, Tiles& dst) {
+    const std::size_t i0 = step / slices * plan.panel_rows;
+    const std::size_t p0 = step % slices * plan.inner_tile;
+    const std::size_t rows = std::min(plan.panel_rows, m - i0);
+    const std::size_t depth = std::min(plan.inner_tile, k - p0);
+    reshape(dst.a, rows, depth);
+    reshape(dst.b, depth, n);
+    copy(a.block(i0, p0, rows, depth), span(dst.a));
+    copy(b.row_range(p0, p0 + depth), span(dst.b));
+    // B is read again for the next panel; A only once
+    if (p0 + depth == k) matrixA.release_rows(i0, i0 + rows);
+    if (step + 1 < panels * slices) matrixB.release_rows(p0, p0 + depth);
+  };
+
+  MatrixWriter<T> writer(pathC, m, n, options.output);
+  Matrix<T> panel;
+  load(0, tiles[0]);
+  for (std::size_t step = 0; step < panels * slices; step++) {
+    std::future<void> next;
+    if (step + 1 < panels * slices)
+      next = std::async(std::launch::async, load, step + 1,
+                        std::ref(tiles[(step + 1) % 2]));
+
+    const Tiles& cur = tiles[step % 2];
+    if (step % slices == 0) {
+      reshape(panel, cur.a.rows(), n);
+      for (std::size_t i = 0; i < panel.rows(); i++)
+        std::fill_n(panel.row(i), n, T(0));
+    }
+    gemm_blocked<T>(
+        cur.a.rows(), n, cur.a.cols(),
+        [&](std::size_t i, std::size_t p) { return cur.a(i, p); },
+        [&](std::size_t p, std::size_t j) { return cur.b(p, j); },
+        [&](std::size_t i, std::size_t j) -> T& { return panel(i, j); });
+    if (step % slices == slices - 1) writer.write_rows(view(panel));
+
+    if (next.valid()) next.get();
+  }
+  writer.finish();
+}
+
+template <typename T>
+void multiply_out_of_core(const std::string& pathA, const std::string& pathB,
+                          const std::string& pathC,
+                          const OutOfCoreOptions& options) {
+  const MappedMatrix<T> matrixA(pathA), matrixB(pathB);
+  multiply_out_of_core(matrixA, matrixB, pathC, options);
+}
+
+}  // namespace algebra
+
+#endif  // AUT_AP_2024_Spring_HW1_OUT_OF_CORE
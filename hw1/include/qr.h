@@ -0,0 +1,319 @@
+#ifndef AUT_AP_2024_Spring_HW1_QR
+#define AUT_AP_2024_Spring_HW1_QR
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "gemm.h"
+#include "view.h"
+
+namespace algebra {
+// Columns per block reflector of the blocked QR
+inline constexpr std::size_t QR_BLOCK = 32;
+
+// Householder QR factorization A = Q * R of an m x n matrix.
+// As in LAPACK's geqrf, R is stored on and above the diagonal and the
+// Householder vectors (unit first element, implicit) below it; Q is the
+// product H(0) * H(1) ... of H(j) = I - tau[j] * v_j * v_j^T. Each group of
+// QR_BLOCK reflectors is applied at once in the compact WY form
+// I - V * T * V^T, so the updates are matrix products.
+template <std::floating_point T>
+class QR {
+ public:
+  explicit QR(Matrix<T> matrix);
+
+  std::size_t rows() const { return factors_.rows(); }
+  std::size_t cols() const { return factors_.cols(); }
+  const Matrix<T>& factors() const { return factors_; }
+  const std::vector<T>& tau() const { return tau_; }
+
+  // min(m, n) x n upper triangular factor
+  Matrix<T> r() const;
+  // m x min(m, n) factor with orthonormal columns
+  Matrix<T> q() const;
+  // Q^T * B and Q * B, for B with m rows
+  Matrix<T> apply_qt(Matrix<T> b) const;
+  Matrix<T> apply_q(Matrix<T> b) const;
+  // Least-squares X minimizing ||A * X - B|| (m >= n, full column rank)
+  Matrix<T> solve(const Matrix<T>& b) const;
+
+ private:
+  Matrix<T> factors_;
+  std::vector<T> tau_;
+};
+
+template <std::floating_point T>
+QR<T> qr(const Matrix<T>& matrix);
+
+template <std::floating_point T>
+QR<T> qr(const MATRIX<T>& matrix);
+
+// X minimizing ||A * X - B|| through a QR factorization of A
+template <std::floating_point T>
+Matrix<T> least_squares(const Matrix<T>& matrixA, const Matrix<T>& matrixB);
+
+template <std::floating_point T>
+MATRIX<T> least_squares(const MATRIX<T>& matrixA, const MATRIX<T>& matrixB);
+
+// In-place blocked factorization of a span with contiguous rows: `a` is
+// overwritten with R and the Householder vectors, tau receives min(m, n)
+// scalar factors
+template <std::floating_point T>
+void qr_inplace(MatrixSpan<T> a, std::vector<T>& tau,
+                std::size_t block = QR_BLOCK);
+
+// Building blocks.
+// Unblocked QR of columns [col, col + width), rows [col, m)
+template <std::floating_point T>
+void qr_panel(MatrixSpan<T> a, std::size_t col, std::size_t width, T* tau);
+
+// Triangular factor T of the block reflector whose vectors are the
+// columns of v (rows x width, unit lower trapezoidal)
+template <std::floating_point T>
+Matrix<T> qr_block_factor(MatrixView<T> v, const T* tau);
+
+// c = (I - V * T * V^T) * c, or its transpose applied if `transpose`
+template <std::floating_point T>
+void qr_apply_block(MatrixView<T> v, const Matrix<T>& t, MatrixSpan<T> c,
+                    bool transpose);
+
+////////////////////////////
+////// Implementation //////
+////////////////////////////
+
+template <std::floating_point T>
+void qr_panel(MatrixSpan<T> a, std::size_t col, std::size_t width, T* tau) {
+  const std::size_t m = a.rows();
+  std::vector<T> w(width);
+  for (std::size_t j = col; j < col + width; j++) {
+    // reflector that maps a(j:m, j) onto beta * e_1
+    T tail = 0;
+    for (std::size_t i = j + 1; i < m; i++) tail += a(i, j) * a(i, j);
+    const T alpha = a(j, j);
+    if (tail == T(0)) {
+      tau[j - col] = 0;
+      continue;
+    }
+    const T beta = -std::copysign(std::sqrt(alpha * alpha + tail), alpha);
+    tau[j - col] = (beta - alpha) / beta;
+    const T scale = T(1) / (alpha - beta);
+    for (std::size_t i = j + 1; i < m; i++) a(i, j) *= scale;
+    a(j, j) = beta;
+
+    // apply H(j) to the rest of the panel: w = v^T * A, A -= tau * v * w^T
+    const std::size_t c0 = j + 1, c1 = col + width;
+    if (c0 == c1) continue;
+    std::copy(a.row(j) + c0, a.row(j) + c1, w.begin());
+    for (std::size_t i = j + 1; i < m; i++) {
+      const T vi = a(i, j);
+      const T* row = a.row(i);
+      for (std::size_t c = c0; c < c1; c++) w[c - c0] += vi * row[c];
+    }
+    const T t = tau[j - col];
+    for (std::size_t c = c0; c < c1; c++) a(j, c) -= t * w[c - c0];
+    for (std::size_t i = j + 1; i < m; i++) {
+      const T vi = t * a(i, j);
+      T* row = a.row(i);
+      for (std::size_t c = c0; c < c1; c++) row[c] -= vi * w[c - c0];
+    }
+  }
+}
+
+template <std::floating_point T>
+Matrix<T> qr_block_factor(MatrixView<T> v, const T* tau) {
+  const std::size_t rows = v.rows(), k = v.cols();
+  auto vij = [&](std::size_t i, std::size_t j) {
+    return i > j ? v(i, j) : (i == j ? T(1) : T(0));
+  };
+  // Gram matrix G = V^T * V (strict upper part), one pass over the rows
+  Matrix<T> g(k, k);
+  for (std::size_t i = 0; i < rows; i++)
+    for (std::size_t p = 0; p < std::min(i + 1, k); p++) {
+      const T vip = vij(i, p);
+      for (std::size_t q = p + 1; q < k; q++) g(p, q) += vip * vij(i, q);
+    }
+  // T(j, j) = tau_j, T(0:j, j) = -tau_j * T(0:j, 0:j) * G(0:j, j)
+  Matrix<T> t(k, k);
+  for (std::size_t j = 0; j < k; j++) {
+    t(j, j) = tau[j];
+    for (std::size_t p = 0; p < j; p++) {
+      T s = 0;
+      for (std::size_t q = p; q < j; q++) s += t(p, q) * g(q, j);
+      t(p, j) = -tau[j] * s;
+    }
+  }
+  return t;
+}
+
+template <std::floating_point T>
+void qr_apply_block(MatrixView<T> v, const Matrix<T>& t, MatrixSpan<T> c,
+                    bool transpose) {
+  const std::size_t rows = v.rows(), k = v.cols(), n = c.cols();
+  if (n == 0) return;
+  auto vij = [&](std::size_t i, std::size_t j) {
+    return i > j ? v(i, j) : (i == j ? T(1) : T(0));
+  };
+  // W = V^T * C, then W = T * W (or T^T * W), then C -= V * W
+  Matrix<T> w(k, n);
+  gemm_blocked<T>(
+      k, n, rows, [&](std::size_t p, std::size_t i) { return vij(i, p); },
+      [&](std::size_t i, std::size_t j) { return c(i, j); },
+      [&](std::size_t p, std::size_t j) -> T& { return w(p, j); });
+  Matrix<T> tw(k, n);
+  parallel_for(n, std::max<std::size_t>(parallel_min_elements() / (k * k), 1),
+               [&](std::size_t begin, std::size_t end) {
+                 for (std::size_t p = 0; p < k; p++) {
+                   T* dst = tw.row(p);
+                   // T is upper triangular
+                   const std::size_t q0 = transpose ? 0 : p;
+                   const std::size_t q1 = transpose ? p + 1 : k;
+                   for (std::size_t q = q0; q < q1; q++) {
+                     const T tpq = transpose ? t(q, p) : t(p, q);
+                     const T* src = w.row(q);
+                     for (std::size_t j = begin; j < end; j++)
+                       dst[j] += tpq * src[j];
+                   }
+                 }
+               });
+  gemm_blocked<T>(
+      rows, n, k, [&](std::size_t i, std::size_t p) { return -vij(i, p); },
+      [&](std::size_t p, std::size_t j) { return tw(p, j); },
+      [&](std::size_t i, std::size_t j) -> T& { return c(i, j); });
+}
+
+template <std::floating_point T>
+void qr_inplace(MatrixSpan<T> a, std::vector<T>& tau, std::size_t block) {
+  if (a.empty()) throw std::logic_error("Matrix is empty.");
+  if (!a.contiguous_rows()) {
+    throw std::logic_error("The rows of the matrix must be contiguous.");
+  }
+  const std::size_t m = a.rows(), n = a.cols(), steps = std::min(m, n);
+  block = std::max<std::size_t>(block, 1);
+  tau.assign(steps, T(0));
+  for (std::size_t k = 0; k < steps; k += block) {
+    const std::size_t kb = std::min(block, steps - k);
+    qr_panel(a, k, kb, tau.data() + k);
+    if (k + kb == n) break;
+    // trailing columns get Q_k^T = (I - V T V^T)^T
+    const auto v = a.block(k, k, m - k, kb);
+    qr_apply_block<T>(v, qr_block_factor<T>(v, tau.data() + k),
+                      a.block(k, k + kb, m - k, n - k - kb), true);
+  }
+}
+
+template <std::floating_point T>
+QR<T>::QR(Matrix<T> matrix) : factors_(std::move(matrix)) {
+  qr_inplace(span(factors_), tau_);
+}
+
+template <std::floating_point T>
+Matrix<T> QR<T>::r() const {
+  const std::size_t k = std::min(rows(), cols());
+  Matrix<T> res(k, cols());
+  for (std::size_t i = 0; i < k; i++)
+    std::copy(factors_.row(i) + i, factors_.row(i) + cols(), res.row(i) + i);
+  return res;
+}
+
+template <std::floating_point T>
+Matrix<T> QR<T>::apply_qt(Matrix<T> b) const {
+  if (b.rows() != rows()) {
+    throw std::logic_error("Matrix dimensions do not match.");
+  }
+  const std::size_t m = rows(), steps = tau_.size();
+  for (std::size_t k = 0; k < steps; k += QR_BLOCK) {
+    const std::size_t kb = std::min(QR_BLOCK, steps - k);
+    const auto v = view(factors_).block(k, k, m - k, kb);
+    qr_apply_block<T>(v, qr_block_factor<T>(v, tau_.data() + k),
+                      span(b).row_range(k, m), true);
+  }
+  return b;
+}
+
+template <std::floating_point T>
+Matrix<T> QR<T>::apply_q(Matrix<T> b) const {
+  if (b.rows() != rows()) {
+    throw std::logic_error("Matrix dimensions do not match.");
+  }
+  const std::size_t m = rows(), steps = tau_.size();
+  // Q = Q_0 * Q_1 * ..., so the last block acts first
+  for (std::size_t k = (steps - 1) / QR_BLOCK * QR_BLOCK;; k -= QR_BLOCK) {
+    const std::size_t kb = std::min(QR_BLOCK, steps - k);
+    const auto v = view(factors_).block(k, k, m - k, kb);
+    qr_apply_block<T>(v, qr_block_factor<T>(v, tau_.data() + k),
+                      span(b).row_range(k, m), false);
+    if (k == 0) break;
+  }
+  return b;
+}
+
+template <std::floating_point T>
+Matrix<T> QR<T>::q() const {
+  const std::size_t k = std::min(rows(), cols());
+  Matrix<T> identity(rows(), k);
+  for (std::size_t i = 0; i < k; i++) identity(i, i) = 1;
+  return apply_q(std::move(identity));
+}
+
+template <std::floating_point T>
+Matrix<T> QR<T>::solve(const Matrix<T>& b) const {
+  const std::size_t n = cols();
+  if (rows() < n) {
+    throw std::logic_error("The system must not be underdetermined.");
+  }
+  const Matrix<T> c = apply_qt(b);
+  for (std::size_t j = 0; j < n; j++)
+    if (factors_(j, j) == T(0))
+      throw std::logic_error("Matrix is rank deficient.");
+  // R * X = (Q^T * B)[0:n], back substitution on whole rows
+  Matrix<T> x(n, b.cols());
+  for (std::size_t i = 0; i < n; i++)
+    std::copy(c.row(i), c.row(i) + b.cols(), x.row(i));
+  const std::size_t m = b.cols();
+  parallel_for(m, std::max<std::size_t>(parallel_min_elements() / n, 1),
+               [&](std::size_t begin, std::size_t end) {
+                 for (std::size_t i = n; i-- > 0;) {
+                   T* dst = x.row(i);
+                   for (std::size_t p = i + 1; p < n; p++) {
+                     const T rip = factors_(i, p);
+                     const T* src = x.row(p);
+                     for (std::size_t j = begin; j < end; j++)
+                       dst[j] -= rip * src[j];
+                   }
+                   const T inv = T(1) / factors_(i, i);
+                   for (std::size_t j = begin; j < end; j++) dst[j] *= inv;
+                 }
+               });
+  return x;
+}
+
+template <std::floating_point T>
+QR<T> qr(const Matrix<T>& matrix) {
+  return QR<T>(matrix);
+}
+
+template <std::floating_point T>
+QR<T> qr(const MATRIX<T>& matrix) {
+  if (matrix.empty()) throw std::logic_error("Matrix is empty.");
+  return QR<T>(to_matrix(matrix));
+}
+
+template <std::floating_point T>
+Matrix<T> least_squares(const Matrix<T>& matrixA, const Matrix<T>& matrixB) {
+  return qr(matrixA).solve(matrixB);
+}
+
+template <std::floating_point T>
+MATRIX<T> least_squares(const MATRIX<T>& matrixA, const MATRIX<T>& matrixB) {
+  if (matrixB.empty()) throw std::logic_error("Matrix is empty.");
+  return qr(matrixA).solve(to_matrix(matrixB)).to_legacy();
+}
+
+}  // namespace algebra
+
+#endif  // AUT_AP_2024_Spring_HW1_QR
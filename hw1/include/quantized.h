@@ -0,0 +1,270 @@
+#ifndef AUT_AP_2024_Spring_HW1_QUANTIZED
+#define AUT_AP_2024_Spring_HW1_QUANTIZED
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "matrix.h"
+
+namespace algebra {
+// bfloat16: the upper half of an IEEE-754 float (8-bit exponent, 7-bit
+// mantissa), so it keeps the float range at a quarter of the precision.
+// Conversion from float rounds to nearest even; NaN stays NaN.
+struct BFloat16 {
+  std::uint16_t bits = 0;
+
+  BFloat16() = default;
+  explicit BFloat16(float value);
+  explicit operator float() const;
+
+  bool operator==(const BFloat16&) const = default;
+};
+
+// Granularity of the scale of a QuantizedMatrix
+enum class QuantScale { PerTensor, PerRow };
+
+// Element types the low-precision matrices are converted from
+template <typename T>
+concept quantizable = std::is_floating_point_v<T>;
+
+// int8 matrix with symmetric quantization: element (i, j) stands for
+// scale(i) * q(i, j) with q in [-127, 127]. The scale maps the largest
+// magnitude of the tensor (PerTensor) or of each row (PerRow) to 127.
+// Rows are stored contiguously, a quarter of the bytes of a float matrix.
+class QuantizedMatrix {
+ public:
+  QuantizedMatrix() = default;
+  template <quantizable T>
+  explicit QuantizedMatrix(const MATRIX<T>& matrix,
+                           QuantScale scale = QuantScale::PerRow);
+  template <quantizable T>
+  explicit QuantizedMatrix(const Matrix<T>& matrix,
+                           QuantScale scale = QuantScale::PerRow);
+
+  std::size_t rows() const { return rows_; }
+  std::size_t cols() const { return cols_; }
+  bool empty() const { return rows_ == 0 or cols_ == 0; }
+  QuantScale scale_mode() const { return mode_; }
+  float scale(std::size_t i) const {
+    return scales_[mode_ == QuantScale::PerRow ? i : 0];
+  }
+
+  const std::int8_t* data() const { return data_.data(); }
+  const std::int8_t* row(std::size_t i) const { return data() + i * cols_; }
+  std::int8_t operator()(std::size_t i, std::size_t j) const {
+    return data_[i * cols_ + j];
+  }
+  // Dequantized element
+  float value(std::size_t i, std::size_t j) const {
+    return scale(i) * float((*this)(i, j));
+  }
+
+  template <quantizable T = float>
+  MATRIX<T> to_legacy() const;
+  Matrix<float> to_matrix() const;
+
+  // Same layout with the rows and columns swapped; only a per-tensor scale
+  // survives that
+  QuantizedMatrix transposed() const;
+
+ private:
+  std::size_t rows_ = 0;
+  std::size_t cols_ = 0;
+  QuantScale mode_ = QuantScale::PerTensor;
+  std::vector<std::int8_t> data_;
+  std::vector<float> scales_;
+
+  template <typename Row>
+  void quantize(std::size_t rows, std::size_t cols, QuantScale scale,
+                Row row);
+};
+
+// bfloat16 matrix, rows stored contiguously
+class BFloat16Matrix {
+ public:
+  BFloat16Matrix() = default;
+  BFloat16Matrix(std::size_t rows, std::size_t cols);
+  template <quantizable T>
+  explicit BFloat16Matrix(const MATRIX<T>& matrix);
+  template <quantizable T>
+  explicit BFloat16Matrix(const Matrix<T>& matrix);
+
+  std::size_t rows() const { return rows_; }
+  std::size_t cols() const { return cols_; }
+  bool empty() const { return rows_ == 0 or cols_ == 0; }
+
+  BFloat16* data() { return data_.data(); }
+  const BFloat16* data() const { return data_.data(); }
+  BFloat16* row(std::size_t i) { return data() + i * cols_; }
+  const BFloat16* row(std::size_t i) const { return data() + i * cols_; }
+  BFloat16& operator()(std::size_t i, std::size_t j) {
+    return data_[i * cols_ + j];
+  }
+  BFloat16 operator()(std::size_t i, std::size_t j) const {
+    return data_[i * cols_ + j];
+  }
+
+  template <quantizable T = float>
+  MATRIX<T> to_legacy() const;
+  Matrix<float> to_matrix() const;
+
+  BFloat16Matrix transposed() const;
+
+ private:
+  std::size_t rows_ = 0;
+  std::size_t cols_ = 0;
+  std::vector<BFloat16> data_;
+};
+
+// C = A * B in float. The int8 products accumulate exactly in int32 and
+// scale each element once, so the result does not depend on the kernel or
+// the thread count as long as no dot product leaves the int32 range
+// (k < 2^31 / 127^2, about 133000). B must have a per-tensor scale, since
+// a scale per row of B would vary along the dot products; quantize B^T per
+// row and use multiply_transposed() for a scale per output column.
+// The bf16 products accumulate in float; the AVX512-BF16 kernel sums pairs
+// of products in a different order than the others.
+// Both kernels read A and B along k, so multiply() transposes B first.
+Matrix<float> multiply(const QuantizedMatrix& a, const QuantizedMatrix& b);
+Matrix<float> multiply(const BFloat16Matrix& a, const BFloat16Matrix& b);
+
+// C = A * Bt^T for a right operand stored transposed (n x k), e.g. weights
+// kept as one row per output
+Matrix<float> multiply_transposed(const QuantizedMatrix& a,
+                                  const QuantizedMatrix& bt);
+Matrix<float> multiply_transposed(const BFloat16Matrix& a,
+                                  const BFloat16Matrix& bt);
+
+// Kernel the products currently dispatch to: "avx512-vnni", "avx-vnni" or
+// "portable" for int8, "avx512-bf16", "avx512" or "portable" for bf16.
+// Follows simd_level(), so set_simd_level() also selects these.
+const char* int8_kernel_name();
+const char* bf16_kernel_name();
+
+////////////////////////////
+////// Implementation //////
+////////////////////////////
+
+inline BFloat16::BFloat16(float value) {
+  std::uint32_t u;
+  std::memcpy(&u, &value, sizeof(u));
+  if ((u & 0x7fffffffu) > 0x7f800000u) {
+    bits = static_cast<std::uint16_t>((u >> 16) | 0x0040u);  // quiet NaN
+  } else {
+    u += 0x7fffu + ((u >> 16) & 1u);
+    bits = static_cast<std::uint16_t>(u >> 16);
+  }
+}
+
+inline BFloat16::operator float() const {
+  const std::uint32_t u = std::uint32_t(bits) << 16;
+  float value;
+  std::memcpy(&value, &u, sizeof(value));
+  return value;
+}
+
+template <typename Row>
+void QuantizedMatrix::quantize(std::size_t rows, std::size_t cols,
+                               QuantScale scale, Row row) {
+  if ((rows == 0) != (cols == 0)) {
+    throw std::logic_error("The matrix dimension must be larger than 0.");
+  }
+  rows_ = rows;
+  cols_ = cols;
+  mode_ = scale;
+  data_.resize(rows * cols);
+  std::vector<double> max_abs(rows, 0);
+  for (std::size_t i = 0; i < rows; i++)
+    for (std::size_t j = 0; j < cols; j++)
+      max_abs[i] = std::max(max_abs[i], std::abs(double(row(i)[j])));
+  if (scale == QuantScale::PerTensor and rows > 0) {
+    const double m = *std::max_element(max_abs.begin(), max_abs.end());
+    max_abs.assign(1, m);
+  }
+  scales_.resize(max_abs.size());
+  for (std::size_t s = 0; s < max_abs.size(); s++)
+    scales_[s] = float(max_abs[s] / 127);
+
+  parallel_for(rows, parallel_row_grain(cols),
+               [&](std::size_t begin, std::size_t end) {
+                 for (std::size_t i = begin; i < end; i++) {
+                   const double s = scales_[scale == QuantScale::PerRow ? i
+                                                                        : 0];
+                   const double inv = s == 0 ? 0 : 1 / s;
+                   std::int8_t* q = data_.data() + i * cols;
+                   for (std::size_t j = 0; j < cols; j++)
+                     q[j] = static_cast<std::int8_t>(std::clamp(
+                         std::nearbyint(double(row(i)[j]) * inv), -127.0,
+                         127.0));
+                 }
+               });
+}
+
+template <quantizable T>
+QuantizedMatrix::QuantizedMatrix(const MATRIX<T>& matrix, QuantScale scale) {
+  const auto [rows, cols] = matrix_size(matrix);
+  for (const auto& r : matrix) {
+    if (r.size() != cols) {
+      throw std::logic_error("All rows must have the same length.");
+    }
+  }
+  quantize(rows, cols, scale,
+           [&](std::size_t i) { return matrix[i].data(); });
+}
+
+template <quantizable T>
+QuantizedMatrix::QuantizedMatrix(const Matrix<T>& matrix, QuantScale scale) {
+  quantize(matrix.rows(), matrix.cols(), scale,
+           [&](std::size_t i) { return matrix.row(i); });
+}
+
+template <quantizable T>
+MATRIX<T> QuantizedMatrix::to_legacy() const {
+  MATRIX<T> res(rows_, std::vector<T>(cols_));
+  for (std::size_t i = 0; i < rows_; i++)
+    for (std::size_t j = 0; j < cols_; j++) res[i][j] = T(value(i, j));
+  return res;
+}
+
+template <quantizable T>
+BFloat16Matrix::BFloat16Matrix(const MATRIX<T>& matrix)
+    : BFloat16Matrix(matrix_size(matrix).first, matrix_size(matrix).second) {
+  for (std::size_t i = 0; i < rows_; i++) {
+    if (matrix[i].size() != cols_) {
+      throw std::logic_error("All rows must have the same length.");
+    }
+    std::transform(matrix[i].begin(), matrix[i].end(), row(i),
+                   [](T x) { return BFloat16(float(x)); });
+  }
+}
+
+template <quantizable T>
+BFloat16Matrix::BFloat16Matrix(const Matrix<T>& matrix)
+    : BFloat16Matrix(matrix.rows(), matrix.cols()) {
+  parallel_for(rows_, parallel_row_grain(cols_),
+               [&](std::size_t begin, std::size_t end) {
+                 for (std::size_t i = begin; i < end; i++)
+                   std::transform(matrix.row(i), matrix.row(i) + cols_,
+                                  row(i),
+                                  [](T x) { return BFloat16(float(x)); });
+               });
+}
+
+template <quantizable T>
+MATRIX<T> BFloat16Matrix::to_legacy() const {
+  MATRIX<T> res(rows_, std::vector<T>(cols_));
+  for (std::size_t i = 0; i < rows_; i++)
+    for (std::size_t j = 0; j < cols_; j++)
+      res[i][j] = T(float((*this)(i, j)));
+  return res;
+}
+
+}  // namespace algebra
+
+#endif  // AUT_AP_2024_Spring_HW1_QUANTIZED
@@ -0,0 +1,83 @@
+#ifndef AUT_AP_2024_Spring_HW1_RANDOM
+#define AUT_AP_2024_Spring_HW1_RANDOM
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+
+namespace algebra {
+// Counter-based random numbers (Philox4x32-10, Salmon et al., SC'11).
+// Value number n of the stream for a seed is a pure function of (seed, n):
+// any part of a matrix can be generated on its own, in any order and on any
+// thread, and always comes out the same.
+
+// One Philox4x32-10 block, as in the Random123 reference implementation
+std::array<std::uint32_t, 4> philox4x32(std::array<std::uint32_t, 4> counter,
+                                        std::array<std::uint32_t, 2> key);
+
+// out[i] = 64-bit value number first + i of the stream for `seed`
+// (two values per Philox block); SIMD kernels picked like those of simd.h
+void philox_fill(std::uint64_t seed, std::uint64_t first, std::size_t count,
+                 std::uint64_t* out);
+
+// Fresh seed for calls that do not pass one. Only the first call reads
+// std::random_device; later ones hash an incrementing counter.
+std::uint64_t random_seed();
+
+// out[i] = value number first + i of the stream, mapped to
+// [lowerBound, upperBound] for integers and [lowerBound, upperBound) for
+// floating point types
+template <typename T>
+void random_uniform(std::uint64_t seed, std::uint64_t first, std::size_t count,
+                    T lowerBound, T upperBound, T* out);
+
+////////////////////////////
+////// Implementation //////
+////////////////////////////
+
+template <typename T>
+void random_uniform(std::uint64_t seed, std::uint64_t first, std::size_t count,
+                    T lowerBound, T upperBound, T* out) {
+  if constexpr (!std::is_arithmetic_v<T>) {
+    throw std::logic_error(
+        "The template type must be integer or floating point number.");
+  } else {
+    constexpr std::size_t chunk = 256;
+    std::uint64_t bits[chunk];
+    for (std::size_t done = 0; done < count; done += chunk) {
+      const std::size_t n = count - done < chunk ? count - done : chunk;
+      philox_fill(seed, first + done, n, bits);
+      if constexpr (std::is_floating_point_v<T>) {
+        // top mantissa-width bits give a uniform value in [0, 1)
+        const T width = upperBound - lowerBound;
+        for (std::size_t i = 0; i < n; i++) {
+          T unit;
+          if constexpr (sizeof(T) <= 4)
+            unit = T(bits[i] >> 40) * T(0x1.0p-24);
+          else
+            unit = T(bits[i] >> 11) * T(0x1.0p-53);
+          out[done + i] = lowerBound + width * unit;
+        }
+      } else {
+        // multiply-shift onto the range; the bias is below range / 2^64
+        using U = std::make_unsigned_t<T>;
+        __extension__ typedef unsigned __int128 u128;
+        const std::uint64_t range =
+            std::uint64_t(U(U(upperBound) - U(lowerBound))) + 1;
+        for (std::size_t i = 0; i < n; i++) {
+          // range == 0: the full 64-bit range, every value is fine
+          const std::uint64_t offset =
+              range == 0 ? bits[i]
+                         : std::uint64_t((u128(bits[i]) * range) >> 64);
+          out[done + i] = T(U(U(lowerBound) + U(offset)));
+        }
+      }
+    }
+  }
+}
+
+}  // namespace algebra
+
+#endif  // AUT_AP_2024_Spring_HW1_RANDOM
@@ -0,0 +1,463 @@
+#ifndef AUT_AP_2024_Spring_HW1_REDUCE
+#define AUT_AP_2024_Spring_HW1_REDUCE
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "simd.h"
+#include "thread_pool.h"
+#include "view.h"
+
+namespace algebra {
+// How the reductions add up long runs of values:
+// Plain:    vectorized running sums, error growing with the length;
+// Pairwise: leaves of REDUCE_PAIRWISE_BLOCK elements added up as a balanced
+//           tree, O(log n) error growth at nearly the plain speed;
+// Kahan:    compensated sums at every level, about one rounding whatever
+//           the length, at roughly twice the cost.
+// Integer reductions are exact in every mode (barring overflow).
+enum class Summation { Plain, Pairwise, Kahan };
+
+// Elements summed by one leaf of the pairwise tree
+inline constexpr std::size_t REDUCE_PAIRWISE_BLOCK = 256;
+
+// Elements per block of rows reduced by one task. The blocks, and the order
+// their partial results are combined in, depend only on the shape, so a
+// reduction returns the same bits whatever the thread count.
+inline constexpr std::size_t REDUCE_BLOCK_ELEMENTS = 1 << 14;
+
+// Most blocks the column sums split the rows into; each one keeps a row of
+// partial sums
+inline constexpr std::size_t REDUCE_MAX_COLUMN_BLOCKS = 64;
+
+template <typename M>
+inline constexpr bool is_legacy_matrix_v = false;
+
+template <typename T>
+inline constexpr bool is_legacy_matrix_v<MATRIX<T>> = true;
+
+// Operands of the reductions: Matrix, MatrixSpan/MatrixView (strided and
+// transposed views included) or a legacy MATRIX<T>. All of them throw
+// std::logic_error for an empty matrix.
+template <typename M>
+concept reducible = dense_matrix<M> or is_legacy_matrix_v<M>;
+
+// An extreme element and its position. Ties go to the first one in
+// row-major order; NaNs are skipped unless every element is NaN.
+template <typename T>
+struct MatrixExtremum {
+  T value;
+  std::size_t row;
+  std::size_t col;
+
+  bool operator==(const MatrixExtremum&) const = default;
+};
+
+// Sum of all elements
+template <reducible M>
+auto sum(const M& matrix, Summation mode = Summation::Pairwise);
+
+// Sum of a_ij * b_ij over two matrices of the same shape: the Frobenius
+// inner product, or the dot product of vectors stored as 1 x n or n x 1
+template <reducible A, reducible B>
+auto dot(const A& matrixA, const B& matrixB,
+         Summation mode = Summation::Pairwise);
+
+// sqrt(sum of a_ij^2); integer matrices square and add in their own type
+template <reducible M>
+auto frobenius_norm(const M& matrix, Summation mode = Summation::Pairwise);
+
+// Largest absolute column sum
+template <reducible M>
+auto norm_1(const M& matrix, Summation mode = Summation::Pairwise);
+
+// Largest absolute row sum
+template <reducible M>
+auto norm_inf(const M& matrix, Summation mode = Summation::Pairwise);
+
+// One sum per row / per column
+template <reducible M>
+auto row_sums(const M& matrix, Summation mode = Summation::Pairwise);
+
+template <reducible M>
+auto col_sums(const M& matrix, Summation mode = Summation::Pairwise);
+
+template <reducible M>
+auto matrix_min(const M& matrix);
+
+template <reducible M>
+auto matrix_max(const M& matrix);
+
+// trace() with a choice of summation
+template <reducible M>
+auto trace(const M& matrix, Summation mode);
+
+////////////////////////////
+////// Implementation //////
+////////////////////////////
+
+// Rows of any reducible operand: a strided view, or the row pointers of a
+// legacy matrix
+template <typename T>
+class ReduceRows {
+ public:
+  explicit ReduceRows(MatrixView<T> view)
+      : rows_(view.rows()),
+        cols_(view.cols()),
+        row_stride_(view.row_stride()),
+        col_stride_(view.col_stride()),
+        data_(view.data()) {}
+  explicit ReduceRows(const MATRIX<T>& matrix)
+      : rows_(matrix_size(matrix).first),
+        cols_(matrix_size(matrix).second),
+        pointers_(rows_) {
+    for (std::size_t i = 0; i < rows_; i++) {
+      if (matrix[i].size() != cols_) {
+        throw std::logic_error("All rows must have the same length.");
+      }
+      pointers_[i] = matrix[i].data();
+    }
+  }
+
+  std::size_t rows() const { return rows_; }
+  std::size_t cols() const { return cols_; }
+  bool empty() const { return rows_ == 0 or cols_ == 0; }
+  bool contiguous_rows() const { return col_stride_ == 1; }
+  const T* row(std::size_t i) const {
+    return pointers_.empty() ? data_ + i * row_stride_ : pointers_[i];
+  }
+  T operator()(std::size_t i, std::size_t j) const {
+    return row(i)[j * col_stride_];
+  }
+
+  // A transposed view of row-major storage: contiguous the other way round
+  bool transposed() const {
+    return pointers_.empty() and col_stride_ != 1 and row_stride_ == 1;
+  }
+  // The same elements with rows and columns swapped
+  ReduceRows swapped() const {
+    return ReduceRows(
+        MatrixView<T>(data_, cols_, rows_, col_stride_, row_stride_));
+  }
+
+ private:
+  std::size_t rows_ = 0;
+  std::size_t cols_ = 0;
+  std::size_t row_stride_ = 0;
+  std::size_t col_stride_ = 1;
+  const T* data_ = nullptr;
+  std::vector<const T*> pointers_;
+};
+
+template <typename M>
+auto reduce_rows(const M& matrix) {
+  if constexpr (is_legacy_matrix_v<M>) {
+    return ReduceRows<typename M::value_type::value_type>(matrix);
+  } else {
+    return ReduceRows<typename M::value_type>(view(matrix));
+  }
+}
+
+// Row i as a contiguous array of f(a_ij), through `buffer` unless it can
+// be read in place
+template <typename T, typename F = std::identity>
+const T* reduce_row(const ReduceRows<T>& rows, std::size_t i,
+                    std::vector<T>& buffer, F f = {}) {
+  if constexpr (std::is_same_v<F, std::identity>) {
+    if (rows.contiguous_rows()) return rows.row(i);
+  }
+  buffer.resize(rows.cols());
+  for (std::size_t j = 0; j < rows.cols(); j++) buffer[j] = f(rows(i, j));
+  return buffer.data();
+}
+
+// |x| for every arithmetic element type
+template <typename T>
+T reduce_abs(T x) {
+  return x < T(0) ? T(-x) : x;
+}
+
+// Sum of values[0, n)
+template <typename T>
+T reduce_combine(const T* values, std::size_t n, Summation mode) {
+  if (mode == Summation::Kahan) return simd_sum_kahan(values, n);
+  if (mode == Summation::Pairwise and n > 2) {
+    const std::size_t half = n / 2;
+    return reduce_combine(values, half, mode) +
+           reduce_combine(values + half, n - half, mode);
+  }
+  return simd_sum(values, n);
+}
+
+// Sum of x[0, n), or of x[i] * y[i] when y is given
+template <typename T>
+T reduce_contiguous(const T* x, std::type_identity_t<const T*> y, std::size_t n,
+                    Summation mode) {
+  if (mode == Summation::Kahan)
+    return y ? simd_dot_kahan(x, y, n) : simd_sum_kahan(x, n);
+  if (mode == Summation::Pairwise and n > REDUCE_PAIRWISE_BLOCK) {
+    // split on a leaf boundary so every leaf but the last is full
+    const std::size_t leaves =
+        (n + REDUCE_PAIRWISE_BLOCK - 1) / REDUCE_PAIRWISE_BLOCK;
+    const std::size_t half = leaves / 2 * REDUCE_PAIRWISE_BLOCK;
+    return reduce_contiguous(x, y, half, mode) +
+           reduce_contiguous(x + half, y ? y + half : y, n - half, mode);
+  }
+  return y ? simd_dot(x, y, n) : simd_sum(x, n);
+}
+
+// Rows per block for `cols` columns
+inline std::size_t reduce_block_rows(std::size_t cols) {
+  return std::max<std::size_t>(1, REDUCE_BLOCK_ELEMENTS / cols);
+}
+
+// Blocks per task, enough of them to pay for a thread
+inline std::size_t reduce_block_grain(std::size_t block_elements) {
+  return std::max<std::size_t>(1, parallel_min_elements() / block_elements);
+}
+
+// block(b, i0, i1) for the fixed blocks of rows [i0, i1) over the pool
+template <typename Block>
+void reduce_blocks(std::size_t rows, std::size_t cols, std::size_t block,
+                   Block body) {
+  parallel_for((rows + block - 1) / block, reduce_block_grain(block * cols),
+               [&](std::size_t begin, std::size_t end) {
+                 for (std::size_t b = begin; b < end; b++)
+                   body(b, b * block, std::min(rows, (b + 1) * block));
+               });
+}
+
+// Sum of f(a_ij) for each row
+template <typename T, typename F>
+std::vector<T> reduce_row_sums(const ReduceRows<T>& rows, Summation mode,
+                               F f) {
+  std::vector<T> sums(rows.rows());
+  reduce_blocks(rows.rows(), rows.cols(), reduce_block_rows(rows.cols()),
+                [&](std::size_t, std::size_t i0, std::size_t i1) {
+                  std::vector<T> buffer;
+                  for (std::size_t i = i0; i < i1; i++)
+                    sums[i] = reduce_contiguous(reduce_row(rows, i, buffer, f),
+                                                nullptr, rows.cols(), mode);
+                });
+  return sums;
+}
+
+// Column sums of f(a_ij). Each block of rows is added up into a row of
+// partial sums: compensated per column for Kahan, through a binary counter
+// of subtotals over leaves of REDUCE_PAIRWISE_BLOCK rows for Pairwise, the
+// column-wise analogue of reduce_contiguous(). The partial rows are then
+// combined column by column.
+template <typename T, typename F = std::identity>
+std::vector<T> reduce_col_sums(const ReduceRows<T>& rows, Summation mode,
+                               F f = {}) {
+  const std::size_t m = rows.rows(), n = rows.cols();
+  const std::size_t block =
+      std::max((m + REDUCE_MAX_COLUMN_BLOCKS - 1) / REDUCE_MAX_COLUMN_BLOCKS,
+               reduce_block_rows(n));
+  const std::size_t blocks = (m + block - 1) / block;
+  std::vector<T> partial(blocks * n);
+  reduce_blocks(m, n, block, [&](std::size_t b, std::size_t i0,
+                                 std::size_t i1) {
+    std::vector<T> buffer;
+    T* out = partial.data() + b * n;
+    if (mode == Summation::Kahan) {
+      std::vector<T> comp(n, T(0));
+      for (std::size_t i = i0; i < i1; i++) {
+        const T* x = reduce_row(rows, i, buffer, f);
+        for (std::size_t j = 0; j < n; j++) {
+          const T y = x[j] - comp[j];
+          const T t = out[j] + y;
+          comp[j] = (t - out[j]) - y;
+          out[j] = t;
+        }
+      }
+    } else if (mode == Summation::Pairwise) {
+      // levels[l] holds the subtotal of 2^l leaves while full[l] is set
+      std::vector<std::vector<T>> levels;
+      std::vector<bool> full;
+      std::vector<T> leaf;
+      for (std::size_t i = i0; i < i1; i += REDUCE_PAIRWISE_BLOCK) {
+        const T* x = reduce_row(rows, i, buffer, f);
+        leaf.assign(x, x + n);
+        for (std::size_t r = i + 1;
+             r < std::min(i1, i + REDUCE_PAIRWISE_BLOCK); r++)
+          simd_add(leaf.data(), reduce_row(rows, r, buffer, f), leaf.data(),
+                   n);
+        std::size_t l = 0;
+        for (; l < full.size() and full[l]; l++) {
+          simd_add(levels[l].data(), leaf.data(), leaf.data(), n);
+          full[l] = false;
+        }
+        if (l == levels.size()) {
+          levels.emplace_back();
+          full.push_back(false);
+        }
+        levels[l].swap(leaf);
+        full[l] = true;
+      }
+      for (std::size_t l = 0; l < full.size(); l++)
+        if (full[l]) simd_add(out, levels[l].data(), out, n);
+    } else {
+      for (std::size_t i = i0; i < i1; i++)
+        simd_add(out, reduce_row(rows, i, buffer, f), out, n);
+    }
+  });
+
+  std::vector<T> sums(n), column(blocks);
+  for (std::size_t j = 0; j < n; j++) {
+    for (std::size_t b = 0; b < blocks; b++) column[b] = partial[b * n + j];
+    sums[j] = reduce_combine(column.data(), blocks, mode);
+  }
+  return sums;
+}
+
+// Row or column sums of f(a_ij)
+template <typename T, typename F = std::identity>
+std::vector<T> reduce_sums(ReduceRows<T> rows, bool per_row, Summation mode,
+                           F f = {}) {
+  if (rows.empty()) throw std::logic_error("Matrix is empty.");
+  // the rows of a transposed view are the columns of its storage
+  if (rows.transposed()) {
+    rows = rows.swapped();
+    per_row = !per_row;
+  }
+  return per_row ? reduce_row_sums(rows, mode, f)
+                 : reduce_col_sums(rows, mode, f);
+}
+
+// Sum of all a_ij, or of a_ij * b_ij when b is given: each block of rows is
+// added up into a partial sum, then the partial sums in block order
+template <typename T>
+T reduce_total(ReduceRows<T> a,
+               std::type_identity_t<std::optional<ReduceRows<T>>> b,
+               Summation mode) {
+  if (a.empty()) throw std::logic_error("Matrix is empty.");
+  // transposed views are read in storage order
+  if (a.transposed() and (!b or b->transposed())) {
+    a = a.swapped();
+    if (b) b = b->swapped();
+  }
+  const std::size_t block = reduce_block_rows(a.cols());
+  std::vector<T> partial((a.rows() + block - 1) / block);
+  reduce_blocks(a.rows(), a.cols(), block,
+                [&](std::size_t blk, std::size_t i0, std::size_t i1) {
+                  std::vector<T> x, y, values(i1 - i0);
+                  for (std::size_t i = i0; i < i1; i++)
+                    values[i - i0] = reduce_contiguous(
+                        reduce_row(a, i, x), b ? reduce_row(*b, i, y) : nullptr,
+                        a.cols(), mode);
+                  partial[blk] =
+                      reduce_combine(values.data(), values.size(), mode);
+                });
+  return reduce_combine(partial.data(), partial.size(), mode);
+}
+
+// The element `better` prefers over all others, the first one on ties
+template <typename T, typename Better>
+MatrixExtremum<T> reduce_extremum(const ReduceRows<T>& rows, Better better) {
+  if (rows.empty()) throw std::logic_error("Matrix is empty.");
+  // NaN compares false with everything, so any number replaces one
+  const auto replaces = [&](T x, T best) {
+    return better(x, best) or (best != best and x == x);
+  };
+  const std::size_t block = reduce_block_rows(rows.cols());
+  std::vector<MatrixExtremum<T>> partial((rows.rows() + block - 1) / block);
+  reduce_blocks(rows.rows(), rows.cols(), block,
+                [&](std::size_t b, std::size_t i0, std::size_t i1) {
+                  MatrixExtremum<T> best{rows(i0, 0), i0, 0};
+                  for (std::size_t i = i0; i < i1; i++) {
+                    const T* r = rows.row(i);
+                    for (std::size_t j = 0; j < rows.cols(); j++) {
+                      const T x = rows.contiguous_rows() ? r[j] : rows(i, j);
+                      if (replaces(x, best.value)) best = {x, i, j};
+                    }
+                  }
+                  partial[b] = best;
+                });
+  MatrixExtremum<T> best = partial[0];
+  for (const auto& p : partial)
+    if (replaces(p.value, best.value)) best = p;
+  return best;
+}
+
+template <reducible M>
+auto sum(const M& matrix, Summation mode) {
+  const auto rows = reduce_rows(matrix);
+  return reduce_total(rows, {}, mode);
+}
+
+template <reducible A, reducible B>
+auto dot(const A& matrixA, const B& matrixB, Summation mode) {
+  const auto a = reduce_rows(matrixA);
+  const auto b = reduce_rows(matrixB);
+  static_assert(std::is_same_v<decltype(a), decltype(b)>);
+  if (a.empty() or b.empty()) throw std::logic_error("Matrix is empty.");
+  if (a.rows() != b.rows() or a.cols() != b.cols())
+    throw std::logic_error("Matrix dimensions are not same.");
+  return reduce_total(a, std::optional(b), mode);
+}
+
+template <reducible M>
+auto frobenius_norm(const M& matrix, Summation mode) {
+  const auto rows = reduce_rows(matrix);
+  return std::sqrt(reduce_total(rows, std::optional(rows), mode));
+}
+
+template <reducible M>
+auto norm_1(const M& matrix, Summation mode) {
+  const auto rows = reduce_rows(matrix);
+  using T = std::remove_cvref_t<decltype(rows(0, 0))>;
+  const auto sums = reduce_sums(rows, false, mode, reduce_abs<T>);
+  return *std::max_element(sums.begin(), sums.end());
+}
+
+template <reducible M>
+auto norm_inf(const M& matrix, Summation mode) {
+  const auto rows = reduce_rows(matrix);
+  using T = std::remove_cvref_t<decltype(rows(0, 0))>;
+  const auto sums = reduce_sums(rows, true, mode, reduce_abs<T>);
+  return *std::max_element(sums.begin(), sums.end());
+}
+
+template <reducible M>
+auto row_sums(const M& matrix, Summation mode) {
+  return reduce_sums(reduce_rows(matrix), true, mode);
+}
+
+template <reducible M>
+auto col_sums(const M& matrix, Summation mode) {
+  return reduce_sums(reduce_rows(matrix), false, mode);
+}
+
+template <reducible M>
+auto matrix_min(const M& matrix) {
+  return reduce_extremum(reduce_rows(matrix),
+                         [](auto x, auto best) { return x < best; });
+}
+
+template <reducible M>
+auto matrix_max(const M& matrix) {
+  return reduce_extremum(reduce_rows(matrix),
+                         [](auto x, auto best) { return best < x; });
+}
+
+template <reducible M>
+auto trace(const M& matrix, Summation mode) {
+  const auto rows = reduce_rows(matrix);
+  if (rows.empty()) throw std::logic_error("Matrix is empty.");
+  if (rows.rows() != rows.cols())
+    throw std::logic_error("Matrix must be square.");
+  std::vector<std::remove_cvref_t<decltype(rows(0, 0))>> diagonal(rows.rows());
+  for (std::size_t i = 0; i < rows.rows(); i++) diagonal[i] = rows(i, i);
+  return reduce_contiguous(diagonal.data(), nullptr, diagonal.size(), mode);
+}
+
+}  // namespace algebra
+
+#endif  // AUT_AP_2024_Spring_HW1_REDUCE
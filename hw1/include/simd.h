@@ -0,0 +1,210 @@
+#ifndef AUT_AP_2024_Spring_HW1_SIMD
+#define AUT_AP_2024_Spring_HW1_SIMD
+
+#include <cstddef>
+#include <cstdint>
+
+namespace algebra {
+// Instruction sets the element-wise kernels are built for.
+// x86-64 picks between Scalar (the baseline SSE2 build), AVX2 and AVX-512 at
+// runtime; on ARM the NEON kernels are part of the baseline.
+enum class SimdLevel { Scalar, AVX2, AVX512, NEON };
+
+// Best level supported by this CPU (detected once)
+SimdLevel detected_simd_level();
+
+// Level the kernels currently dispatch to
+SimdLevel simd_level();
+
+// Force a level, e.g. to compare kernels; clamped to detected_simd_level()
+void set_simd_level(SimdLevel level);
+
+const char* simd_level_name(SimdLevel level);
+
+// Element-wise kernels over n contiguous elements.
+// `out` may alias `a` or `b`; the arrays need no particular alignment.
+#define ALGEBRA_SIMD_DECLARE(T)                                             \
+  void simd_add(const T* a, const T* b, T* out, std::size_t n);             \
+  void simd_sub(const T* a, const T* b, T* out, std::size_t n);             \
+  void simd_mul(const T* a, const T* b, T* out, std::size_t n);             \
+  void simd_scale(const T* a, T scalar, T* out, std::size_t n);             \
+  T simd_sum(const T* a, std::size_t n);                                    \
+  T simd_strided_sum(const T* a, std::size_t stride, std::size_t n);     \
+  T simd_dot(const T* a, const T* b, std::size_t n);                        \
+  T simd_sum_kahan(const T* a, std::size_t n);                              \
+  T simd_dot_kahan(const T* a, const T* b, std::size_t n);                  \
+  void simd_axpy(T alpha, const T* x, T* y, std::size_t n);                 \
+  void simd_gemm_batched(std::size_t batch, std::size_t m, std::size_t n,   \
+                         std::size_t k, const T* a, std::size_t stride_a,   \
+                         const T* b, std::size_t stride_b, T* c,            \
+                         std::size_t stride_c);                             \
+  void simd_transpose(const T* src, std::size_t src_stride, T* dst,         \
+                      std::size_t dst_stride, std::size_t rows,             \
+                      std::size_t cols);
+
+ALGEBRA_SIMD_DECLARE(float)
+ALGEBRA_SIMD_DECLARE(double)
+ALGEBRA_SIMD_DECLARE(std::int32_t)
+ALGEBRA_SIMD_DECLARE(std::int64_t)
+
+#undef ALGEBRA_SIMD_DECLARE
+
+// Scalar fallbacks for every other element type
+template <typename T>
+void simd_add(const T* a, const T* b, T* out, std::size_t n);
+
+template <typename T>
+void simd_sub(const T* a, const T* b, T* out, std::size_t n);
+
+template <typename T>
+void simd_mul(const T* a, const T* b, T* out, std::size_t n);
+
+template <typename T>
+void simd_scale(const T* a, T scalar, T* out, std::size_t n);
+
+template <typename T>
+T simd_sum(const T* a, std::size_t n);
+
+// Sum of a[0], a[stride], ..., a[(n - 1) * stride]; a matrix trace is
+// simd_strided_sum(data, stride + 1, n)
+template <typename T>
+T simd_strided_sum(const T* a, std::size_t stride, std::size_t n);
+
+// Sum of a[i] * b[i]
+template <typename T>
+T simd_dot(const T* a, const T* b, std::size_t n);
+
+// simd_sum() and simd_dot() with Kahan compensation in every lane: the
+// error stays near one rounding whatever n, at about twice the cost
+template <typename T>
+T simd_sum_kahan(const T* a, std::size_t n);
+
+template <typename T>
+T simd_dot_kahan(const T* a, const T* b, std::size_t n);
+
+// y[i] += alpha * x[i]
+template <typename T>
+void simd_axpy(T alpha, const T* x, T* y, std::size_t n);
+
+// C_i = A_i * B_i for i < batch, where A_i = a + i * stride_a is an m x k,
+// B_i = b + i * stride_b a k x n and C_i = c + i * stride_c an m x n matrix,
+// all dense and row-major. A stride of 0 uses the same operand every time.
+template <typename T>
+void simd_gemm_batched(std::size_t batch, std::size_t m, std::size_t n,
+                       std::size_t k, const T* a, std::size_t stride_a,
+                       const T* b, std::size_t stride_b, T* c,
+                       std::size_t stride_c);
+
+// dst (cols x rows) = src (rows x cols)^T; rows are `src_stride` and
+// `dst_stride` elements apart. Square tiles are transposed in registers.
+// Meant for blocks that fit in cache (see transpose.h for whole matrices).
+template <typename T>
+void simd_transpose(const T* src, std::size_t src_stride, T* dst,
+                    std::size_t dst_stride, std::size_t rows,
+                    std::size_t cols);
+
+////////////////////////////
+////// Implementation //////
+////////////////////////////
+
+template <typename T>
+void simd_add(const T* a, const T* b, T* out, std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) out[i] = a[i] + b[i];
+}
+
+template <typename T>
+void simd_sub(const T* a, const T* b, T* out, std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) out[i] = a[i] - b[i];
+}
+
+template <typename T>
+void simd_mul(const T* a, const T* b, T* out, std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) out[i] = a[i] * b[i];
+}
+
+template <typename T>
+void simd_scale(const T* a, T scalar, T* out, std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) out[i] = a[i] * scalar;
+}
+
+template <typename T>
+T simd_sum(const T* a, std::size_t n) {
+  T res = 0;
+  for (std::size_t i = 0; i < n; i++) res += a[i];
+  return res;
+}
+
+template <typename T>
+T simd_strided_sum(const T* a, std::size_t stride, std::size_t n) {
+  T res = 0;
+  for (std::size_t i = 0; i < n; i++) res += a[i * stride];
+  return res;
+}
+
+template <typename T>
+T simd_dot(const T* a, const T* b, std::size_t n) {
+  T res = 0;
+  for (std::size_t i = 0; i < n; i++) res += a[i] * b[i];
+  return res;
+}
+
+template <typename T>
+T simd_sum_kahan(const T* a, std::size_t n) {
+  T res = 0, comp = 0;
+  for (std::size_t i = 0; i < n; i++) {
+    const T y = a[i] - comp;
+    const T t = res + y;
+    comp = (t - res) - y;
+    res = t;
+  }
+  return res;
+}
+
+template <typename T>
+T simd_dot_kahan(const T* a, const T* b, std::size_t n) {
+  T res = 0, comp = 0;
+  for (std::size_t i = 0; i < n; i++) {
+    const T y = a[i] * b[i] - comp;
+    const T t = res + y;
+    comp = (t - res) - y;
+    res = t;
+  }
+  return res;
+}
+
+template <typename T>
+void simd_axpy(T alpha, const T* x, T* y, std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) y[i] += alpha * x[i];
+}
+
+template <typename T>
+void simd_gemm_batched(std::size_t batch, std::size_t m, std::size_t n,
+                       std::size_t k, const T* a, std::size_t stride_a,
+                       const T* b, std::size_t stride_b, T* c,
+                       std::size_t stride_c) {
+  for (std::size_t s = 0; s < batch; s++) {
+    const T* as = a + s * stride_a;
+    const T* bs = b + s * stride_b;
+    T* cs = c + s * stride_c;
+    for (std::size_t i = 0; i < m; i++)
+      for (std::size_t j = 0; j < n; j++) {
+        T acc = 0;
+        for (std::size_t p = 0; p < k; p++)
+          acc += as[i * k + p] * bs[p * n + j];
+        cs[i * n + j] = acc;
+      }
+  }
+}
+
+template <typename T>
+void simd_transpose(const T* src, std::size_t src_stride, T* dst,
+                    std::size_t dst_stride, std::size_t rows,
+                    std::size_t cols) {
+  for (std::size_t i = 0; i < rows; i++)
+    for (std::size_t j = 0; j < cols; j++)
+      dst[j * dst_stride + i] = src[i * src_stride + j];
+}
+
+}  // namespace algebra
+
+#endif  // AUT_AP_2024_Spring_HW1_SIMD
@@ -0,0 +1,748 @@
+#ifndef AUT_AP_2024_Spring_HW1_SPARSE
+#define AUT_AP_2024_Spring_HW1_SPARSE
+
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "matrix.h"
+
+namespace algebra {
+// Sparse matrices: only the stored (non-zero) elements take memory and time.
+// CooMatrix: unordered (row, column, value) triplets, for building a matrix
+//            element by element; duplicates add up.
+// CsrMatrix: compressed rows; row i holds the elements
+//            [row_ptr()[i], row_ptr()[i + 1]) of col_indices()/values(),
+//            sorted by column. Every arithmetic routine works on CSR.
+// CscMatrix: the same by columns, for column access; converting to CSR and
+//            back is a counting sort.
+// Conversions from dense storage skip zeros; results of arithmetic keep
+// every element that was computed, even if it cancelled out to zero.
+template <typename T>
+class CooMatrix;
+
+template <typename T>
+class CsrMatrix;
+
+template <typename T>
+class CscMatrix;
+
+template <typename T>
+class CooMatrix {
+ public:
+  using value_type = T;
+
+  CooMatrix() = default;
+  CooMatrix(std::size_t rows, std::size_t cols);
+  CooMatrix(std::size_t rows, std::size_t cols,
+            std::vector<std::size_t> row_indices,
+            std::vector<std::size_t> col_indices, std::vector<T> values);
+  explicit CooMatrix(const MATRIX<T>& matrix);
+  explicit CooMatrix(const CsrMatrix<T>& matrix);
+
+  std::size_t rows() const { return rows_; }
+  std::size_t cols() const { return cols_; }
+  std::size_t nnz() const { return values_.size(); }
+  const std::vector<std::size_t>& row_indices() const { return row_ind_; }
+  const std::vector<std::size_t>& col_indices() const { return col_ind_; }
+  const std::vector<T>& values() const { return values_; }
+
+  // Append an element; a second one at the same position is added to it
+  void insert(std::size_t i, std::size_t j, const T& value);
+
+  MATRIX<T> to_legacy() const;
+
+ private:
+  std::size_t rows_ = 0;
+  std::size_t cols_ = 0;
+  std::vector<std::size_t> row_ind_;
+  std::vector<std::size_t> col_ind_;
+  std::vector<T> values_;
+};
+
+template <typename T>
+class CsrMatrix {
+ public:
+  using value_type = T;
+
+  CsrMatrix() : row_ptr_(1, 0) {}
+  // All-zero matrix
+  CsrMatrix(std::size_t rows, std::size_t cols);
+  // Takes the arrays as they are; they must describe a valid matrix
+  CsrMatrix(std::size_t rows, std::size_t cols,
+            std::vector<std::size_t> row_ptr,
+            std::vector<std::size_t> col_indices, std::vector<T> values);
+  explicit CsrMatrix(const MATRIX<T>& matrix);
+  explicit CsrMatrix(const Matrix<T>& matrix);
+  explicit CsrMatrix(const CooMatrix<T>& matrix);
+  explicit CsrMatrix(const CscMatrix<T>& matrix);
+
+  std::size_t rows() const { return rows_; }
+  std::size_t cols() const { return cols_; }
+  std::size_t nnz() const { return values_.size(); }
+  const std::vector<std::size_t>& row_ptr() const { return row_ptr_; }
+  const std::vector<std::size_t>& col_indices() const { return col_ind_; }
+  const std::vector<T>& values() const { return values_; }
+  std::vector<T>& values() { return values_; }
+
+  // Element (i, j), zero if it is not stored; O(log nnz of the row)
+  T operator()(std::size_t i, std::size_t j) const;
+
+  MATRIX<T> to_legacy() const;
+  Matrix<T> to_matrix() const;
+
+ private:
+  std::size_t rows_ = 0;
+  std::size_t cols_ = 0;
+  std::vector<std::size_t> row_ptr_;
+  std::vector<std::size_t> col_ind_;
+  std::vector<T> values_;
+};
+
+template <typename T>
+class CscMatrix {
+ public:
+  using value_type = T;
+
+  CscMatrix() : col_ptr_(1, 0) {}
+  CscMatrix(std::size_t rows, std::size_t cols);
+  CscMatrix(std::size_t rows, std::size_t cols,
+            std::vector<std::size_t> col_ptr,
+            std::vector<std::size_t> row_indices, std::vector<T> values);
+  explicit CscMatrix(const MATRIX<T>& matrix);
+  explicit CscMatrix(const CsrMatrix<T>& matrix);
+
+  std::size_t rows() const { return rows_; }
+  std::size_t cols() const { return cols_; }
+  std::size_t nnz() const { return values_.size(); }
+  const std::vector<std::size_t>& col_ptr() const { return col_ptr_; }
+  const std::vector<std::size_t>& row_indices() const { return row_ind_; }
+  const std::vector<T>& values() const { return values_; }
+  std::vector<T>& values() { return values_; }
+
+  T operator()(std::size_t i, std::size_t j) const;
+
+  MATRIX<T> to_legacy() const;
+
+ private:
+  std::size_t rows_ = 0;
+  std::size_t cols_ = 0;
+  std::vector<std::size_t> col_ptr_;
+  std::vector<std::size_t> row_ind_;
+  std::vector<T> values_;
+};
+
+// Check the compressed arrays of an (outer x inner) CSR or CSC matrix
+template <typename T>
+void sparse_validate(std::size_t outer, std::size_t inner,
+                     const std::vector<std::size_t>& ptr,
+                     const std::vector<std::size_t>& indices,
+                     const std::vector<T>& values);
+
+// Counting-sort transpose of compressed arrays: the rows of an
+// (outer x inner) matrix become the columns of the result
+template <typename T>
+void sparse_transpose(std::size_t outer, std::size_t inner,
+                      const std::vector<std::size_t>& ptr,
+                      const std::vector<std::size_t>& indices,
+                      const std::vector<T>& values,
+                      std::vector<std::size_t>& t_ptr,
+                      std::vector<std::size_t>& t_indices,
+                      std::vector<T>& t_values);
+
+// Split the rows into ranges holding about the same number of stored
+// elements and run body(begin, end) on them over the thread pool.
+// `work_per_element` estimates the cost of one stored element in flops.
+template <typename F>
+void sparse_parallel_rows(const std::vector<std::size_t>& row_ptr,
+                          std::size_t work_per_element, F&& body);
+
+template <typename T>
+std::pair<size_t, size_t> matrix_size(const CooMatrix<T>& matrix);
+
+template <typename T>
+std::pair<size_t, size_t> matrix_size(const CsrMatrix<T>& matrix);
+
+template <typename T>
+std::pair<size_t, size_t> matrix_size(const CscMatrix<T>& matrix);
+
+template <typename T>
+void display(const CsrMatrix<T>& matrix);
+
+// Sparse x dense
+template <typename T>
+MATRIX<T> multiply(const CsrMatrix<T>& matrixA, const MATRIX<T>& matrixB);
+
+template <typename T>
+Matrix<T> multiply(const CsrMatrix<T>& matrixA, const Matrix<T>& matrixB);
+
+// Sparse x sparse (Gustavson's row-by-row SpGEMM)
+template <typename T>
+CsrMatrix<T> multiply(const CsrMatrix<T>& matrixA,
+                      const CsrMatrix<T>& matrixB);
+
+template <typename T>
+CsrMatrix<T> multiply(const CsrMatrix<T>& matrix, const T scalar);
+
+template <typename T>
+CsrMatrix<T> sum_sub(const CsrMatrix<T>& matrixA, const CsrMatrix<T>& matrixB,
+                     std::optional<std::string> operation = "sum");
+
+template <typename T>
+CsrMatrix<T> transpose(const CsrMatrix<T>& matrix);
+
+template <typename T>
+T trace(const CsrMatrix<T>& matrix);
+
+////////////////////////////
+////// Implementation //////
+////////////////////////////
+
+template <typename T>
+void sparse_validate(std::size_t outer, std::size_t inner,
+                     const std::vector<std::size_t>& ptr,
+                     const std::vector<std::size_t>& indices,
+                     const std::vector<T>& values) {
+  if (ptr.size() != outer + 1 or ptr.front() != 0 or
+      ptr.back() != indices.size() or indices.size() != values.size())
+    throw std::logic_error("Invalid sparse matrix structure.");
+  for (std::size_t r = 0; r < outer; r++) {
+    if (ptr[r] > ptr[r + 1])
+      throw std::logic_error("Invalid sparse matrix structure.");
+    for (std::size_t p = ptr[r]; p < ptr[r + 1]; p++)
+      if (indices[p] >= inner or (p > ptr[r] and indices[p - 1] >= indices[p]))
+        throw std::logic_error("Invalid sparse matrix structure.");
+  }
+}
+
+template <typename T>
+void sparse_transpose(std::size_t outer, std::size_t inner,
+                      const std::vector<std::size_t>& ptr,
+                      const std::vector<std::size_t>& indices,
+                      const std::vector<T>& values,
+                      std::vector<std::size_t>& t_ptr,
+                      std::vector<std::size_t>& t_indices,
+                      std::vector<T>& t_values) {
+  t_ptr.assign(inner + 1, 0);
+  for (std::size_t index : indices) t_ptr[index + 1]++;
+  std::partial_sum(t_ptr.begin(), t_ptr.end(), t_ptr.begin());
+  t_indices.resize(indices.size());
+  t_values.resize(values.size());
+  // walking the rows in order leaves every new row sorted
+  std::vector<std::size_t> next(t_ptr.begin(), t_ptr.end() - 1);
+  for (std::size_t r = 0; r < outer; r++) {
+    for (std::size_t p = ptr[r]; p < ptr[r + 1]; p++) {
+      const std::size_t q = next[indices[p]]++;
+      t_indices[q] = r;
+      t_values[q] = values[p];
+    }
+  }
+}
+
+template <typename F>
+void sparse_parallel_rows(const std::vector<std::size_t>& row_ptr,
+                          std::size_t work_per_element, F&& body) {
+  const std::size_t rows = row_ptr.size() - 1;
+  const std::size_t nnz = row_ptr.back();
+  const std::size_t work = std::max(nnz, rows) * work_per_element;
+  const std::size_t chunks = std::min(
+      {rows, 4 * get_num_threads(),
+       std::max<std::size_t>(1, work / parallel_min_elements())});
+  if (chunks <= 1) {
+    if (rows > 0) body(std::size_t{0}, rows);
+    return;
+  }
+  // chunk c starts at the first row holding element c * nnz / chunks, or at
+  // an even share of the rows if nothing is stored
+  std::vector<std::size_t> bounds(chunks + 1, rows);
+  for (std::size_t c = 0; c < chunks; c++) {
+    bounds[c] = nnz == 0 ? c * rows / chunks
+                         : std::upper_bound(row_ptr.begin(), row_ptr.end(),
+                                            c * nnz / chunks) -
+                               row_ptr.begin() - 1;
+  }
+  bounds[0] = 0;
+  parallel_for(chunks, 1, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t c = begin; c < end; c++)
+      if (bounds[c] < bounds[c + 1]) body(bounds[c], bounds[c + 1]);
+  });
+}
+
+// CooMatrix
+
+template <typename T>
+CooMatrix<T>::CooMatrix(std::size_t rows, std::size_t cols)
+    : rows_(rows), cols_(cols) {}
+
+template <typename T>
+CooMatrix<T>::CooMatrix(std::size_t rows, std::size_t cols,
+                        std::vector<std::size_t> row_indices,
+                        std::vector<std::size_t> col_indices,
+                        std::vector<T> values)
+    : rows_(rows),
+      cols_(cols),
+      row_ind_(std::move(row_indices)),
+      col_ind_(std::move(col_indices)),
+      values_(std::move(values)) {
+  if (row_ind_.size() != values_.size() or col_ind_.size() != values_.size())
+    throw std::logic_error("Invalid sparse matrix structure.");
+  for (std::size_t p = 0; p < values_.size(); p++)
+    if (row_ind_[p] >= rows_ or col_ind_[p] >= cols_)
+      throw std::out_of_range("The element is outside of the matrix.");
+}
+
+template <typename T>
+CooMatrix<T>::CooMatrix(const MATRIX<T>& matrix)
+    : CooMatrix(CsrMatrix<T>(matrix)) {}
+
+template <typename T>
+CooMatrix<T>::CooMatrix(const CsrMatrix<T>& matrix)
+    : rows_(matrix.rows()),
+      cols_(matrix.cols()),
+      col_ind_(matrix.col_indices()),
+      values_(matrix.values()) {
+  row_ind_.reserve(matrix.nnz());
+  for (std::size_t i = 0; i < rows_; i++)
+    row_ind_.insert(row_ind_.end(),
+                    matrix.row_ptr()[i + 1] - matrix.row_ptr()[i], i);
+}
+
+template <typename T>
+void CooMatrix<T>::insert(std::size_t i, std::size_t j, const T& value) {
+  if (i >= rows_ or j >= cols_)
+    throw std::out_of_range("The element is outside of the matrix.");
+  row_ind_.push_back(i);
+  col_ind_.push_back(j);
+  values_.push_back(value);
+}
+
+template <typename T>
+MATRIX<T> CooMatrix<T>::to_legacy() const {
+  MATRIX<T> res(rows_, std::vector<T>(cols_, T(0)));
+  for (std::size_t p = 0; p < values_.size(); p++)
+    res[row_ind_[p]][col_ind_[p]] += values_[p];
+  return res;
+}
+
+// CsrMatrix
+
+template <typename T>
+CsrMatrix<T>::CsrMatrix(std::size_t rows, std::size_t cols)
+    : rows_(rows), cols_(cols), row_ptr_(rows + 1, 0) {}
+
+template <typename T>
+CsrMatrix<T>::CsrMatrix(std::size_t rows, std::size_t cols,
+                        std::vector<std::size_t> row_ptr,
+                        std::vector<std::size_t> col_indices,
+                        std::vector<T> values)
+    : rows_(rows),
+      cols_(cols),
+      row_ptr_(std::move(row_ptr)),
+      col_ind_(std::move(col_indices)),
+      values_(std::move(values)) {
+  sparse_validate(rows_, cols_, row_ptr_, col_ind_, values_);
+}
+
+template <typename T>
+CsrMatrix<T>::CsrMatrix(const MATRIX<T>& matrix)
+    : CsrMatrix(matrix_size(matrix).first, matrix_size(matrix).second) {
+  for (const auto& row : matrix) {
+    if (row.size() != cols_) {
+      throw std::logic_error("All rows must have the same length.");
+    }
+  }
+  // count the non-zeros of every row, then fill the rows in parallel
+  parallel_for(rows_, parallel_row_grain(cols_), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++)
+      row_ptr_[i + 1] = cols_ - std::count(matrix[i].begin(),
+                                           matrix[i].end(), T(0));
+  });
+  std::partial_sum(row_ptr_.begin(), row_ptr_.end(), row_ptr_.begin());
+  col_ind_.resize(row_ptr_.back());
+  values_.resize(row_ptr_.back());
+  parallel_for(rows_, parallel_row_grain(cols_), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      size_t p = row_ptr_[i];
+      for (size_t j = 0; j < cols_; j++) {
+        if (matrix[i][j] != T(0)) {
+          col_ind_[p] = j;
+          values_[p++] = matrix[i][j];
+        }
+      }
+    }
+  });
+}
+
+template <typename T>
+CsrMatrix<T>::CsrMatrix(const Matrix<T>& matrix)
+    : CsrMatrix(matrix.rows(), matrix.cols()) {
+  parallel_for(rows_, parallel_row_grain(cols_), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++)
+      row_ptr_[i + 1] =
+          cols_ - std::count(matrix.row(i), matrix.row(i) + cols_, T(0));
+  });
+  std::partial_sum(row_ptr_.begin(), row_ptr_.end(), row_ptr_.begin());
+  col_ind_.resize(row_ptr_.back());
+  values_.resize(row_ptr_.back());
+  parallel_for(rows_, parallel_row_grain(cols_), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      size_t p = row_ptr_[i];
+      for (size_t j = 0; j < cols_; j++) {
+        if (matrix(i, j) != T(0)) {
+          col_ind_[p] = j;
+          values_[p++] = matrix(i, j);
+        }
+      }
+    }
+  });
+}
+
+template <typename T>
+CsrMatrix<T>::CsrMatrix(const CooMatrix<T>& matrix)
+    : CsrMatrix(matrix.rows(), matrix.cols()) {
+  // bucket the triplets by row, then sort every row and merge duplicates;
+  // the sort is stable so duplicates always add up in insertion order
+  const auto& rows = matrix.row_indices();
+  for (std::size_t i : rows) row_ptr_[i + 1]++;
+  std::partial_sum(row_ptr_.begin(), row_ptr_.end(), row_ptr_.begin());
+  std::vector<std::pair<std::size_t, T>> entries(matrix.nnz());
+  std::vector<std::size_t> next(row_ptr_.begin(), row_ptr_.end() - 1);
+  for (std::size_t p = 0; p < matrix.nnz(); p++)
+    entries[next[rows[p]]++] = {matrix.col_indices()[p], matrix.values()[p]};
+
+  col_ind_.reserve(matrix.nnz());
+  values_.reserve(matrix.nnz());
+  for (std::size_t i = 0; i < rows_; i++) {
+    const auto first = entries.begin() + row_ptr_[i];
+    const auto last = entries.begin() + row_ptr_[i + 1];
+    std::stable_sort(first, last, [](const auto& x, const auto& y) {
+      return x.first < y.first;
+    });
+    row_ptr_[i] = col_ind_.size();
+    for (auto it = first; it != last; it++) {
+      if (col_ind_.size() > row_ptr_[i] and col_ind_.back() == it->first) {
+        values_.back() += it->second;
+      } else {
+        col_ind_.push_back(it->first);
+        values_.push_back(it->second);
+      }
+    }
+  }
+  row_ptr_[rows_] = col_ind_.size();
+}
+
+template <typename T>
+CsrMatrix<T>::CsrMatrix(const CscMatrix<T>& matrix)
+    : rows_(matrix.rows()), cols_(matrix.cols()) {
+  sparse_transpose(cols_, rows_, matrix.col_ptr(), matrix.row_indices(),
+                   matrix.values(), row_ptr_, col_ind_, values_);
+}
+
+template <typename T>
+T CsrMatrix<T>::operator()(std::size_t i, std::size_t j) const {
+  const auto first = col_ind_.begin() + row_ptr_[i];
+  const auto last = col_ind_.begin() + row_ptr_[i + 1];
+  const auto it = std::lower_bound(first, last, j);
+  return it != last and *it == j ? values_[it - col_ind_.begin()] : T(0);
+}
+
+template <typename T>
+MATRIX<T> CsrMatrix<T>::to_legacy() const {
+  MATRIX<T> res(rows_, std::vector<T>(cols_, T(0)));
+  parallel_for(rows_, parallel_row_grain(cols_), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++)
+      for (size_t p = row_ptr_[i]; p < row_ptr_[i + 1]; p++)
+        res[i][col_ind_[p]] = values_[p];
+  });
+  return res;
+}
+
+template <typename T>
+Matrix<T> CsrMatrix<T>::to_matrix() const {
+  Matrix<T> res(rows_, cols_);
+  parallel_for(rows_, parallel_row_grain(cols_), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++)
+      for (size_t p = row_ptr_[i]; p < row_ptr_[i + 1]; p++)
+        res(i, col_ind_[p]) = values_[p];
+  });
+  return res;
+}
+
+// CscMatrix
+
+template <typename T>
+CscMatrix<T>::CscMatrix(std::size_t rows, std::size_t cols)
+    : rows_(rows), cols_(cols), col_ptr_(cols + 1, 0) {}
+
+template <typename T>
+CscMatrix<T>::CscMatrix(std::size_t rows, std::size_t cols,
+                        std::vector<std::size_t> col_ptr,
+                        std::vector<std::size_t> row_indices,
+                        std::vector<T> values)
+    : rows_(rows),
+      cols_(cols),
+      col_ptr_(std::move(col_ptr)),
+      row_ind_(std::move(row_indices)),
+      values_(std::move(values)) {
+  sparse_validate(cols_, rows_, col_ptr_, row_ind_, values_);
+}
+
+template <typename T>
+CscMatrix<T>::CscMatrix(const MATRIX<T>& matrix)
+    : CscMatrix(CsrMatrix<T>(matrix)) {}
+
+template <typename T>
+CscMatrix<T>::CscMatrix(const CsrMatrix<T>& matrix)
+    : rows_(matrix.rows()), cols_(matrix.cols()) {
+  sparse_transpose(rows_, cols_, matrix.row_ptr(), matrix.col_indices(),
+                   matrix.values(), col_ptr_, row_ind_, values_);
+}
+
+template <typename T>
+T CscMatrix<T>::operator()(std::size_t i, std::size_t j) const {
+  const auto first = row_ind_.begin() + col_ptr_[j];
+  const auto last = row_ind_.begin() + col_ptr_[j + 1];
+  const auto it = std::lower_bound(first, last, i);
+  return it != last and *it == i ? values_[it - row_ind_.begin()] : T(0);
+}
+
+template <typename T>
+MATRIX<T> CscMatrix<T>::to_legacy() const {
+  MATRIX<T> res(rows_, std::vector<T>(cols_, T(0)));
+  for (std::size_t j = 0; j < cols_; j++)
+    for (std::size_t p = col_ptr_[j]; p < col_ptr_[j + 1]; p++)
+      res[row_ind_[p]][j] = values_[p];
+  return res;
+}
+
+// Operations
+
+template <typename T>
+std::pair<size_t, size_t> matrix_size(const CooMatrix<T>& matrix) {
+  return std::make_pair(matrix.rows(), matrix.cols());
+}
+
+template <typename T>
+std::pair<size_t, size_t> matrix_size(const CsrMatrix<T>& matrix) {
+  return std::make_pair(matrix.rows(), matrix.cols());
+}
+
+template <typename T>
+std::pair<size_t, size_t> matrix_size(const CscMatrix<T>& matrix) {
+  return std::make_pair(matrix.rows(), matrix.cols());
+}
+
+template <typename T>
+void display(const CsrMatrix<T>& matrix) {
+  display(matrix.to_legacy());
+}
+
+template <typename T>
+MATRIX<T> multiply(const CsrMatrix<T>& matrixA, const MATRIX<T>& matrixB) {
+  const auto sizeB = matrix_size(matrixB);
+  if (matrixA.rows() == 0 or sizeB.first == 0) {
+    throw std::logic_error("Matrix is empty.");
+  }
+  if (matrixA.cols() != sizeB.first) {
+    throw std::logic_error("Matrix dimensions do not match.");
+  }
+
+  MATRIX<T> res(matrixA.rows(), std::vector<T>(sizeB.second, T(0)));
+  const auto& ptr = matrixA.row_ptr();
+  sparse_parallel_rows(ptr, sizeB.second, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      T* r = res[i].data();
+      for (size_t p = ptr[i]; p < ptr[i + 1]; p++) {
+        const T a = matrixA.values()[p];
+        const T* b = matrixB[matrixA.col_indices()[p]].data();
+        for (size_t j = 0; j < sizeB.second; j++) r[j] += a * b[j];
+      }
+    }
+  });
+  return res;
+}
+
+template <typename T>
+Matrix<T> multiply(const CsrMatrix<T>& matrixA, const Matrix<T>& matrixB) {
+  if (matrixA.rows() == 0 or matrixB.empty()) {
+    throw std::logic_error("Matrix is empty.");
+  }
+  if (matrixA.cols() != matrixB.rows()) {
+    throw std::logic_error("Matrix dimensions do not match.");
+  }
+
+  Matrix<T> res(matrixA.rows(), matrixB.cols());
+  const auto& ptr = matrixA.row_ptr();
+  sparse_parallel_rows(ptr, matrixB.cols(), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      T* r = res.row(i);
+      for (size_t p = ptr[i]; p < ptr[i + 1]; p++) {
+        const T a = matrixA.values()[p];
+        const T* b = matrixB.row(matrixA.col_indices()[p]);
+        for (size_t j = 0; j < matrixB.cols(); j++) r[j] += a * b[j];
+      }
+    }
+  });
+  return res;
+}
+
+template <typename T>
+CsrMatrix<T> multiply(const CsrMatrix<T>& matrixA,
+                      const CsrMatrix<T>& matrixB) {
+  if (matrixA.rows() == 0 or matrixB.rows() == 0) {
+    throw std::logic_error("Matrix is empty.");
+  }
+  if (matrixA.cols() != matrixB.rows()) {
+    throw std::logic_error("Matrix dimensions do not match.");
+  }
+
+  const size_t n = matrixB.cols();
+  const auto& ptrA = matrixA.row_ptr();
+  const auto& ptrB = matrixB.row_ptr();
+  const auto& colA = matrixA.col_indices();
+  const auto& colB = matrixB.col_indices();
+  const size_t work = std::max<size_t>(1, matrixB.nnz() / matrixB.rows());
+  constexpr size_t unmarked = static_cast<size_t>(-1);
+
+  // symbolic pass: number of elements in every row of the result
+  std::vector<size_t> row_ptr(matrixA.rows() + 1, 0);
+  sparse_parallel_rows(ptrA, work, [&](size_t begin, size_t end) {
+    std::vector<size_t> marker(n, unmarked);
+    for (size_t i = begin; i < end; i++) {
+      size_t count = 0;
+      for (size_t p = ptrA[i]; p < ptrA[i + 1]; p++)
+        for (size_t q = ptrB[colA[p]]; q < ptrB[colA[p] + 1]; q++)
+          if (marker[colB[q]] != i) {
+            marker[colB[q]] = i;
+            count++;
+          }
+      row_ptr[i + 1] = count;
+    }
+  });
+  std::partial_sum(row_ptr.begin(), row_ptr.end(), row_ptr.begin());
+
+  // numeric pass: accumulate every row in a dense buffer
+  std::vector<size_t> col_ind(row_ptr.back());
+  std::vector<T> values(row_ptr.back());
+  sparse_parallel_rows(ptrA, work, [&](size_t begin, size_t end) {
+    std::vector<size_t> marker(n, unmarked);
+    std::vector<T> acc(n);
+    for (size_t i = begin; i < end; i++) {
+      size_t* cols = col_ind.data() + row_ptr[i];
+      size_t count = 0;
+      for (size_t p = ptrA[i]; p < ptrA[i + 1]; p++) {
+        const T a = matrixA.values()[p];
+        for (size_t q = ptrB[colA[p]]; q < ptrB[colA[p] + 1]; q++) {
+          const size_t j = colB[q];
+          if (marker[j] != i) {
+            marker[j] = i;
+            acc[j] = a * matrixB.values()[q];
+            cols[count++] = j;
+          } else {
+            acc[j] += a * matrixB.values()[q];
+          }
+        }
+      }
+      std::sort(cols, cols + count);
+      for (size_t c = 0; c < count; c++)
+        values[row_ptr[i] + c] = acc[cols[c]];
+    }
+  });
+  return CsrMatrix<T>(matrixA.rows(), n, std::move(row_ptr), std::move(col_ind),
+                      std::move(values));
+}
+
+template <typename T>
+CsrMatrix<T> multiply(const CsrMatrix<T>& matrix, const T scalar) {
+  CsrMatrix<T> res = matrix;
+  simd_scale(res.values().data(), scalar, res.values().data(), res.nnz());
+  return res;
+}
+
+template <typename T>
+CsrMatrix<T> sum_sub(const CsrMatrix<T>& matrixA, const CsrMatrix<T>& matrixB,
+                     std::optional<std::string> operation) {
+  if (matrix_size(matrixA) != matrix_size(matrixB)) {
+    throw std::logic_error("Matrix dimensions are not same.");
+  }
+  const bool sub = operation.has_value() and operation.value() == "sub";
+  const auto& ptrA = matrixA.row_ptr();
+  const auto& ptrB = matrixB.row_ptr();
+  const auto& colA = matrixA.col_indices();
+  const auto& colB = matrixB.col_indices();
+
+  // merge the sorted rows: count first, then write
+  std::vector<size_t> row_ptr(matrixA.rows() + 1, 0);
+  sparse_parallel_rows(ptrA, 2, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      size_t p = ptrA[i], q = ptrB[i], count = 0;
+      while (p < ptrA[i + 1] or q < ptrB[i + 1]) {
+        if (q == ptrB[i + 1] or (p < ptrA[i + 1] and colA[p] < colB[q]))
+          p++;
+        else if (p == ptrA[i + 1] or colB[q] < colA[p])
+          q++;
+        else
+          p++, q++;
+        count++;
+      }
+      row_ptr[i + 1] = count;
+    }
+  });
+  std::partial_sum(row_ptr.begin(), row_ptr.end(), row_ptr.begin());
+
+  std::vector<size_t> col_ind(row_ptr.back());
+  std::vector<T> values(row_ptr.back());
+  const auto& valA = matrixA.values();
+  const auto& valB = matrixB.values();
+  sparse_parallel_rows(ptrA, 2, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      size_t p = ptrA[i], q = ptrB[i], out = row_ptr[i];
+      while (p < ptrA[i + 1] or q < ptrB[i + 1]) {
+        if (q == ptrB[i + 1] or (p < ptrA[i + 1] and colA[p] < colB[q])) {
+          col_ind[out] = colA[p];
+          values[out] = valA[p++];
+        } else if (p == ptrA[i + 1] or colB[q] < colA[p]) {
+          col_ind[out] = colB[q];
+          values[out] = sub ? T(0) - valB[q] : valB[q];
+          q++;
+        } else {
+          col_ind[out] = colA[p];
+          values[out] = sub ? valA[p] - valB[q] : valA[p] + valB[q];
+          p++, q++;
+        }
+        out++;
+      }
+    }
+  });
+  return CsrMatrix<T>(matrixA.rows(), matrixA.cols(), std::move(row_ptr),
+                      std::move(col_ind), std::move(values));
+}
+
+template <typename T>
+CsrMatrix<T> transpose(const CsrMatrix<T>& matrix) {
+  std::vector<size_t> row_ptr, col_ind;
+  std::vector<T> values;
+  sparse_transpose(matrix.rows(), matrix.cols(), matrix.row_ptr(),
+                   matrix.col_indices(), matrix.values(), row_ptr, col_ind,
+                   values);
+  return CsrMatrix<T>(matrix.cols(), matrix.rows(), std::move(row_ptr),
+                      std::move(col_ind), std::move(values));
+}
+
+template <typename T>
+T trace(const CsrMatrix<T>& matrix) {
+  if (matrix.rows() == 0) throw std::logic_error("Matrix is empty.");
+  if (matrix.rows() != matrix.cols())
+    throw std::logic_error("Matrix must be square.");
+
+  T res = 0;
+  for (size_t i = 0; i < matrix.rows(); i++) res += matrix(i, i);
+  return res;
+}
+
+}  // namespace algebra
+
+#endif  // AUT_AP_2024_Spring_HW1_SPARSE
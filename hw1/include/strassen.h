@@ -0,0 +1,233 @@
+#ifndef AUT_AP_2024_Spring_HW1_STRASSEN
+#define AUT_AP_2024_Spring_HW1_STRASSEN
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+#include "gemm.h"
+#include "view.h"
+
+namespace algebra {
+// Sub-products with a dimension at or below this size go to gemm_blocked()
+inline constexpr std::size_t STRASSEN_CROSSOVER = 256;
+
+// Settings of the Strassen-Winograd multiply.
+// crossover:     recursion stops once a dimension of the sub-problem is at or
+//                below this size and the classical kernel takes over;
+// scratch_bytes: memory the recursion may allocate for its temporaries; a
+//                level that does not fit is computed classically instead.
+struct StrassenOptions {
+  std::size_t crossover = STRASSEN_CROSSOVER;
+  std::size_t scratch_bytes = std::numeric_limits<std::size_t>::max();
+};
+
+// C = A * B with the Winograd form of Strassen's algorithm (7 products and
+// 15 additions per level, O(n^2.81)). Worth it for large square products;
+// the rounding error grows by a small constant factor per level compared
+// with multiply(). Odd dimensions are peeled off and done classically.
+template <typename T>
+Matrix<T> multiply_strassen(const Matrix<T>& matrixA, const Matrix<T>& matrixB,
+                            StrassenOptions options = {});
+
+template <typename T>
+MATRIX<T> multiply_strassen(const MATRIX<T>& matrixA, const MATRIX<T>& matrixB,
+                            StrassenOptions options = {});
+
+// Same on views; c receives the product and must not overlap a or b
+template <typename T>
+void strassen_winograd(MatrixView<T> a, MatrixView<T> b, MatrixSpan<T> c,
+                       StrassenOptions options = {});
+
+// Scratch memory the full recursion needs for an (m x k) * (k x n) product
+template <typename T>
+std::size_t strassen_scratch_bytes(std::size_t m, std::size_t k, std::size_t n,
+                                   std::size_t crossover = STRASSEN_CROSSOVER);
+
+// Building blocks of the recursion
+template <typename T>
+void strassen_gemm(MatrixView<T> a, MatrixView<T> b, MatrixSpan<T> c,
+                   bool accumulate);
+
+// out = x + y or x - y; out may be x or y
+template <typename T>
+void strassen_add(MatrixView<T> x, MatrixView<T> y, MatrixSpan<T> out,
+                  bool subtract);
+
+template <typename T>
+void strassen_recurse(MatrixView<T> a, MatrixView<T> b, MatrixSpan<T> c,
+                      std::size_t crossover, T* scratch,
+                      std::size_t scratch_size);
+
+////////////////////////////
+////// Implementation //////
+////////////////////////////
+
+template <typename T>
+void strassen_gemm(MatrixView<T> a, MatrixView<T> b, MatrixSpan<T> c,
+                   bool accumulate) {
+  if (!accumulate)
+    for (std::size_t i = 0; i < c.rows(); i++)
+      std::fill(c.row(i), c.row(i) + c.cols(), T(0));
+  gemm_blocked<T>(
+      a.rows(), b.cols(), a.cols(),
+      [&](std::size_t i, std::size_t p) { return a(i, p); },
+      [&](std::size_t p, std::size_t j) { return b(p, j); },
+      [&](std::size_t i, std::size_t j) -> T& { return c(i, j); });
+}
+
+template <typename T>
+void strassen_add(MatrixView<T> x, MatrixView<T> y, MatrixSpan<T> out,
+                  bool subtract) {
+  // every operand in the recursion has contiguous rows
+  parallel_for(out.rows(), parallel_row_grain(out.cols()),
+               [&](std::size_t begin, std::size_t end) {
+                 for (std::size_t i = begin; i < end; i++) {
+                   if (subtract)
+                     simd_sub(x.row(i), y.row(i), out.row(i), out.cols());
+                   else
+                     simd_add(x.row(i), y.row(i), out.row(i), out.cols());
+                 }
+               });
+}
+
+template <typename T>
+void strassen_recurse(MatrixView<T> a, MatrixView<T> b, MatrixSpan<T> c,
+                      std::size_t crossover, T* scratch,
+                      std::size_t scratch_size) {
+  const std::size_t m = a.rows(), k = a.cols(), n = b.cols();
+  const std::size_t m2 = m / 2, k2 = k / 2, n2 = n / 2;
+  const std::size_t level = m2 * k2 + k2 * n2 + m2 * n2;
+  if (std::min({m, k, n}) <= crossover or level > scratch_size) {
+    strassen_gemm(a, b, c, false);
+    return;
+  }
+
+  // X, Y and Z are this level's temporaries; deeper levels use the rest
+  MatrixSpan<T> X(scratch, m2, k2, k2);
+  MatrixSpan<T> Y(scratch + m2 * k2, k2, n2, n2);
+  MatrixSpan<T> Z(scratch + m2 * k2 + k2 * n2, m2, n2, n2);
+  T* rest = scratch + level;
+  const std::size_t rest_size = scratch_size - level;
+  auto product = [&](MatrixView<T> x, MatrixView<T> y, MatrixSpan<T> out) {
+    strassen_recurse(x, y, out, crossover, rest, rest_size);
+  };
+
+  const auto A11 = a.block(0, 0, m2, k2), A12 = a.block(0, k2, m2, k2);
+  const auto A21 = a.block(m2, 0, m2, k2), A22 = a.block(m2, k2, m2, k2);
+  const auto B11 = b.block(0, 0, k2, n2), B12 = b.block(0, n2, k2, n2);
+  const auto B21 = b.block(k2, 0, k2, n2), B22 = b.block(k2, n2, k2, n2);
+  const auto C11 = c.block(0, 0, m2, n2), C12 = c.block(0, n2, m2, n2);
+  const auto C21 = c.block(m2, 0, m2, n2), C22 = c.block(m2, n2, m2, n2);
+
+  // Winograd's schedule with three temporaries (Douglas et al., GEMMW);
+  // the quadrants of C hold the partial products in the meantime
+  strassen_add<T>(A11, A21, X, true);     // S3
+  strassen_add<T>(B22, B12, Y, true);     // T3
+  product(X, Y, C21);                     // M7 = S3 * T3
+  strassen_add<T>(A21, A22, X, false);    // S1
+  strassen_add<T>(B12, B11, Y, true);     // T1
+  product(X, Y, C22);                     // M5 = S1 * T1
+  strassen_add<T>(X, A11, X, true);       // S2 = S1 - A11
+  strassen_add<T>(B22, Y, Y, true);       // T2 = B22 - T1
+  product(X, Y, C12);                     // M6 = S2 * T2
+  strassen_add<T>(A12, X, X, true);       // S4 = A12 - S2
+  product(X, B22, C11);                   // M3 = S4 * B22
+  product(A11, B11, Z);                   // M1
+  strassen_add<T>(C12, Z, C12, false);    // U2 = M1 + M6
+  strassen_add<T>(C21, C12, C21, false);  // U3 = U2 + M7
+  strassen_add<T>(C12, C22, C12, false);  // U4 = U2 + M5
+  strassen_add<T>(C21, C22, C22, false);  // C22 = U3 + M5
+  strassen_add<T>(C12, C11, C12, false);  // C12 = U4 + M3
+  strassen_add<T>(Y, B21, Y, true);       // T4 = T2 - B21
+  product(A22, Y, C11);                   // M4 = A22 * T4
+  strassen_add<T>(C21, C11, C21, true);   // C21 = U3 - M4
+  product(A12, B21, C11);                 // M2
+  strassen_add<T>(C11, Z, C11, false);    // C11 = M1 + M2
+
+  // odd sizes: add the last column of A times the last row of B, then
+  // compute the last column and the last row of C classically
+  if (k % 2)
+    strassen_gemm(a.block(0, k - 1, 2 * m2, 1), b.block(k - 1, 0, 1, 2 * n2),
+                  c.block(0, 0, 2 * m2, 2 * n2), true);
+  if (n % 2)
+    strassen_gemm(a, b.col_range(n - 1, n), c.col_range(n - 1, n), false);
+  if (m % 2)
+    strassen_gemm(a.row_range(m - 1, m), b.col_range(0, 2 * n2),
+                  c.block(m - 1, 0, 1, 2 * n2), false);
+}
+
+template <typename T>
+std::size_t strassen_scratch_bytes(std::size_t m, std::size_t k, std::size_t n,
+                                   std::size_t crossover) {
+  std::size_t elements = 0;
+  while (std::min({m, k, n}) > crossover) {
+    m /= 2, k /= 2, n /= 2;
+    elements += m * k + k * n + m * n;
+  }
+  return elements * sizeof(T);
+}
+
+template <typename T>
+void strassen_winograd(MatrixView<T> a, MatrixView<T> b, MatrixSpan<T> c,
+                       StrassenOptions options) {
+  if (a.empty() or b.empty()) throw std::logic_error("Matrix is empty.");
+  if (a.cols() != b.rows() or c.rows() != a.rows() or c.cols() != b.cols())
+    throw std::logic_error("Matrix dimensions do not match.");
+
+  // rows of a strided view are not contiguous; work on a packed copy then
+  Matrix<T> packedA, packedB;
+  if (!a.contiguous_rows()) {
+    packedA = to_matrix(a);
+    a = view(packedA);
+  }
+  if (!b.contiguous_rows()) {
+    packedB = to_matrix(b);
+    b = view(packedB);
+  }
+
+  const std::size_t crossover = std::max<std::size_t>(options.crossover, 1);
+  const std::size_t size =
+      std::min(strassen_scratch_bytes<T>(a.rows(), a.cols(), b.cols(),
+                                         crossover),
+               options.scratch_bytes) /
+      sizeof(T);
+  std::unique_ptr<T[]> scratch(new T[size]);
+  if (c.contiguous_rows()) {
+    strassen_recurse(a, b, c, crossover, scratch.get(), size);
+  } else {
+    Matrix<T> res(c.rows(), c.cols());
+    strassen_recurse(a, b, span(res), crossover, scratch.get(), size);
+    copy(res, c);
+  }
+}
+
+template <typename T>
+Matrix<T> multiply_strassen(const Matrix<T>& matrixA, const Matrix<T>& matrixB,
+                            StrassenOptions options) {
+  if (matrixA.empty() or matrixB.empty()) {
+    throw std::logic_error("Matrix is empty.");
+  }
+  if (matrixA.cols() != matrixB.rows()) {
+    throw std::logic_error("Matrix dimensions do not match.");
+  }
+  Matrix<T> res(matrixA.rows(), matrixB.cols());
+  strassen_winograd<T>(view(matrixA), view(matrixB), span(res), options);
+  return res;
+}
+
+template <typename T>
+MATRIX<T> multiply_strassen(const MATRIX<T>& matrixA, const MATRIX<T>& matrixB,
+                            StrassenOptions options) {
+  if (matrixA.empty() or matrixB.empty()) {
+    throw std::logic_error("Matrix is empty.");
+  }
+  return multiply_strassen(to_matrix(matrixA), to_matrix(matrixB), options)
+      .to_legacy();
+}
+
+}  // namespace algebra
+
+#endif  // AUT_AP_2024_Spring_HW1_STRASSEN
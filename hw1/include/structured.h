@@ -0,0 +1,877 @@
+#ifndef AUT_AP_2024_Spring_HW1_STRUCTURED
+#define AUT_AP_2024_Spring_HW1_STRUCTURED
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "matrix.h"
+#include "simd.h"
+#include "thread_pool.h"
+
+namespace algebra {
+// Matrices with a known zero pattern, storing only the elements that may be
+// non-zero; products, solves and transposes only visit those elements.
+// DiagonalMatrix:   the n diagonal elements.
+// TriangularMatrix: the lower or upper triangle, packed row by row
+//                   (n * (n + 1) / 2 elements).
+// SymmetricMatrix:  the lower triangle packed row by row; (i, j) and (j, i)
+//                   are the same element.
+// BandMatrix:       `lower` diagonals below and `upper` above the main one,
+//                   lower + upper + 1 elements per row (the cells of the
+//                   first and last rows that fall outside the matrix are
+//                   kept at zero).
+// Diagonal, triangular and band matrices share a row interface: row i
+// stores the columns [row_begin(i), row_end(i)) contiguously at row(i).
+// Conversions from dense storage copy the stored positions and ignore the
+// rest of the matrix.
+enum class Triangle { Lower, Upper };
+
+template <typename M>
+concept row_structured = requires(const M& m, std::size_t i) {
+  typename M::value_type;
+  { m.row_begin(i) } -> std::convertible_to<std::size_t>;
+  { m.row_end(i) } -> std::convertible_to<std::size_t>;
+  { m.row(i) } -> std::convertible_to<const typename M::value_type*>;
+};
+
+template <typename T>
+class DiagonalMatrix {
+ public:
+  using value_type = T;
+
+  DiagonalMatrix() = default;
+  // n x n zero matrix
+  explicit DiagonalMatrix(std::size_t n);
+  explicit DiagonalMatrix(std::vector<T> diagonal);
+  explicit DiagonalMatrix(const MATRIX<T>& matrix);
+  explicit DiagonalMatrix(const Matrix<T>& matrix);
+
+  std::size_t rows() const { return diag_.size(); }
+  std::size_t cols() const { return diag_.size(); }
+  std::size_t nnz() const { return diag_.size(); }
+  const std::vector<T>& values() const { return diag_; }
+  std::vector<T>& values() { return diag_; }
+
+  std::size_t row_begin(std::size_t i) const { return i; }
+  std::size_t row_end(std::size_t i) const { return i + 1; }
+  const T* row(std::size_t i) const { return diag_.data() + i; }
+  T* row(std::size_t i) { return diag_.data() + i; }
+
+  // Element (i, j), zero if it is not stored
+  T operator()(std::size_t i, std::size_t j) const;
+  // Stored element (i, j); throws if it is not stored
+  T& at(std::size_t i, std::size_t j);
+
+  MATRIX<T> to_legacy() const;
+  Matrix<T> to_matrix() const;
+
+ private:
+  std::vector<T> diag_;
+};
+
+template <typename T>
+class TriangularMatrix {
+ public:
+  using value_type = T;
+
+  TriangularMatrix() = default;
+  explicit TriangularMatrix(std::size_t n,
+                            Triangle triangle = Triangle::Lower);
+  explicit TriangularMatrix(const MATRIX<T>& matrix,
+                            Triangle triangle = Triangle::Lower);
+  explicit TriangularMatrix(const Matrix<T>& matrix,
+                            Triangle triangle = Triangle::Lower);
+
+  std::size_t rows() const { return n_; }
+  std::size_t cols() const { return n_; }
+  std::size_t nnz() const { return values_.size(); }
+  Triangle triangle() const { return triangle_; }
+  const std::vector<T>& values() const { return values_; }
+  std::vector<T>& values() { return values_; }
+
+  std::size_t row_begin(std::size_t i) const {
+    return triangle_ == Triangle::Lower ? 0 : i;
+  }
+  std::size_t row_end(std::size_t i) const {
+    return triangle_ == Triangle::Lower ? i + 1 : n_;
+  }
+  const T* row(std::size_t i) const { return values_.data() + offset(i); }
+  T* row(std::size_t i) { return values_.data() + offset(i); }
+
+  T operator()(std::size_t i, std::size_t j) const;
+  T& at(std::size_t i, std::size_t j);
+
+  MATRIX<T> to_legacy() const;
+  Matrix<T> to_matrix() const;
+
+ private:
+  std::size_t n_ = 0;
+  Triangle triangle_ = Triangle::Lower;
+  std::vector<T> values_;
+
+  // Position of the first stored element of row i
+  std::size_t offset(std::size_t i) const {
+    return triangle_ == Triangle::Lower ? i * (i + 1) / 2
+                                        : i * (2 * n_ - i + 1) / 2;
+  }
+};
+
+template <typename T>
+class SymmetricMatrix {
+ public:
+  using value_type = T;
+
+  SymmetricMatrix() = default;
+  explicit SymmetricMatrix(std::size_t n);
+  // Only the lower triangle of the matrix is read
+  explicit SymmetricMatrix(const MATRIX<T>& matrix);
+  explicit SymmetricMatrix(const Matrix<T>& matrix);
+
+  std::size_t rows() const { return n_; }
+  std::size_t cols() const { return n_; }
+  std::size_t nnz() const { return values_.size(); }
+  const std::vector<T>& values() const { return values_; }
+  std::vector<T>& values() { return values_; }
+
+  // Columns [0, i] of row i
+  const T* lower_row(std::size_t i) const {
+    return values_.data() + i * (i + 1) / 2;
+  }
+  T* lower_row(std::size_t i) { return values_.data() + i * (i + 1) / 2; }
+
+  T operator()(std::size_t i, std::size_t j) const;
+  // (i, j) and (j, i) return the same element
+  T& at(std::size_t i, std::size_t j);
+
+  MATRIX<T> to_legacy() const;
+  Matrix<T> to_matrix() const;
+
+ private:
+  std::size_t n_ = 0;
+  std::vector<T> values_;
+};
+
+template <typename T>
+class BandMatrix {
+ public:
+  using value_type = T;
+
+  BandMatrix() = default;
+  // Bandwidths beyond the matrix are clamped to it
+  BandMatrix(std::size_t rows, std::size_t cols, std::size_t lower,
+             std::size_t upper);
+  BandMatrix(const MATRIX<T>& matrix, std::size_t lower, std::size_t upper);
+  BandMatrix(const Matrix<T>& matrix, std::size_t lower, std::size_t upper);
+
+  std::size_t rows() const { return rows_; }
+  std::size_t cols() const { return cols_; }
+  std::size_t lower_bandwidth() const { return lower_; }
+  std::size_t upper_bandwidth() const { return upper_; }
+  std::size_t nnz() const { return values_.size(); }
+  const std::vector<T>& values() const { return values_; }
+  std::vector<T>& values() { return values_; }
+
+  std::size_t row_begin(std::size_t i) const {
+    return std::min(i > lower_ ? i - lower_ : 0, cols_);
+  }
+  std::size_t row_end(std::size_t i) const {
+    return std::min(cols_, i + upper_ + 1);
+  }
+  const T* row(std::size_t i) const { return values_.data() + offset(i); }
+  T* row(std::size_t i) { return values_.data() + offset(i); }
+
+  T operator()(std::size_t i, std::size_t j) const;
+  T& at(std::size_t i, std::size_t j);
+
+  MATRIX<T> to_legacy() const;
+  Matrix<T> to_matrix() const;
+
+ private:
+  std::size_t rows_ = 0;
+  std::size_t cols_ = 0;
+  std::size_t lower_ = 0;
+  std::size_t upper_ = 0;
+  std::vector<T> values_;
+
+  std::size_t offset(std::size_t i) const;
+};
+
+// Size of a legacy matrix; all of its rows must have the same length
+template <typename T>
+std::pair<std::size_t, std::size_t> structured_legacy_size(
+    const MATRIX<T>& matrix);
+
+// Size of a square dense matrix converted to structured storage
+template <typename M>
+std::size_t structured_square_size(const M& matrix);
+
+template <typename T>
+std::size_t structured_square_size(const MATRIX<T>& matrix);
+
+// Fill the stored elements of `m` with element(i, j), rows in parallel
+template <row_structured S, typename F>
+void structured_gather(S& m, F&& element);
+
+// Write the stored elements into zero-initialized dense rows; row(i)
+// returns the start of row i
+template <row_structured S, typename Row>
+void structured_scatter(const S& m, Row&& row);
+
+// C = A * B for a dense k x n B given by rows: b(k) and c(i) return the
+// start of row k of B and of row i of the zero-initialized C. Row i of C
+// sums a(i, k) * B[k] over the stored k only.
+template <row_structured S, typename BRow, typename CRow>
+void structured_multiply_rows(const S& a, std::size_t n, BRow&& b,
+                              CRow&& c);
+
+// Same for symmetric A: row i of C is the packed row i of A against rows
+// 0..i of B, plus column i of the lower triangle (the rest of row i of A)
+// against the remaining rows
+template <typename T, typename BRow, typename CRow>
+void symmetric_multiply_rows(const SymmetricMatrix<T>& a, std::size_t n,
+                             BRow&& b, CRow&& c);
+
+// C = A * B for structured B; the stored rows of C must cover the columns
+// of every product a(i, k) * B[k]
+template <row_structured S, row_structured U, row_structured V>
+void structured_product_rows(const S& a, const U& b, V& c);
+
+template <row_structured S>
+std::pair<size_t, size_t> matrix_size(const S& matrix);
+
+template <typename T>
+std::pair<size_t, size_t> matrix_size(const SymmetricMatrix<T>& matrix);
+
+// Structured x dense
+template <row_structured S>
+Matrix<typename S::value_type> multiply(
+    const S& matrixA, const Matrix<typename S::value_type>& matrixB);
+
+template <row_structured S>
+MATRIX<typename S::value_type> multiply(
+    const S& matrixA, const MATRIX<typename S::value_type>& matrixB);
+
+template <typename T>
+Matrix<T> multiply(const SymmetricMatrix<T>& matrixA,
+                   const Matrix<T>& matrixB);
+
+template <typename T>
+MATRIX<T> multiply(const SymmetricMatrix<T>& matrixA,
+                   const MATRIX<T>& matrixB);
+
+// Products that keep the structure: bandwidths add up, triangles must be
+// the same
+template <typename T>
+DiagonalMatrix<T> multiply(const DiagonalMatrix<T>& matrixA,
+                           const DiagonalMatrix<T>& matrixB);
+
+template <typename T>
+TriangularMatrix<T> multiply(const TriangularMatrix<T>& matrixA,
+                             const TriangularMatrix<T>& matrixB);
+
+template <typename T>
+BandMatrix<T> multiply(const BandMatrix<T>& matrixA,
+                       const BandMatrix<T>& matrixB);
+
+// The transpose of a lower triangular matrix is upper triangular and the
+// bandwidths of a band matrix swap
+template <typename T>
+DiagonalMatrix<T> transpose(const DiagonalMatrix<T>& matrix);
+
+template <typename T>
+TriangularMatrix<T> transpose(const TriangularMatrix<T>& matrix);
+
+template <typename T>
+SymmetricMatrix<T> transpose(const SymmetricMatrix<T>& matrix);
+
+template <typename T>
+BandMatrix<T> transpose(const BandMatrix<T>& matrix);
+
+template <row_structured S>
+typename S::value_type trace(const S& matrix);
+
+template <typename T>
+T trace(const SymmetricMatrix<T>& matrix);
+
+// X with A * X = B by forward or back substitution, for a diagonal,
+// triangular or triangular band A (lower or upper bandwidth 0). Columns of
+// B are split over the thread pool. Throws if A is singular.
+template <row_structured S>
+  requires std::floating_point<typename S::value_type>
+Matrix<typename S::value_type> solve(
+    const S& matrixA, const Matrix<typename S::value_type>& matrixB);
+
+////////////////////////////
+////// Implementation //////
+////////////////////////////
+
+template <typename T>
+std::pair<std::size_t, std::size_t> structured_legacy_size(
+    const MATRIX<T>& matrix) {
+  const auto size = matrix_size(matrix);
+  for (const auto& row : matrix) {
+    if (row.size() != size.second) {
+      throw std::logic_error("All rows must have the same length.");
+    }
+  }
+  return size;
+}
+
+template <typename M>
+std::size_t structured_square_size(const M& matrix) {
+  const auto [rows, cols] = matrix_size(matrix);
+  if (rows != cols) throw std::logic_error("Matrix must be square.");
+  return rows;
+}
+
+template <typename T>
+std::size_t structured_square_size(const MATRIX<T>& matrix) {
+  const auto [rows, cols] = structured_legacy_size(matrix);
+  if (rows != cols) throw std::logic_error("Matrix must be square.");
+  return rows;
+}
+
+
+template <row_structured S, typename F>
+void structured_gather(S& m, F&& element) {
+  if (m.rows() == 0) return;
+  const std::size_t width = std::max<std::size_t>(m.nnz() / m.rows(), 1);
+  parallel_for(m.rows(), parallel_row_grain(width),
+               [&](std::size_t begin, std::size_t end) {
+                 for (std::size_t i = begin; i < end; i++) {
+                   const std::size_t first = m.row_begin(i);
+                   auto* r = m.row(i);
+                   for (std::size_t j = first; j < m.row_end(i); j++)
+                     r[j - first] = element(i, j);
+                 }
+               });
+}
+
+template <row_structured S, typename Row>
+void structured_scatter(const S& m, Row&& row) {
+  if (m.rows() == 0) return;
+  const std::size_t width = std::max<std::size_t>(m.nnz() / m.rows(), 1);
+  parallel_for(m.rows(), parallel_row_grain(width),
+               [&](std::size_t begin, std::size_t end) {
+                 for (std::size_t i = begin; i < end; i++) {
+                   const std::size_t first = m.row_begin(i);
+                   std::copy(m.row(i), m.row(i) + (m.row_end(i) - first),
+                             row(i) + first);
+                 }
+               });
+}
+
+template <row_structured S, typename BRow, typename CRow>
+void structured_multiply_rows(const S& a, std::size_t n, BRow&& b,
+                              CRow&& c) {
+  using T = typename S::value_type;
+  const std::size_t width = std::max<std::size_t>(a.nnz() / a.rows(), 1);
+  parallel_for(a.rows(), parallel_row_grain(width * n),
+               [&](std::size_t begin, std::size_t end) {
+                 for (std::size_t i = begin; i < end; i++) {
+                   const std::size_t first = a.row_begin(i);
+                   const T* r = a.row(i);
+                   T* ci = c(i);
+                   if constexpr (std::same_as<S, DiagonalMatrix<T>>) {
+                     simd_scale(b(i), r[0], ci, n);
+                   } else {
+                     for (std::size_t k = first; k < a.row_end(i); k++)
+                       simd_axpy(r[k - first], b(k), ci, n);
+                   }
+                 }
+               });
+}
+
+template <row_structured S, row_structured U, row_structured V>
+void structured_product_rows(const S& a, const U& b, V& c) {
+  using T = typename S::value_type;
+  const std::size_t width = std::max<std::size_t>(a.nnz() / a.rows(), 1) *
+                            std::max<std::size_t>(b.nnz() / b.rows(), 1);
+  parallel_for(a.rows(), parallel_row_grain(width),
+               [&](std::size_t begin, std::size_t end) {
+                 for (std::size_t i = begin; i < end; i++) {
+                   const std::size_t first = a.row_begin(i);
+                   const T* r = a.row(i);
+                   const std::size_t c0 = c.row_begin(i);
+                   for (std::size_t k = first; k < a.row_end(i); k++) {
+                     const std::size_t j0 = b.row_begin(k);
+                     simd_axpy(r[k - first], b.row(k), c.row(i) + (j0 - c0),
+                               b.row_end(k) - j0);
+                   }
+                 }
+               });
+}
+
+// DiagonalMatrix
+
+template <typename T>
+DiagonalMatrix<T>::DiagonalMatrix(std::size_t n) : diag_(n, T(0)) {}
+
+template <typename T>
+DiagonalMatrix<T>::DiagonalMatrix(std::vector<T> diagonal)
+    : diag_(std::move(diagonal)) {}
+
+template <typename T>
+DiagonalMatrix<T>::DiagonalMatrix(const MATRIX<T>& matrix)
+    : DiagonalMatrix(structured_square_size(matrix)) {
+  for (std::size_t i = 0; i < diag_.size(); i++) diag_[i] = matrix[i][i];
+}
+
+template <typename T>
+DiagonalMatrix<T>::DiagonalMatrix(const Matrix<T>& matrix)
+    : DiagonalMatrix(structured_square_size(matrix)) {
+  for (std::size_t i = 0; i < diag_.size(); i++) diag_[i] = matrix(i, i);
+}
+
+template <typename T>
+T DiagonalMatrix<T>::operator()(std::size_t i, std::size_t j) const {
+  return i == j ? diag_[i] : T(0);
+}
+
+template <typename T>
+T& DiagonalMatrix<T>::at(std::size_t i, std::size_t j) {
+  if (i >= rows() or j >= cols())
+    throw std::out_of_range("The element is outside of the matrix.");
+  if (i != j) throw std::out_of_range("The element is not stored.");
+  return diag_[i];
+}
+
+template <typename T>
+MATRIX<T> DiagonalMatrix<T>::to_legacy() const {
+  MATRIX<T> res(rows(), std::vector<T>(cols(), T(0)));
+  structured_scatter(*this, [&](std::size_t i) { return res[i].data(); });
+  return res;
+}
+
+template <typename T>
+Matrix<T> DiagonalMatrix<T>::to_matrix() const {
+  Matrix<T> res(rows(), cols());
+  structured_scatter(*this, [&](std::size_t i) { return res.row(i); });
+  return res;
+}
+
+// TriangularMatrix
+
+template <typename T>
+TriangularMatrix<T>::TriangularMatrix(std::size_t n, Triangle triangle)
+    : n_(n), triangle_(triangle), values_(n * (n + 1) / 2, T(0)) {}
+
+template <typename T>
+TriangularMatrix<T>::TriangularMatrix(const MATRIX<T>& matrix,
+                                      Triangle triangle)
+    : TriangularMatrix(structured_square_size(matrix), triangle) {
+  structured_gather(*this, [&](std::size_t i, std::size_t j) {
+    return matrix[i][j];
+  });
+}
+
+template <typename T>
+TriangularMatrix<T>::TriangularMatrix(const Matrix<T>& matrix,
+                                      Triangle triangle)
+    : TriangularMatrix(structured_square_size(matrix), triangle) {
+  structured_gather(*this,
+                    [&](std::size_t i, std::size_t j) { return matrix(i, j); });
+}
+
+template <typename T>
+T TriangularMatrix<T>::operator()(std::size_t i, std::size_t j) const {
+  return row_begin(i) <= j and j < row_end(i) ? row(i)[j - row_begin(i)]
+                                              : T(0);
+}
+
+template <typename T>
+T& TriangularMatrix<T>::at(std::size_t i, std::size_t j) {
+  if (i >= n_ or j >= n_)
+    throw std::out_of_range("The element is outside of the matrix.");
+  if (j < row_begin(i) or j >= row_end(i))
+    throw std::out_of_range("The element is not stored.");
+  return row(i)[j - row_begin(i)];
+}
+
+template <typename T>
+MATRIX<T> TriangularMatrix<T>::to_legacy() const {
+  MATRIX<T> res(n_, std::vector<T>(n_, T(0)));
+  structured_scatter(*this, [&](std::size_t i) { return res[i].data(); });
+  return res;
+}
+
+template <typename T>
+Matrix<T> TriangularMatrix<T>::to_matrix() const {
+  Matrix<T> res(n_, n_);
+  structured_scatter(*this, [&](std::size_t i) { return res.row(i); });
+  return res;
+}
+
+// SymmetricMatrix
+
+template <typename T>
+SymmetricMatrix<T>::SymmetricMatrix(std::size_t n)
+    : n_(n), values_(n * (n + 1) / 2, T(0)) {}
+
+template <typename T>
+SymmetricMatrix<T>::SymmetricMatrix(const MATRIX<T>& matrix)
+    : SymmetricMatrix(structured_square_size(matrix)) {
+  for (std::size_t i = 0; i < n_; i++)
+    std::copy_n(matrix[i].begin(), i + 1, lower_row(i));
+}
+
+template <typename T>
+SymmetricMatrix<T>::SymmetricMatrix(const Matrix<T>& matrix)
+    : SymmetricMatrix(structured_square_size(matrix)) {
+  for (std::size_t i = 0; i < n_; i++)
+    std::copy_n(matrix.row(i), i + 1, lower_row(i));
+}
+
+template <typename T>
+T SymmetricMatrix<T>::operator()(std::size_t i, std::size_t j) const {
+  return i >= j ? lower_row(i)[j] : lower_row(j)[i];
+}
+
+template <typename T>
+T& SymmetricMatrix<T>::at(std::size_t i, std::size_t j) {
+  if (i >= n_ or j >= n_)
+    throw std::out_of_range("The element is outside of the matrix.");
+  return i >= j ? lower_row(i)[j] : lower_row(j)[i];
+}
+
+template <typename T>
+MATRIX<T> SymmetricMatrix<T>::to_legacy() const {
+  MATRIX<T> res(n_, std::vector<T>(n_));
+  for (std::size_t i = 0; i < n_; i++)
+    for (std::size_t j = 0; j <= i; j++)
+      res[i][j] = res[j][i] = lower_row(i)[j];
+  return res;
+}
+
+template <typename T>
+Matrix<T> SymmetricMatrix<T>::to_matrix() const {
+  Matrix<T> res(n_, n_);
+  for (std::size_t i = 0; i < n_; i++)
+    for (std::size_t j = 0; j <= i; j++)
+      res(i, j) = res(j, i) = lower_row(i)[j];
+  return res;
+}
+
+// BandMatrix
+
+template <typename T>
+BandMatrix<T>::BandMatrix(std::size_t rows, std::size_t cols,
+                          std::size_t lower, std::size_t upper)
+    : rows_(rows),
+      cols_(cols),
+      lower_(std::min(lower, rows > 0 ? rows - 1 : 0)),
+      upper_(std::min(upper, cols > 0 ? cols - 1 : 0)),
+      values_(rows * (lower_ + upper_ + 1), T(0)) {}
+
+template <typename T>
+BandMatrix<T>::BandMatrix(const MATRIX<T>& matrix, std::size_t lower,
+                          std::size_t upper)
+    : BandMatrix(structured_legacy_size(matrix).first,
+                 matrix_size(matrix).second, lower, upper) {
+  structured_gather(*this, [&](std::size_t i, std::size_t j) {
+    return matrix[i][j];
+  });
+}
+
+template <typename T>
+BandMatrix<T>::BandMatrix(const Matrix<T>& matrix, std::size_t lower,
+                          std::size_t upper)
+    : BandMatrix(matrix.rows(), matrix.cols(), lower, upper) {
+  structured_gather(*this,
+                    [&](std::size_t i, std::size_t j) { return matrix(i, j); });
+}
+
+template <typename T>
+std::size_t BandMatrix<T>::offset(std::size_t i) const {
+  // (i, j) is kept at i * width + j + lower - i; an empty row points at the
+  // start of its storage
+  const std::size_t first = row_begin(i);
+  const std::size_t width = lower_ + upper_ + 1;
+  return first + lower_ >= i ? i * width + first + lower_ - i : i * width;
+}
+
+template <typename T>
+T BandMatrix<T>::operator()(std::size_t i, std::size_t j) const {
+  return row_begin(i) <= j and j < row_end(i) ? row(i)[j - row_begin(i)]
+                                              : T(0);
+}
+
+template <typename T>
+T& BandMatrix<T>::at(std::size_t i, std::size_t j) {
+  if (i >= rows_ or j >= cols_)
+    throw std::out_of_range("The element is outside of the matrix.");
+  if (j < row_begin(i) or j >= row_end(i))
+    throw std::out_of_range("The element is not stored.");
+  return row(i)[j - row_begin(i)];
+}
+
+template <typename T>
+MATRIX<T> BandMatrix<T>::to_legacy() const {
+  MATRIX<T> res(rows_, std::vector<T>(cols_, T(0)));
+  structured_scatter(*this, [&](std::size_t i) { return res[i].data(); });
+  return res;
+}
+
+template <typename T>
+Matrix<T> BandMatrix<T>::to_matrix() const {
+  Matrix<T> res(rows_, cols_);
+  structured_scatter(*this, [&](std::size_t i) { return res.row(i); });
+  return res;
+}
+
+// Operations
+
+template <row_structured S>
+std::pair<size_t, size_t> matrix_size(const S& matrix) {
+  return std::make_pair(matrix.rows(), matrix.cols());
+}
+
+template <typename T>
+std::pair<size_t, size_t> matrix_size(const SymmetricMatrix<T>& matrix) {
+  return std::make_pair(matrix.rows(), matrix.cols());
+}
+
+template <row_structured S>
+Matrix<typename S::value_type> multiply(
+    const S& matrixA, const Matrix<typename S::value_type>& matrixB) {
+  using T = typename S::value_type;
+  if (matrixA.rows() == 0 or matrixB.empty()) {
+    throw std::logic_error("Matrix is empty.");
+  }
+  if (matrixA.cols() != matrixB.rows()) {
+    throw std::logic_error("Matrix dimensions do not match.");
+  }
+
+  Matrix<T> res(matrixA.rows(), matrixB.cols());
+  structured_multiply_rows(
+      matrixA, matrixB.cols(), [&](size_t k) { return matrixB.row(k); },
+      [&](size_t i) { return res.row(i); });
+  return res;
+}
+
+template <row_structured S>
+MATRIX<typename S::value_type> multiply(
+    const S& matrixA, const MATRIX<typename S::value_type>& matrixB) {
+  using T = typename S::value_type;
+  const auto sizeB = structured_legacy_size(matrixB);
+  if (matrixA.rows() == 0 or sizeB.first == 0 or sizeB.second == 0) {
+    throw std::logic_error("Matrix is empty.");
+  }
+  if (matrixA.cols() != sizeB.first) {
+    throw std::logic_error("Matrix dimensions do not match.");
+  }
+
+  MATRIX<T> res(matrixA.rows(), std::vector<T>(sizeB.second, T(0)));
+  structured_multiply_rows(
+      matrixA, sizeB.second, [&](size_t k) { return matrixB[k].data(); },
+      [&](size_t i) { return res[i].data(); });
+  return res;
+}
+
+template <typename T, typename BRow, typename CRow>
+void symmetric_multiply_rows(const SymmetricMatrix<T>& a, std::size_t n,
+                             BRow&& b, CRow&& c) {
+  parallel_for(a.rows(), parallel_row_grain(a.rows() * n),
+               [&](std::size_t begin, std::size_t end) {
+                 for (std::size_t i = begin; i < end; i++) {
+                   const T* r = a.lower_row(i);
+                   T* ci = c(i);
+                   for (std::size_t k = 0; k <= i; k++)
+                     simd_axpy(r[k], b(k), ci, n);
+                   for (std::size_t k = i + 1; k < a.rows(); k++)
+                     simd_axpy(a.lower_row(k)[i], b(k), ci, n);
+                 }
+               });
+}
+
+template <typename T>
+Matrix<T> multiply(const SymmetricMatrix<T>& matrixA,
+                   const Matrix<T>& matrixB) {
+  if (matrixA.rows() == 0 or matrixB.empty()) {
+    throw std::logic_error("Matrix is empty.");
+  }
+  if (matrixA.cols() != matrixB.rows()) {
+    throw std::logic_error("Matrix dimensions do not match.");
+  }
+
+  Matrix<T> res(matrixA.rows(), matrixB.cols());
+  symmetric_multiply_rows(
+      matrixA, matrixB.cols(), [&](size_t k) { return matrixB.row(k); },
+      [&](size_t i) { return res.row(i); });
+  return res;
+}
+
+template <typename T>
+MATRIX<T> multiply(const SymmetricMatrix<T>& matrixA,
+                   const MATRIX<T>& matrixB) {
+  const auto sizeB = structured_legacy_size(matrixB);
+  if (matrixA.rows() == 0 or sizeB.first == 0 or sizeB.second == 0) {
+    throw std::logic_error("Matrix is empty.");
+  }
+  if (matrixA.cols() != sizeB.first) {
+    throw std::logic_error("Matrix dimensions do not match.");
+  }
+
+  MATRIX<T> res(matrixA.rows(), std::vector<T>(sizeB.second, T(0)));
+  symmetric_multiply_rows(
+      matrixA, sizeB.second, [&](size_t k) { return matrixB[k].data(); },
+      [&](size_t i) { return res[i].data(); });
+  return res;
+}
+
+template <typename T>
+DiagonalMatrix<T> multiply(const DiagonalMatrix<T>& matrixA,
+                           const DiagonalMatrix<T>& matrixB) {
+  if (matrixA.rows() == 0 or matrixB.rows() == 0) {
+    throw std::logic_error("Matrix is empty.");
+  }
+  if (matrixA.cols() != matrixB.rows()) {
+    throw std::logic_error("Matrix dimensions do not match.");
+  }
+
+  DiagonalMatrix<T> res(matrixA.rows());
+  simd_mul(matrixA.values().data(), matrixB.values().data(),
+           res.values().data(), res.nnz());
+  return res;
+}
+
+template <typename T>
+TriangularMatrix<T> multiply(const TriangularMatrix<T>& matrixA,
+                             const TriangularMatrix<T>& matrixB) {
+  if (matrixA.rows() == 0 or matrixB.rows() == 0) {
+    throw std::logic_error("Matrix is empty.");
+  }
+  if (matrixA.cols() != matrixB.rows()) {
+    throw std::logic_error("Matrix dimensions do not match.");
+  }
+  if (matrixA.triangle() != matrixB.triangle()) {
+    throw std::logic_error("Matrix triangles do not match.");
+  }
+
+  TriangularMatrix<T> res(matrixA.rows(), matrixA.triangle());
+  structured_product_rows(matrixA, matrixB, res);
+  return res;
+}
+
+template <typename T>
+BandMatrix<T> multiply(const BandMatrix<T>& matrixA,
+                       const BandMatrix<T>& matrixB) {
+  if (matrixA.rows() == 0 or matrixB.rows() == 0) {
+    throw std::logic_error("Matrix is empty.");
+  }
+  if (matrixA.cols() != matrixB.rows()) {
+    throw std::logic_error("Matrix dimensions do not match.");
+  }
+
+  BandMatrix<T> res(matrixA.rows(), matrixB.cols(),
+                    matrixA.lower_bandwidth() + matrixB.lower_bandwidth(),
+                    matrixA.upper_bandwidth() + matrixB.upper_bandwidth());
+  structured_product_rows(matrixA, matrixB, res);
+  return res;
+}
+
+template <typename T>
+DiagonalMatrix<T> transpose(const DiagonalMatrix<T>& matrix) {
+  return matrix;
+}
+
+template <typename T>
+TriangularMatrix<T> transpose(const TriangularMatrix<T>& matrix) {
+  TriangularMatrix<T> res(matrix.rows(), matrix.triangle() == Triangle::Lower
+                                             ? Triangle::Upper
+                                             : Triangle::Lower);
+  structured_gather(res, [&](std::size_t i, std::size_t j) {
+    return matrix(j, i);
+  });
+  return res;
+}
+
+template <typename T>
+SymmetricMatrix<T> transpose(const SymmetricMatrix<T>& matrix) {
+  return matrix;
+}
+
+template <typename T>
+BandMatrix<T> transpose(const BandMatrix<T>& matrix) {
+  BandMatrix<T> res(matrix.cols(), matrix.rows(), matrix.upper_bandwidth(),
+                    matrix.lower_bandwidth());
+  structured_gather(res, [&](std::size_t i, std::size_t j) {
+    return matrix(j, i);
+  });
+  return res;
+}
+
+template <row_structured S>
+typename S::value_type trace(const S& matrix) {
+  using T = typename S::value_type;
+  if (matrix.rows() == 0) throw std::logic_error("Matrix is empty.");
+  if (matrix.rows() != matrix.cols())
+    throw std::logic_error("Matrix must be square.");
+
+  T res = 0;
+  for (size_t i = 0; i < matrix.rows(); i++)
+    res += matrix.row(i)[i - matrix.row_begin(i)];
+  return res;
+}
+
+template <typename T>
+T trace(const SymmetricMatrix<T>& matrix) {
+  if (matrix.rows() == 0) throw std::logic_error("Matrix is empty.");
+
+  T res = 0;
+  for (size_t i = 0; i < matrix.rows(); i++) res += matrix.lower_row(i)[i];
+  return res;
+}
+
+template <row_structured S>
+  requires std::floating_point<typename S::value_type>
+Matrix<typename S::value_type> solve(
+    const S& matrixA, const Matrix<typename S::value_type>& matrixB) {
+  using T = typename S::value_type;
+  const std::size_t n = matrixA.rows();
+  if (n == 0 or matrixB.empty()) throw std::logic_error("Matrix is empty.");
+  if (n != matrixA.cols()) throw std::logic_error("Matrix must be square.");
+  if (n != matrixB.rows()) {
+    throw std::logic_error("Matrix dimensions do not match.");
+  }
+  // lower: every row ends on the diagonal, upper: every row starts there
+  bool lower = true, upper = true;
+  for (std::size_t i = 0; i < n; i++) {
+    lower = lower and matrixA.row_end(i) == i + 1;
+    upper = upper and matrixA.row_begin(i) == i;
+    if (matrixA.row_begin(i) > i or matrixA.row_end(i) <= i or
+        matrixA.row(i)[i - matrixA.row_begin(i)] == T(0))
+      throw std::logic_error("Matrix is singular.");
+  }
+  if (!lower and !upper) throw std::logic_error("Matrix must be triangular.");
+
+  // every task substitutes a band of columns through all the rows; bands
+  // start on whole vectors so the thread count cannot change the result
+  Matrix<T> res = matrixB;
+  const std::size_t m = res.cols();
+  parallel_for_aligned(
+      m, std::max<std::size_t>(parallel_row_grain(matrixA.nnz()), 16),
+      std::max<std::size_t>(1, MATRIX_ALIGNMENT / sizeof(T)),
+      [&](std::size_t begin, std::size_t end) {
+        for (std::size_t step = 0; step < n; step++) {
+          const std::size_t i = lower ? step : n - 1 - step;
+          const std::size_t first = matrixA.row_begin(i);
+          const T* r = matrixA.row(i);
+          T* xi = res.row(i) + begin;
+          for (std::size_t k = first; k < matrixA.row_end(i); k++)
+            if (k != i) simd_axpy(-r[k - first], res.row(k) + begin, xi,
+                                  end - begin);
+          const T d = r[i - first];
+          for (std::size_t j = 0; j < end - begin; j++) xi[j] /= d;
+        }
+      });
+  return res;
+}
+
+}  // namespace algebra
+
+#endif  // AUT_AP_2024_Spring_HW1_STRUCTURED
@@ -0,0 +1,141 @@
+#ifndef AUT_AP_2024_Spring_HW1_THREAD_POOL
+#define AUT_AP_2024_Spring_HW1_THREAD_POOL
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "tune.h"
+
+namespace algebra {
+// Element-wise operations on fewer elements than this stay on one thread
+inline constexpr std::size_t PARALLEL_MIN_ELEMENTS = 1 << 16;
+
+// Persistent pool of worker threads with one deque per thread.
+// Workers pop from the back of their own deque and steal from the front of
+// the others; the thread that calls parallel_for() works as thread 0.
+class ThreadPool {
+ public:
+  // Total number of threads, counting the calling thread
+  explicit ThreadPool(std::size_t num_threads);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  std::size_t num_threads() const { return queues_.size(); }
+
+  // Run body(i) for every i in [0, count) and wait for all of them.
+  // The first exception thrown by a task is rethrown here. Calls made from
+  // inside a task run inline, so nested parallel loops cannot deadlock.
+  void parallel_for(std::size_t count,
+                    const std::function<void(std::size_t)>& body);
+
+ private:
+  using Task = std::function<void()>;
+
+  struct WorkQueue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  std::vector<std::unique_ptr<WorkQueue>> queues_;
+  std::vector<std::thread> workers_;
+
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_;
+  std::size_t queued_ = 0;  // guarded by sleep_mutex_
+  bool stop_ = false;       // guarded by sleep_mutex_
+
+  void push(std::size_t queue, Task task);
+  // Pop from our own deque or steal from another one and run the task
+  bool run_one(std::size_t self);
+  void worker_loop(std::size_t self);
+};
+
+// Process-wide pool shared by the algebra routines. Holding the pointer
+// keeps that pool alive even if set_num_threads() replaces it meanwhile.
+std::shared_ptr<ThreadPool> thread_pool();
+
+// Number of threads used by the algebra routines (0 = hardware concurrency).
+// 1 makes every routine sequential.
+// Safe to call while other threads run algebra routines: loops already
+// running finish on the pool they started on, which is destroyed once the
+// last of them returns; later loops use the new pool. Throws
+// std::logic_error when called from inside a pool task.
+void set_num_threads(std::size_t num_threads);
+std::size_t get_num_threads();
+
+// Split [0, count) into chunks of at least `grain` indices and run
+// body(begin, end) for each of them on the shared pool.
+template <typename F>
+void parallel_for(std::size_t count, std::size_t grain, F&& body);
+
+// parallel_for() whose chunks all start on a multiple of `align`, so that
+// vector kernels split a range into the same lanes for any thread count
+template <typename F>
+void parallel_for_aligned(std::size_t count, std::size_t grain,
+                          std::size_t align, F&& body);
+
+// PARALLEL_MIN_ELEMENTS, or the cutoff tune() measured on this host
+inline std::size_t parallel_min_elements();
+
+// Rows per task so that each task touches at least parallel_min_elements()
+// elements; smaller matrices therefore run on the calling thread
+inline std::size_t parallel_row_grain(std::size_t columns);
+
+////////////////////////////
+////// Implementation //////
+////////////////////////////
+
+template <typename F>
+void parallel_for(std::size_t count, std::size_t grain, F&& body) {
+  grain = std::max<std::size_t>(grain, 1);
+  const std::size_t threads = get_num_threads();
+  if (threads <= 1 or count <= grain) {
+    if (count > 0) body(std::size_t{0}, count);
+    return;
+  }
+  // a few chunks per thread so stealing can even out the load
+  const std::size_t chunks =
+      std::min((count + grain - 1) / grain, threads * 4);
+  const std::size_t chunk = (count + chunks - 1) / chunks;
+  // the pointer keeps the pool alive for the whole loop
+  const std::shared_ptr<ThreadPool> pool = thread_pool();
+  pool->parallel_for(chunks, [&](std::size_t c) {
+    const std::size_t begin = c * chunk;
+    const std::size_t end = std::min(count, begin + chunk);
+    if (begin < end) body(begin, end);
+  });
+}
+
+template <typename F>
+void parallel_for_aligned(std::size_t count, std::size_t grain,
+                          std::size_t align, F&& body) {
+  align = std::max<std::size_t>(align, 1);
+  parallel_for((count + align - 1) / align, (grain + align - 1) / align,
+               [&](std::size_t begin, std::size_t end) {
+                 body(begin * align, std::min(count, end * align));
+               });
+}
+
+inline std::size_t parallel_min_elements() {
+  const std::size_t tuned = tuning().parallel_min_elements;
+  return tuned != 0 ? tuned : PARALLEL_MIN_ELEMENTS;
+}
+
+inline std::size_t parallel_row_grain(std::size_t columns) {
+  return std::max<std::size_t>(
+      1, parallel_min_elements() / std::max<std::size_t>(columns, 1));
+}
+
+}  // namespace algebra
+
+#endif  // AUT_AP_2024_Spring_HW1_THREAD_POOL
@@ -0,0 +1,156 @@
+#ifndef AUT_AP_2024_Spring_HW1_TRANSPOSE
+#define AUT_AP_2024_Spring_HW1_TRANSPOSE
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "simd.h"
+#include "thread_pool.h"
+#include "tune.h"
+
+namespace algebra {
+// Blocks of at most this many bytes are transposed directly; larger ones
+// are halved first, so the source and destination of a leaf share L1
+inline constexpr std::size_t TRANSPOSE_LEAF_BYTES = 16 * 1024;
+
+// Edge of the tiles the in-place square transpose swaps
+inline constexpr std::size_t TRANSPOSE_TILE = 64;
+
+// TRANSPOSE_LEAF_BYTES, or the leaf size tune() measured on this host
+inline std::size_t transpose_leaf_bytes();
+
+// dst (cols x rows) = src (rows x cols)^T for row-major storage whose rows
+// are `src_stride` and `dst_stride` elements apart.
+// Bands of destination rows are spread over the thread pool; inside a band
+// the block is halved along its longer side until it fits a leaf
+// (cache-oblivious), and leaves go through simd_transpose(). The two
+// buffers must not overlap.
+template <typename T>
+void transpose_blocked(std::size_t rows, std::size_t cols, const T* src,
+                       std::size_t src_stride, T* dst, std::size_t dst_stride);
+
+// Recursive part of transpose_blocked(), on one thread
+template <typename T>
+void transpose_recursive(std::size_t rows, std::size_t cols, const T* src,
+                         std::size_t src_stride, T* dst,
+                         std::size_t dst_stride);
+
+// In-place transpose of the n x n matrix at data (rows `stride` apart):
+// pairs of tiles are exchanged through a per-task buffer
+template <typename T>
+void transpose_square_inplace(std::size_t n, T* data, std::size_t stride);
+
+// In-place transpose of a dense row-major rows x cols array (no padding),
+// which afterwards holds the cols x rows transpose. Follows the cycles of
+// the permutation with one bit of bookkeeping per element, for buffers too
+// large to copy.
+template <typename T>
+void transpose_dense_inplace(std::size_t rows, std::size_t cols, T* data);
+
+////////////////////////////
+////// Implementation //////
+////////////////////////////
+
+inline std::size_t transpose_leaf_bytes() {
+  const std::size_t tuned = tuning().transpose_leaf_bytes;
+  return tuned != 0 ? tuned : TRANSPOSE_LEAF_BYTES;
+}
+
+template <typename T>
+void transpose_recursive(std::size_t rows, std::size_t cols, const T* src,
+                         std::size_t src_stride, T* dst,
+                         std::size_t dst_stride) {
+  // split points are kept at multiples of 16 so the SIMD tiles stay whole
+  constexpr std::size_t align = 16;
+  if (rows * cols * sizeof(T) <= transpose_leaf_bytes() or
+      (rows <= align and cols <= align)) {
+    simd_transpose(src, src_stride, dst, dst_stride, rows, cols);
+    return;
+  }
+  if (rows >= cols) {
+    const std::size_t half = (rows / 2 + align - 1) / align * align;
+    transpose_recursive(half, cols, src, src_stride, dst, dst_stride);
+    transpose_recursive(rows - half, cols, src + half * src_stride,
+                        src_stride, dst + half, dst_stride);
+  } else {
+    const std::size_t half = (cols / 2 + align - 1) / align * align;
+    transpose_recursive(rows, half, src, src_stride, dst, dst_stride);
+    transpose_recursive(rows, cols - half, src + half, src_stride,
+                        dst + half * dst_stride, dst_stride);
+  }
+}
+
+template <typename T>
+void transpose_blocked(std::size_t rows, std::size_t cols, const T* src,
+                       std::size_t src_stride, T* dst,
+                       std::size_t dst_stride) {
+  if (rows == 0 or cols == 0) return;
+  // a task owns TRANSPOSE_TILE-wide bands of source columns
+  const std::size_t bands = (cols + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE;
+  const std::size_t grain =
+      (parallel_row_grain(rows) + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE;
+  parallel_for(bands, grain, [&](std::size_t begin, std::size_t end) {
+    const std::size_t j0 = begin * TRANSPOSE_TILE;
+    const std::size_t j1 = std::min(end * TRANSPOSE_TILE, cols);
+    transpose_recursive(rows, j1 - j0, src + j0, src_stride,
+                        dst + j0 * dst_stride, dst_stride);
+  });
+}
+
+template <typename T>
+void transpose_square_inplace(std::size_t n, T* data, std::size_t stride) {
+  const std::size_t tiles = (n + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE;
+  // tile row I swaps with tile column I from the diagonal on; the rows are
+  // uneven in work, so they are handed out one at a time
+  parallel_for(
+      tiles, n * TRANSPOSE_TILE >= parallel_min_elements() ? 1 : tiles,
+      [&](std::size_t begin, std::size_t end) {
+        std::vector<T> buffer(TRANSPOSE_TILE * TRANSPOSE_TILE);
+        for (std::size_t ti = begin; ti < end; ti++) {
+          const std::size_t i0 = ti * TRANSPOSE_TILE;
+          const std::size_t h = std::min(TRANSPOSE_TILE, n - i0);
+          for (std::size_t j0 = i0; j0 < n; j0 += TRANSPOSE_TILE) {
+            const std::size_t w = std::min(TRANSPOSE_TILE, n - j0);
+            T* upper = data + i0 * stride + j0;  // h x w
+            T* lower = data + j0 * stride + i0;  // w x h
+            // buffer = upper^T, upper = lower^T, lower = buffer
+            simd_transpose(upper, stride, buffer.data(), h, h, w);
+            if (j0 != i0) simd_transpose(lower, stride, upper, stride, w, h);
+            for (std::size_t r = 0; r < w; r++)
+              std::copy_n(buffer.data() + r * h, h, lower + r * stride);
+          }
+        }
+      });
+}
+
+template <typename T>
+void transpose_dense_inplace(std::size_t rows, std::size_t cols, T* data) {
+  const std::size_t count = rows * cols;
+  if (rows <= 1 or cols <= 1) return;
+  // position p of the transpose (p = b * rows + a) takes the element at
+  // a * cols + b; a cycle is walked once from its smallest position
+  auto source = [&](std::size_t p) { return p % rows * cols + p / rows; };
+  std::vector<std::uint64_t> done((count + 63) / 64);
+  auto mark = [&](std::size_t p) {
+    done[p / 64] |= std::uint64_t(1) << p % 64;
+  };
+  auto marked = [&](std::size_t p) { return (done[p / 64] >> p % 64) & 1; };
+  for (std::size_t start = 1; start + 1 < count; start++) {
+    if (marked(start)) continue;
+    T carried = std::move(data[start]);
+    std::size_t p = start;
+    for (std::size_t q = source(p); q != start; p = q, q = source(q)) {
+      data[p] = std::move(data[q]);
+      mark(p);
+    }
+    data[p] = std::move(carried);
+    mark(p);
+  }
+}
+
+}  // namespace algebra
+
+#endif  // AUT_AP_2024_Spring_HW1_TRANSPOSE
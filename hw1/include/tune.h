@@ -0,0 +1,88 @@
+#ifndef AUT_AP_2024_Spring_HW1_TUNE
+#define AUT_AP_2024_Spring_HW1_TUNE
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+
+namespace algebra {
+// Cache blocking of the GEMM kernel, in elements.
+// kc: depth of a packed panel, sized so one MR x kc slice of A and one
+//     kc x NR slice of B stay in L1 while the micro-kernel runs;
+// mc: rows of the packed A block kept in L2;
+// nc: columns of the packed B panel kept in L3.
+struct GemmBlocking {
+  std::size_t mc;
+  std::size_t kc;
+  std::size_t nc;
+
+  bool operator==(const GemmBlocking&) const = default;
+};
+
+// Kernel parameters that depend on the host. A zero field (or blocking)
+// means the compile-time default next to the kernel; tune() fills in the
+// winners it measured.
+// gemm4, gemm8:          GEMM blocking for 4- and 8-byte elements;
+// gemm_min_ops:          multiply-adds from which products are blocked
+//                        (GEMM_BLOCKED_MIN_OPS);
+// parallel_min_elements: elements from which loops are split over the
+//                        thread pool (PARALLEL_MIN_ELEMENTS);
+// transpose_leaf_bytes:  leaf size of the recursive transpose
+//                        (TRANSPOSE_LEAF_BYTES);
+// threads:               thread count used when set_num_threads() was
+//                        not called or was given 0.
+struct Tuning {
+  GemmBlocking gemm4{0, 0, 0};
+  GemmBlocking gemm8{0, 0, 0};
+  std::size_t gemm_min_ops = 0;
+  std::size_t parallel_min_elements = 0;
+  std::size_t transpose_leaf_bytes = 0;
+  std::size_t threads = 0;
+
+  bool operator==(const Tuning&) const = default;
+};
+
+// Settings of tune().
+// save:  write the winners to tuning_cache_path();
+// quick: smaller problems and fewer repetitions, e.g. for tests; the
+//        winners are noisier.
+struct TuneOptions {
+  bool save = true;
+  bool quick = false;
+};
+
+// Parameters the kernels currently dispatch through. The first call loads
+// this host's cache file if there is one; without a cache file and with
+// ALGEBRA_AUTOTUNE=1 in the environment it runs tune() instead. Other
+// threads calling tuning() meanwhile wait until the result is published.
+const Tuning& tuning();
+
+// The Tuning a first-use tune() is measuring with on this thread, nullptr
+// otherwise. tuning() returns it instead of the published parameters; pool
+// tasks take over the value of the thread that queued them.
+Tuning*& tuning_in_progress();
+
+// Replace the current parameters; not safe while algebra routines run on
+// other threads
+void set_tuning(const Tuning& tuning);
+
+// Benchmark candidate configurations on this host, make the winners current
+// and return them. The thread count is left at the default afterwards
+// (set_num_threads(0)), i.e. the measured best. Takes a few seconds.
+Tuning tune(const TuneOptions& options = {});
+
+// $ALGEBRA_TUNING_CACHE if set, otherwise tuning-<hostname>.txt in
+// $XDG_CACHE_HOME/aut_ap_algebra (~/.cache/aut_ap_algebra by default)
+std::filesystem::path tuning_cache_path();
+
+// Text file of `key value...` lines, stamped with the host name and CPU.
+// Loading returns nothing for a missing file or one written on another
+// host or CPU, and throws std::runtime_error for a malformed one. Values
+// the kernels cannot use (a blocking that does not fit the register tile,
+// thousands of threads, ...) load as 0, i.e. the default.
+void save_tuning(const Tuning& tuning, const std::filesystem::path& path);
+std::optional<Tuning> load_tuning(const std::filesystem::path& path);
+
+}  // namespace algebra
+
+#endif  // AUT_AP_2024_Spring_HW1_TUNE
@@ -0,0 +1,345 @@
+#ifndef AUT_AP_2024_Spring_HW1_VIEW
+#define AUT_AP_2024_Spring_HW1_VIEW
+
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+#include "matrix.h"
+
+namespace algebra {
+// Non-owning, strided window onto matrix storage (in the spirit of
+// std::mdspan with a layout_stride mapping). Element (i, j) lives at
+// data()[i * row_stride() + j * col_stride()], so row ranges, column ranges,
+// sub-blocks and transposes are all O(1) and copy nothing.
+// MatrixSpan<T> can write through to the storage, MatrixView<T> is the
+// read-only flavour (MatrixSpan<const T>).
+template <typename T>
+class MatrixSpan {
+ public:
+  using value_type = std::remove_const_t<T>;
+  using element_type = T;
+
+  MatrixSpan() = default;
+  MatrixSpan(T* data, std::size_t rows, std::size_t cols,
+             std::size_t row_stride, std::size_t col_stride = 1)
+      : data_(data),
+        rows_(rows),
+        cols_(cols),
+        row_stride_(row_stride),
+        col_stride_(col_stride) {}
+
+  // Whole-matrix spans; the read-only one also binds to const matrices
+  MatrixSpan(Matrix<value_type>& matrix)
+      : MatrixSpan(matrix.data(), matrix.rows(), matrix.cols(),
+                   matrix.stride()) {}
+  MatrixSpan(const Matrix<value_type>& matrix)
+    requires std::is_const_v<T>
+      : MatrixSpan(matrix.data(), matrix.rows(), matrix.cols(),
+                   matrix.stride()) {}
+
+  // A writable span converts to a read-only one
+  operator MatrixSpan<const value_type>() const
+    requires(!std::is_const_v<T>)
+  {
+    return {data_, rows_, cols_, row_stride_, col_stride_};
+  }
+
+  std::size_t rows() const { return rows_; }
+  std::size_t cols() const { return cols_; }
+  std::size_t row_stride() const { return row_stride_; }
+  std::size_t col_stride() const { return col_stride_; }
+  std::size_t size() const { return rows_ * cols_; }
+  bool empty() const { return rows_ == 0 or cols_ == 0; }
+  T* data() const { return data_; }
+
+  // Rows are contiguous arrays (the SIMD kernels can run on them)
+  bool contiguous_rows() const { return col_stride_ == 1; }
+  T* row(std::size_t i) const { return data_ + i * row_stride_; }
+
+  T& operator()(std::size_t i, std::size_t j) const {
+    return data_[i * row_stride_ + j * col_stride_];
+  }
+
+  // Rows [begin, end)
+  MatrixSpan row_range(std::size_t begin, std::size_t end) const;
+  // Columns [begin, end)
+  MatrixSpan col_range(std::size_t begin, std::size_t end) const;
+  // rows x cols block whose top-left element is (row, col)
+  MatrixSpan block(std::size_t row, std::size_t col, std::size_t rows,
+                   std::size_t cols) const;
+  // Transpose by swapping the strides
+  MatrixSpan transposed() const;
+
+ private:
+  T* data_ = nullptr;
+  std::size_t rows_ = 0;
+  std::size_t cols_ = 0;
+  std::size_t row_stride_ = 0;
+  std::size_t col_stride_ = 0;
+};
+
+template <typename T>
+using MatrixView = MatrixSpan<const T>;
+
+template <typename T>
+inline constexpr bool is_span_v = false;
+
+template <typename T>
+inline constexpr bool is_span_v<MatrixSpan<T>> = true;
+
+// Anything the algebra routines accept as a dense operand
+template <typename M>
+concept dense_matrix = is_matrix_v<M> or is_span_v<M>;
+
+// Read-only view of a dense operand
+template <typename T>
+MatrixView<T> view(const Matrix<T>& matrix);
+
+template <typename T>
+MatrixView<std::remove_const_t<T>> view(MatrixSpan<T> span);
+
+// Writable span over a matrix
+template <typename T>
+MatrixSpan<T> span(Matrix<T>& matrix);
+
+// Copy the viewed elements into a new contiguous matrix
+template <typename T>
+Matrix<std::remove_const_t<T>> to_matrix(MatrixSpan<T> span);
+
+// Copy `src` into the storage behind `dst`; shapes must match
+template <dense_matrix M, typename T>
+void copy(const M& src, MatrixSpan<T> dst);
+
+// The algebra API for views. Each overload needs at least one span and
+// returns a new Matrix<T>; views and matrices can be mixed freely.
+template <typename T>
+void display(MatrixSpan<T> matrix);
+
+template <typename T>
+std::pair<size_t, size_t> matrix_size(MatrixSpan<T> matrix);
+
+template <dense_matrix A, dense_matrix B>
+  requires(is_span_v<A> or is_span_v<B>)
+auto sum_sub(const A& matrixA, const B& matrixB,
+             std::optional<std::string> operation = "sum");
+
+template <typename T>
+Matrix<std::remove_const_t<T>> multiply(MatrixSpan<T> matrix,
+                                        const std::remove_const_t<T> scalar);
+
+template <dense_matrix A, dense_matrix B>
+  requires(is_span_v<A> or is_span_v<B>)
+auto multiply(const A& matrixA, const B& matrixB);
+
+template <dense_matrix A, dense_matrix B>
+  requires(is_span_v<A> or is_span_v<B>)
+auto hadamard_product(const A& matrixA, const B& matrixB);
+
+template <typename T>
+Matrix<std::remove_const_t<T>> transpose(MatrixSpan<T> matrix);
+
+template <typename T>
+std::remove_const_t<T> trace(MatrixSpan<T> matrix);
+
+////////////////////////////
+////// Implementation //////
+////////////////////////////
+
+template <typename T>
+MatrixSpan<T> MatrixSpan<T>::row_range(std::size_t begin,
+                                       std::size_t end) const {
+  return block(begin, 0, end - begin, cols_);
+}
+
+template <typename T>
+MatrixSpan<T> MatrixSpan<T>::col_range(std::size_t begin,
+                                       std::size_t end) const {
+  return block(0, begin, rows_, end - begin);
+}
+
+template <typename T>
+MatrixSpan<T> MatrixSpan<T>::block(std::size_t row, std::size_t col,
+                                   std::size_t rows, std::size_t cols) const {
+  if (row + rows > rows_ or col + cols > cols_ or row > rows_ or col > cols_)
+    throw std::out_of_range("The block is outside of the matrix.");
+  if (rows == 0 or cols == 0) return MatrixSpan();
+  return {data_ + row * row_stride_ + col * col_stride_, rows, cols,
+          row_stride_, col_stride_};
+}
+
+template <typename T>
+MatrixSpan<T> MatrixSpan<T>::transposed() const {
+  return {data_, cols_, rows_, col_stride_, row_stride_};
+}
+
+template <typename T>
+MatrixView<T> view(const Matrix<T>& matrix) {
+  return MatrixView<T>(matrix);
+}
+
+template <typename T>
+MatrixView<std::remove_const_t<T>> view(MatrixSpan<T> span) {
+  return span;
+}
+
+template <typename T>
+MatrixSpan<T> span(Matrix<T>& matrix) {
+  return MatrixSpan<T>(matrix);
+}
+
+template <typename T>
+Matrix<std::remove_const_t<T>> to_matrix(MatrixSpan<T> span) {
+  Matrix<std::remove_const_t<T>> res(span.rows(), span.cols());
+  copy(span, MatrixSpan<std::remove_const_t<T>>(res));
+  return res;
+}
+
+template <dense_matrix M, typename T>
+void copy(const M& src, MatrixSpan<T> dst) {
+  const auto s = view(src);
+  if (s.rows() != dst.rows() or s.cols() != dst.cols())
+    throw std::logic_error("Matrix dimensions are not same.");
+  // a transposed view of row-major storage goes through the blocked
+  // transpose instead of striding down its columns
+  if (dst.contiguous_rows() and !s.contiguous_rows() and s.row_stride() == 1) {
+    transpose_blocked(s.cols(), s.rows(), s.data(), s.col_stride(), dst.data(),
+                      dst.row_stride());
+    return;
+  }
+  parallel_for(dst.rows(), parallel_row_grain(dst.cols()),
+               [&](size_t begin, size_t end) {
+                 for (size_t i = begin; i < end; i++)
+                   for (size_t j = 0; j < dst.cols(); j++) dst(i, j) = s(i, j);
+               });
+}
+
+template <typename T>
+void display(MatrixSpan<T> matrix) {
+  for (size_t i = 0; i < matrix.rows(); i++) {
+    for (size_t j = 0; j < matrix.cols(); j++) display_element(matrix(i, j));
+    std::cout << "|\n";
+  }
+}
+
+template <typename T>
+std::pair<size_t, size_t> matrix_size(MatrixSpan<T> matrix) {
+  return std::make_pair(matrix.rows(), matrix.cols());
+}
+
+// Shared body of the element-wise view operations: rows that are contiguous
+// in all operands go through the SIMD kernel, anything else element-wise.
+template <typename T, typename Kernel, typename Op>
+Matrix<T> elementwise(MatrixView<T> a, MatrixView<T> b, Kernel kernel, Op op) {
+  if (matrix_size(a) != matrix_size(b))
+    throw std::logic_error("Matrix dimensions are not same.");
+  Matrix<T> res(a.rows(), a.cols());
+  const bool contiguous = a.contiguous_rows() and b.contiguous_rows();
+  parallel_for(res.rows(), parallel_row_grain(res.cols()),
+               [&](size_t begin, size_t end) {
+                 for (size_t i = begin; i < end; i++) {
+                   if (contiguous) {
+                     kernel(a.row(i), b.row(i), res.row(i), res.cols());
+                   } else {
+                     for (size_t j = 0; j < res.cols(); j++)
+                       res(i, j) = op(a(i, j), b(i, j));
+                   }
+                 }
+               });
+  return res;
+}
+
+template <dense_matrix A, dense_matrix B>
+  requires(is_span_v<A> or is_span_v<B>)
+auto sum_sub(const A& matrixA, const B& matrixB,
+             std::optional<std::string> operation) {
+  using T = typename A::value_type;
+  static_assert(std::is_same_v<T, typename B::value_type>);
+  if (operation.has_value() and operation.value() == "sub")
+    return elementwise<T>(
+        view(matrixA), view(matrixB),
+        [](const T* a, const T* b, T* r, size_t n) { simd_sub(a, b, r, n); },
+        [](T a, T b) { return a - b; });
+  return elementwise<T>(
+      view(matrixA), view(matrixB),
+      [](const T* a, const T* b, T* r, size_t n) { simd_add(a, b, r, n); },
+      [](T a, T b) { return a + b; });
+}
+
+template <dense_matrix A, dense_matrix B>
+  requires(is_span_v<A> or is_span_v<B>)
+auto hadamard_product(const A& matrixA, const B& matrixB) {
+  using T = typename A::value_type;
+  static_assert(std::is_same_v<T, typename B::value_type>);
+  return elementwise<T>(
+      view(matrixA), view(matrixB),
+      [](const T* a, const T* b, T* r, size_t n) { simd_mul(a, b, r, n); },
+      [](T a, T b) { return a * b; });
+}
+
+template <typename T>
+Matrix<std::remove_const_t<T>> multiply(MatrixSpan<T> matrix,
+                                        const std::remove_const_t<T> scalar) {
+  Matrix<std::remove_const_t<T>> res(matrix.rows(), matrix.cols());
+  parallel_for(res.rows(), parallel_row_grain(res.cols()),
+               [&](size_t begin, size_t end) {
+                 for (size_t i = begin; i < end; i++) {
+                   if (matrix.contiguous_rows()) {
+                     simd_scale(matrix.row(i), scalar, res.row(i), res.cols());
+                   } else {
+                     for (size_t j = 0; j < res.cols(); j++)
+                       res(i, j) = matrix(i, j) * scalar;
+                   }
+                 }
+               });
+  return res;
+}
+
+template <dense_matrix A, dense_matrix B>
+  requires(is_span_v<A> or is_span_v<B>)
+auto multiply(const A& matrixA, const B& matrixB) {
+  using T = typename A::value_type;
+  static_assert(std::is_same_v<T, typename B::value_type>);
+  const MatrixView<T> a = view(matrixA);
+  const MatrixView<T> b = view(matrixB);
+  if (a.empty() or b.empty()) throw std::logic_error("Matrix is empty.");
+  if (a.cols() != b.rows())
+    throw std::logic_error("Matrix dimensions do not match.");
+
+  Matrix<T> res(a.rows(), b.cols());
+  if (a.rows() * a.cols() * b.cols() >= gemm_blocked_min_ops()) {
+    // packing copes with any strides, including transposed views
+    gemm_blocked<T>(
+        a.rows(), b.cols(), a.cols(), [&](size_t i, size_t k) { return a(i, k); },
+        [&](size_t k, size_t j) { return b(k, j); },
+        [&](size_t i, size_t j) -> T& { return res(i, j); });
+    return res;
+  }
+  for (size_t i = 0; i < a.rows(); i++) {
+    T* r = res.row(i);
+    for (size_t k = 0; k < a.cols(); k++) {
+      const T tmp = a(i, k);
+      for (size_t j = 0; j < b.cols(); j++) r[j] += tmp * b(k, j);
+    }
+  }
+  return res;
+}
+
+template <typename T>
+Matrix<std::remove_const_t<T>> transpose(MatrixSpan<T> matrix) {
+  return to_matrix(matrix.transposed());
+}
+
+template <typename T>
+std::remove_const_t<T> trace(MatrixSpan<T> matrix) {
+  if (matrix.empty()) throw std::logic_error("Matrix is empty.");
+  if (matrix.rows() != matrix.cols())
+    throw std::logic_error("Matrix must be square.");
+  return simd_strided_sum(matrix.data(),
+                          matrix.row_stride() + matrix.col_stride(),
+                          matrix.rows());
+}
+
+}  // namespace algebra
+
+#endif  // AUT_AP_2024_Spring_HW1_VIEW
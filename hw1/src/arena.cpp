@@ -0,0 +1,117 @@
+#include "arena.h"
+
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+
+namespace algebra {
+namespace {
+thread_local MatrixArena* active_arena = nullptr;
+
+std::size_t round_up(std::size_t bytes) {
+  return (bytes + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+}
+}  // namespace
+
+MatrixArena::MatrixArena(std::size_t chunk_bytes)
+    : chunk_bytes_(round_up(std::max<std::size_t>(chunk_bytes, 1))) {}
+
+MatrixArena::~MatrixArena() { free_chunks(); }
+
+void* MatrixArena::allocate(std::size_t bytes) {
+  bytes = round_up(std::max<std::size_t>(bytes, 1));
+  std::lock_guard<std::mutex> lock(mutex_);
+  // move on to the first chunk with room left; chunks are kept in the
+  // order they were taken, so a rewound arena walks them again
+  while (current_ < chunks_.size() and
+         chunks_[current_].size - offset_ < bytes) {
+    current_++;
+    offset_ = 0;
+  }
+  if (current_ == chunks_.size()) {
+    // each new chunk doubles the reservation, so a steady workload settles
+    // on a few chunks
+    const std::size_t size =
+        std::max(bytes, std::max(chunk_bytes_, stats_.bytes_reserved));
+    auto* data = static_cast<std::byte*>(
+        ::operator new(size, std::align_val_t{ARENA_ALIGNMENT}));
+    chunks_.push_back(Chunk{.data = data, .size = size, .high_water = 0});
+    offset_ = 0;
+    stats_.bytes_reserved += size;
+    stats_.chunks++;
+  }
+
+  Chunk& chunk = chunks_[current_];
+  void* ptr = chunk.data + offset_;
+  if (offset_ < chunk.high_water)
+    stats_.bytes_reused += std::min(bytes, chunk.high_water - offset_);
+  offset_ += bytes;
+  chunk.high_water = std::max(chunk.high_water, offset_);
+
+  live_blocks_++;
+  stats_.allocations++;
+  stats_.bytes_allocated += bytes;
+  stats_.live_bytes += bytes;
+  stats_.peak_bytes = std::max(stats_.peak_bytes, stats_.live_bytes);
+  return ptr;
+}
+
+void MatrixArena::deallocate(void* ptr, std::size_t bytes) noexcept {
+  if (ptr == nullptr) return;
+  bytes = round_up(std::max<std::size_t>(bytes, 1));
+  std::lock_guard<std::mutex> lock(mutex_);
+  live_blocks_--;
+  stats_.live_bytes -= bytes;
+  if (live_blocks_ == 0) rewind();
+}
+
+void MatrixArena::rewind() {
+  current_ = 0;
+  offset_ = 0;
+  stats_.rewinds++;
+}
+
+void MatrixArena::release() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (live_blocks_ != 0) {
+    throw std::logic_error("The arena still has live matrices.");
+  }
+  free_chunks();
+}
+
+void MatrixArena::free_chunks() noexcept {
+  for (const Chunk& chunk : chunks_)
+    ::operator delete(chunk.data, std::align_val_t{ARENA_ALIGNMENT});
+  chunks_.clear();
+  current_ = 0;
+  offset_ = 0;
+  stats_.bytes_reserved = 0;
+  stats_.chunks = 0;
+}
+
+ArenaStats MatrixArena::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void MatrixArena::reset_stats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_ = ArenaStats{.allocations = 0,
+                      .bytes_allocated = 0,
+                      .bytes_reused = 0,
+                      .bytes_reserved = stats_.bytes_reserved,
+                      .chunks = stats_.chunks,
+                      .live_bytes = stats_.live_bytes,
+                      .peak_bytes = stats_.live_bytes,
+                      .rewinds = 0};
+}
+
+MatrixArena* current_arena() { return active_arena; }
+
+ArenaScope::ArenaScope(MatrixArena& arena) : previous_(active_arena) {
+  active_arena = &arena;
+}
+
+ArenaScope::~ArenaScope() { active_arena = previous_; }
+
+}  // namespace algebra
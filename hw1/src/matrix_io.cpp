@@ -0,0 +1,295 @@
+#include "matrix_io.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+
+namespace algebra {
+// Files are written and mapped in the machine's byte order
+static_assert(std::endian::native == std::endian::little,
+              "Matrix files need a little-endian machine.");
+
+namespace {
+constexpr char MAGIC[8] = {'A', 'U', 'T', 'M', 'A', 'T', 'R', 'X'};
+constexpr std::uint32_t VERSION = 1;
+constexpr std::uint64_t FLETCHER_MOD = 0xFFFFFFFF;
+// Words summed between two reductions; keeps both sums below 2^64
+constexpr std::size_t FLETCHER_BLOCK = 1024;
+
+std::uint64_t round_up(std::uint64_t value, std::uint64_t multiple) {
+  return (value + multiple - 1) / multiple * multiple;
+}
+
+[[noreturn]] void invalid_file() {
+  throw std::runtime_error("Invalid matrix file.");
+}
+
+// Checks that the header describes data that lies inside the file
+void check_header(const MatrixFileHeader& h, std::uint64_t file_size) {
+  if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0 or
+      h.version != VERSION or h.dtype < DType::Int8 or
+      h.dtype > DType::Float64 or h.checksum_kind > ChecksumKind::Fletcher64)
+    invalid_file();
+  const std::uint64_t size = dtype_size(h.dtype);
+  if (h.alignment == 0 or !std::has_single_bit(h.alignment) or
+      h.data_offset < sizeof(MatrixFileHeader) or
+      h.data_offset % h.alignment != 0 or h.data_offset % size != 0 or
+      h.data_bytes % size != 0 or h.data_offset > file_size or
+      h.data_bytes > file_size - h.data_offset)
+    invalid_file();
+  if ((h.rows == 0) != (h.cols == 0)) invalid_file();
+  if (h.rows == 0) return;
+  // offset of the last element, in elements, must be inside the data
+  std::uint64_t last, last_col;
+  if (__builtin_mul_overflow(h.rows - 1, h.row_stride, &last) or
+      __builtin_mul_overflow(h.cols - 1, h.col_stride, &last_col) or
+      __builtin_add_overflow(last, last_col, &last) or
+      last >= h.data_bytes / size)
+    invalid_file();
+}
+
+std::uint64_t checksum_of(const MatrixFileHeader& h, const void* data) {
+  Fletcher64 sum;
+  sum.update(data, h.data_bytes);
+  return sum.value();
+}
+}  // namespace
+
+std::size_t dtype_size(DType dtype) {
+  switch (dtype) {
+    case DType::Int8:
+    case DType::UInt8:
+      return 1;
+    case DType::Int16:
+    case DType::UInt16:
+      return 2;
+    case DType::Int32:
+    case DType::UInt32:
+    case DType::Float32:
+      return 4;
+    case DType::Int64:
+    case DType::UInt64:
+    case DType::Float64:
+      return 8;
+  }
+  throw std::logic_error("Unknown matrix file dtype.");
+}
+
+const char* dtype_name(DType dtype) {
+  switch (dtype) {
+    case DType::Int8:
+      return "int8";
+    case DType::UInt8:
+      return "uint8";
+    case DType::Int16:
+      return "int16";
+    case DType::UInt16:
+      return "uint16";
+    case DType::Int32:
+      return "int32";
+    case DType::UInt32:
+      return "uint32";
+    case DType::Int64:
+      return "int64";
+    case DType::UInt64:
+      return "uint64";
+    case DType::Float32:
+      return "float32";
+    case DType::Float64:
+      return "float64";
+  }
+  return "unknown";
+}
+
+void Fletcher64::update(const void* data, std::size_t bytes) {
+  const auto* p = static_cast<const unsigned char*>(data);
+  // complete a word left over from the previous call
+  while (tail_size_ > 0 and tail_size_ < 4 and bytes > 0) {
+    tail_[tail_size_++] = *p++;
+    bytes--;
+  }
+  if (tail_size_ == 4) {
+    std::uint32_t word;
+    std::memcpy(&word, tail_, 4);
+    sum1_ = (sum1_ + word) % FLETCHER_MOD;
+    sum2_ = (sum2_ + sum1_) % FLETCHER_MOD;
+    tail_size_ = 0;
+  }
+  std::size_t words = bytes / 4;
+  while (words > 0) {
+    const std::size_t n = std::min(words, FLETCHER_BLOCK);
+    for (std::size_t i = 0; i < n; i++, p += 4) {
+      std::uint32_t word;
+      std::memcpy(&word, p, 4);
+      sum1_ += word;
+      sum2_ += sum1_;
+    }
+    sum1_ %= FLETCHER_MOD;
+    sum2_ %= FLETCHER_MOD;
+    words -= n;
+  }
+  for (bytes %= 4; bytes > 0; bytes--) tail_[tail_size_++] = *p++;
+}
+
+std::uint64_t Fletcher64::value() const {
+  std::uint64_t sum1 = sum1_, sum2 = sum2_;
+  if (tail_size_ > 0) {
+    unsigned char last[4] = {};
+    std::memcpy(last, tail_, tail_size_);
+    std::uint32_t word;
+    std::memcpy(&word, last, 4);
+    sum1 = (sum1 + word) % FLETCHER_MOD;
+    sum2 = (sum2 + sum1) % FLETCHER_MOD;
+  }
+  return sum2 << 32 | sum1;
+}
+
+MatrixFileWriter::MatrixFileWriter(const std::string& path, DType dtype,
+                                   std::size_t rows, std::size_t cols,
+                                   MatrixFileOptions options) {
+  if ((rows == 0) != (cols == 0)) {
+    throw std::logic_error("The matrix dimension must be larger than 0.");
+  }
+  if (options.alignment == 0 or !std::has_single_bit(options.alignment)) {
+    throw std::logic_error("The alignment must be a power of two.");
+  }
+  const std::size_t size = dtype_size(dtype);
+  const std::size_t alignment = std::max(options.alignment, size);
+  header_.version = VERSION;
+  header_.dtype = dtype;
+  header_.rows = rows;
+  header_.cols = cols;
+  header_.row_stride =
+      options.pad_rows ? round_up(cols * size, alignment) / size : cols;
+  header_.col_stride = 1;
+  header_.alignment = alignment;
+  header_.data_offset = round_up(sizeof(MatrixFileHeader), alignment);
+  header_.data_bytes = rows * header_.row_stride * size;
+  header_.checksum_kind =
+      options.checksum ? ChecksumKind::Fletcher64 : ChecksumKind::None;
+
+  file_.open(path, std::ios::binary | std::ios::trunc);
+  if (!file_) throw std::runtime_error("Cannot open " + path + ".");
+  // the magic stays zero until finish(), so partial files are rejected
+  const std::vector<char> start(header_.data_offset, 0);
+  file_.write(start.data(), start.size());
+}
+
+MatrixFileWriter::~MatrixFileWriter() = default;
+
+void MatrixFileWriter::write_row(const void* row) {
+  if (finished_ or rows_written_ == header_.rows) {
+    throw std::logic_error("Every row of the matrix file is written.");
+  }
+  const std::size_t size = dtype_size(header_.dtype);
+  const std::size_t bytes = header_.cols * size;
+  const std::size_t padding = (header_.row_stride - header_.cols) * size;
+  file_.write(static_cast<const char*>(row), bytes);
+  if (header_.checksum_kind != ChecksumKind::None)
+    checksum_.update(row, bytes);
+  if (padding > 0) {
+    const std::vector<char> zeros(padding, 0);
+    file_.write(zeros.data(), padding);
+    if (header_.checksum_kind != ChecksumKind::None)
+      checksum_.update(zeros.data(), padding);
+  }
+  if (!file_) throw std::runtime_error("Writing the matrix file failed.");
+  rows_written_++;
+}
+
+void MatrixFileWriter::finish() {
+  if (finished_) return;
+  if (rows_written_ != header_.rows) {
+    throw std::logic_error("The matrix file is incomplete.");
+  }
+  std::memcpy(header_.magic, MAGIC, sizeof(MAGIC));
+  if (header_.checksum_kind != ChecksumKind::None)
+    header_.checksum = checksum_.value();
+  file_.seekp(0);
+  file_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+  file_.close();
+  if (!file_) throw std::runtime_error("Writing the matrix file failed.");
+  finished_ = true;
+}
+
+MappedMatrixFile::MappedMatrixFile(const std::string& path,
+                                   bool verify_checksum) {
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) throw std::runtime_error("Cannot open " + path + ".");
+  struct stat st;
+  if (::fstat(fd, &st) != 0 or
+      std::uint64_t(st.st_size) < sizeof(MatrixFileHeader)) {
+    ::close(fd);
+    invalid_file();
+  }
+  map_size_ = st.st_size;
+  map_ = ::mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);  // the mapping keeps the file open
+  if (map_ == MAP_FAILED) {
+    map_ = nullptr;
+    throw std::runtime_error("Cannot map " + path + ".");
+  }
+  std::memcpy(&header_, map_, sizeof(header_));
+  try {
+    check_header(header_, map_size_);
+    if (verify_checksum and header_.checksum_kind != ChecksumKind::None and
+        checksum_of(header_, data()) != header_.checksum)
+      throw std::runtime_error("Matrix file checksum mismatch.");
+  } catch (...) {
+    ::munmap(map_, map_size_);
+    throw;
+  }
+}
+
+MappedMatrixFile::~MappedMatrixFile() {
+  if (map_) ::munmap(map_, map_size_);
+}
+
+MappedMatrixFile::MappedMatrixFile(MappedMatrixFile&& other) noexcept
+    : map_(std::exchange(other.map_, nullptr)),
+      map_size_(std::exchange(other.map_size_, 0)),
+      header_(other.header_) {}
+
+MappedMatrixFile& MappedMatrixFile::operator=(
+    MappedMatrixFile&& other) noexcept {
+  if (this != &other) {
+    if (map_) ::munmap(map_, map_size_);
+    map_ = std::exchange(other.map_, nullptr);
+    map_size_ = std::exchange(other.map_size_, 0);
+    header_ = other.header_;
+  }
+  return *this;
+}
+
+const void* MappedMatrixFile::data() const {
+  return static_cast<const char*>(map_) + header_.data_offset;
+}
+
+void MappedMatrixFile::release(const void* begin, std::size_t bytes) const {
+  // only whole pages inside the range can go
+  static const std::uintptr_t page = ::sysconf(_SC_PAGESIZE);
+  const auto first = reinterpret_cast<std::uintptr_t>(begin);
+  const std::uintptr_t lo = round_up(first, page);
+  const std::uintptr_t hi = (first + bytes) / page * page;
+  if (lo < hi)
+    ::madvise(reinterpret_cast<void*>(lo), hi - lo, MADV_DONTNEED);
+}
+
+MatrixFileHeader read_matrix_header(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) throw std::runtime_error("Cannot open " + path + ".");
+  MatrixFileHeader header;
+  if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+    invalid_file();
+  check_header(header, std::filesystem::file_size(path));
+  return header;
+}
+
+}  // namespace algebra
@@ -0,0 +1,467 @@
+#include "quantized.h"
+
+#include <algorithm>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ALGEBRA_QUANTIZED_X86 1
+#endif
+
+namespace algebra {
+namespace {
+// Register tile of the kernels: MR rows of A against NR rows of Bt, i.e.
+// MR x NR dot products along k
+constexpr std::size_t MR = 4;
+constexpr std::size_t NR = 4;
+
+// Rows of A per task and bytes of Bt per column panel: a task sweeps its
+// rows over one panel, which stays in L2 meanwhile
+constexpr std::size_t ROW_TILE = 64;
+constexpr std::size_t PANEL_BYTES = 256 * 1024;
+
+// Kernels compute c[r * ldc + j] for r < mr (<= MR) rows of A and the n
+// rows of Bt, all of length k with stride k. Rows past mr are read from
+// row mr - 1 and dropped, so the tiles need no edge cases.
+using Int8Kernel = void (*)(const std::int8_t* a, std::size_t mr,
+                            const std::int8_t* bt, std::size_t n,
+                            std::size_t k, const std::int32_t* bsum,
+                            std::int32_t* c, std::size_t ldc);
+using Bf16Kernel = void (*)(const BFloat16* a, std::size_t mr,
+                            const BFloat16* bt, std::size_t n, std::size_t k,
+                            float* c, std::size_t ldc);
+
+// The portable kernels keep the same MR x NR tile as the vector ones, for
+// independent accumulation chains and reuse of every element loaded
+template <typename T, typename Acc, typename Widen>
+void portable_tile(const T* a, std::size_t mr, const T* bt, std::size_t n,
+                   std::size_t k, Acc* c, std::size_t ldc, Widen widen) {
+  for (std::size_t j = 0; j < n; j += NR) {
+    const std::size_t nr = std::min(NR, n - j);
+    const T* x[MR];
+    const T* y[NR];
+    for (std::size_t r = 0; r < MR; r++) x[r] = a + std::min(r, mr - 1) * k;
+    for (std::size_t s = 0; s < NR; s++)
+      y[s] = bt + (j + std::min(s, nr - 1)) * k;
+    Acc acc[MR][NR] = {};
+    for (std::size_t p = 0; p < k; p++)
+      for (std::size_t r = 0; r < MR; r++)
+        for (std::size_t s = 0; s < NR; s++)
+          acc[r][s] += widen(x[r][p]) * widen(y[s][p]);
+    for (std::size_t r = 0; r < mr; r++)
+      for (std::size_t s = 0; s < nr; s++) c[r * ldc + j + s] = acc[r][s];
+  }
+}
+
+void int8_portable(const std::int8_t* a, std::size_t mr,
+                   const std::int8_t* bt, std::size_t n, std::size_t k,
+                   const std::int32_t*, std::int32_t* c, std::size_t ldc) {
+  portable_tile(a, mr, bt, n, k, c, ldc,
+                [](std::int8_t v) { return std::int32_t(v); });
+}
+
+void bf16_portable(const BFloat16* a, std::size_t mr, const BFloat16* bt,
+                   std::size_t n, std::size_t k, float* c, std::size_t ldc) {
+  portable_tile(a, mr, bt, n, k, c, ldc, [](BFloat16 v) { return float(v); });
+}
+
+#if defined(ALGEBRA_QUANTIZED_X86)
+// Horizontal sum of the lanes of v, spilled to memory (GCC 12's
+// _mm512_reduce_add_* trip -Wmaybe-uninitialized)
+template <typename T, typename V>
+[[gnu::always_inline]] inline T lane_sum(const V& v) {
+  T lanes[sizeof(V) / sizeof(T)];
+  std::memcpy(lanes, &v, sizeof(V));
+  T sum = 0;
+  for (const T x : lanes) sum += x;
+  return sum;
+}
+
+// vpdpbusd multiplies unsigned by signed bytes. A is fed as a + 128 (its
+// sign bit flipped), which adds 128 * sum(Bt row) to every dot product;
+// bsum holds those sums. The biased lanes can leave the int32 range, so
+// they and the correction are summed in uint32 and wrap exactly like the
+// dot; only the final value is converted back.
+[[gnu::target("avx512f,avx512bw,avx512vnni")]] void int8_avx512_vnni(
+    const std::int8_t* a, std::size_t mr, const std::int8_t* bt,
+    std::size_t n, std::size_t k, const std::int32_t* bsum, std::int32_t* c,
+    std::size_t ldc) {
+  const __m512i flip = _mm512_set1_epi8(char(0x80));
+  for (std::size_t j = 0; j < n; j += NR) {
+    const std::size_t nr = std::min(NR, n - j);
+    __m512i acc[MR][NR];
+    for (std::size_t r = 0; r < MR; r++)
+      for (std::size_t s = 0; s < NR; s++) acc[r][s] = _mm512_setzero_si512();
+    for (std::size_t p = 0; p < k; p += 64) {
+      // the tail loads zeros for B, so the flipped A padding adds nothing
+      const __mmask64 mask =
+          k - p >= 64 ? ~__mmask64(0) : (__mmask64(1) << (k - p)) - 1;
+      __m512i x[MR];
+      for (std::size_t r = 0; r < MR; r++)
+        x[r] = _mm512_xor_si512(
+            _mm512_maskz_loadu_epi8(mask, a + std::min(r, mr - 1) * k + p),
+            flip);
+      for (std::size_t s = 0; s < NR; s++) {
+        const __m512i y = _mm512_maskz_loadu_epi8(
+            mask, bt + (j + std::min(s, nr - 1)) * k + p);
+        for (std::size_t r = 0; r < MR; r++)
+          acc[r][s] = _mm512_dpbusd_epi32(acc[r][s], x[r], y);
+      }
+    }
+    for (std::size_t r = 0; r < mr; r++)
+      for (std::size_t s = 0; s < nr; s++)
+        c[r * ldc + j + s] = std::int32_t(lane_sum<std::uint32_t>(acc[r][s]) -
+                                          128u * std::uint32_t(bsum[j + s]));
+  }
+}
+
+// One 32-byte step of the AVX-VNNI tile at offset p of the rows xs and ys
+[[gnu::target("avx2,avxvnni"), gnu::always_inline]] inline void
+int8_avx_vnni_step(const std::int8_t* const* xs, const std::int8_t* const* ys,
+                   std::size_t p, __m256i (&acc)[MR][NR]) {
+  const __m256i flip = _mm256_set1_epi8(char(0x80));
+  __m256i x[MR];
+  for (std::size_t r = 0; r < MR; r++)
+    x[r] = _mm256_xor_si256(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(xs[r] + p)), flip);
+  for (std::size_t s = 0; s < NR; s++) {
+    const __m256i y =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ys[s] + p));
+    for (std::size_t r = 0; r < MR; r++)
+      acc[r][s] = _mm256_dpbusd_avx_epi32(acc[r][s], x[r], y);
+  }
+}
+
+// 256-bit VNNI (AVX-VNNI); without masked byte loads the tail of k goes
+// through zero-padded copies
+[[gnu::target("avx2,avxvnni")]] void int8_avx_vnni(
+    const std::int8_t* a, std::size_t mr, const std::int8_t* bt,
+    std::size_t n, std::size_t k, const std::int32_t* bsum, std::int32_t* c,
+    std::size_t ldc) {
+  const std::size_t body = k / 32 * 32, tail = k - body;
+  alignas(32) std::int8_t a_tail[MR][32] = {}, b_tail[NR][32] = {};
+  for (std::size_t r = 0; r < MR; r++)
+    std::memcpy(a_tail[r], a + std::min(r, mr - 1) * k + body, tail);
+  for (std::size_t j = 0; j < n; j += NR) {
+    const std::size_t nr = std::min(NR, n - j);
+    const std::int8_t* b[NR];
+    for (std::size_t s = 0; s < NR; s++) {
+      b[s] = bt + (j + std::min(s, nr - 1)) * k;
+      std::memcpy(b_tail[s], b[s] + body, tail);
+    }
+    __m256i acc[MR][NR];
+    for (std::size_t r = 0; r < MR; r++)
+      for (std::size_t s = 0; s < NR; s++) acc[r][s] = _mm256_setzero_si256();
+    const std::int8_t* xa[MR];
+    for (std::size_t r = 0; r < MR; r++) xa[r] = a + std::min(r, mr - 1) * k;
+    for (std::size_t p = 0; p < body; p += 32)
+      int8_avx_vnni_step(xa, b, p, acc);
+    if (tail != 0) {
+      const std::int8_t* ta[MR] = {a_tail[0], a_tail[1], a_tail[2], a_tail[3]};
+      const std::int8_t* tb[NR] = {b_tail[0], b_tail[1], b_tail[2], b_tail[3]};
+      int8_avx_vnni_step(ta, tb, 0, acc);
+    }
+    for (std::size_t r = 0; r < mr; r++)
+      for (std::size_t s = 0; s < nr; s++)
+        c[r * ldc + j + s] = std::int32_t(lane_sum<std::uint32_t>(acc[r][s]) -
+                                          128u * std::uint32_t(bsum[j + s]));
+  }
+}
+
+// vdpbf16ps: each float lane accumulates the products of one pair of bf16
+// elements
+[[gnu::target("avx512f,avx512bw,avx512bf16")]] void bf16_avx512_bf16(
+    const BFloat16* a, std::size_t mr, const BFloat16* bt, std::size_t n,
+    std::size_t k, float* c, std::size_t ldc) {
+  for (std::size_t j = 0; j < n; j += NR) {
+    const std::size_t nr = std::min(NR, n - j);
+    __m512 acc[MR][NR];
+    for (std::size_t r = 0; r < MR; r++)
+      for (std::size_t s = 0; s < NR; s++) acc[r][s] = _mm512_setzero_ps();
+    for (std::size_t p = 0; p < k; p += 32) {
+      const __mmask32 mask =
+          k - p >= 32 ? ~__mmask32(0) : (__mmask32(1) << (k - p)) - 1;
+      __m512bh x[MR];
+      for (std::size_t r = 0; r < MR; r++)
+        x[r] = (__m512bh)_mm512_maskz_loadu_epi16(
+            mask, a + std::min(r, mr - 1) * k + p);
+      for (std::size_t s = 0; s < NR; s++) {
+        const __m512bh y = (__m512bh)_mm512_maskz_loadu_epi16(
+            mask, bt + (j + std::min(s, nr - 1)) * k + p);
+        for (std::size_t r = 0; r < MR; r++)
+          acc[r][s] = _mm512_dpbf16_ps(acc[r][s], x[r], y);
+      }
+    }
+    for (std::size_t r = 0; r < mr; r++)
+      for (std::size_t s = 0; s < nr; s++)
+        c[r * ldc + j + s] = lane_sum<float>(acc[r][s]);
+  }
+}
+
+// 16 bf16 widened to floats: a shift into the upper half of each lane
+[[gnu::target("avx512f,avx512bw,avx512vl"), gnu::always_inline]] inline __m512
+bf16_widen(const BFloat16* src, __mmask16 mask) {
+  const __m256i h = _mm256_maskz_loadu_epi16(mask, src);
+  // the maskz forms, since the plain ones trip -Wmaybe-uninitialized too
+  const __m512i w = _mm512_maskz_cvtepu16_epi32(0xffff, h);
+  return _mm512_castsi512_ps(_mm512_maskz_slli_epi32(0xffff, w, 16));
+}
+
+// Plain AVX-512: widen to floats and use FMA
+[[gnu::target("avx512f,avx512bw,avx512vl")]] void bf16_avx512(
+    const BFloat16* a, std::size_t mr, const BFloat16* bt, std::size_t n,
+    std::size_t k, float* c, std::size_t ldc) {
+  for (std::size_t j = 0; j < n; j += NR) {
+    const std::size_t nr = std::min(NR, n - j);
+    __m512 acc[MR][NR];
+    for (std::size_t r = 0; r < MR; r++)
+      for (std::size_t s = 0; s < NR; s++) acc[r][s] = _mm512_setzero_ps();
+    for (std::size_t p = 0; p < k; p += 16) {
+      const __mmask16 mask =
+          k - p >= 16 ? ~__mmask16(0) : __mmask16((1u << (k - p)) - 1);
+      __m512 x[MR];
+      for (std::size_t r = 0; r < MR; r++)
+        x[r] = bf16_widen(a + std::min(r, mr - 1) * k + p, mask);
+      for (std::size_t s = 0; s < NR; s++) {
+        const __m512 y =
+            bf16_widen(bt + (j + std::min(s, nr - 1)) * k + p, mask);
+        for (std::size_t r = 0; r < MR; r++)
+          acc[r][s] = _mm512_fmadd_ps(x[r], y, acc[r][s]);
+      }
+    }
+    for (std::size_t r = 0; r < mr; r++)
+      for (std::size_t s = 0; s < nr; s++)
+        c[r * ldc + j + s] = lane_sum<float>(acc[r][s]);
+  }
+}
+#endif
+
+enum class Int8Choice { Portable, AvxVnni, Avx512Vnni };
+enum class Bf16Choice { Portable, Avx512, Avx512Bf16 };
+
+// The CPU features on top of the SimdLevel that selects the family
+struct QuantizedFeatures {
+  bool avx512bw = false;
+  bool avx512vnni = false;
+  bool avx512bf16 = false;
+  bool avxvnni = false;
+};
+
+const QuantizedFeatures& features() {
+  static const QuantizedFeatures f = [] {
+    QuantizedFeatures res;
+#if defined(ALGEBRA_QUANTIZED_X86)
+    __builtin_cpu_init();
+    res.avx512bw = __builtin_cpu_supports("avx512bw");
+    res.avx512vnni = res.avx512bw and __builtin_cpu_supports("avx512vnni");
+    res.avx512bf16 = res.avx512bw and __builtin_cpu_supports("avx512bf16");
+    res.avxvnni = __builtin_cpu_supports("avxvnni");
+#endif
+    return res;
+  }();
+  return f;
+}
+
+Int8Choice int8_choice() {
+  const SimdLevel level = simd_level();
+  if (level == SimdLevel::AVX512 and features().avx512vnni)
+    return Int8Choice::Avx512Vnni;
+  if ((level == SimdLevel::AVX512 or level == SimdLevel::AVX2) and
+      features().avxvnni)
+    return Int8Choice::AvxVnni;
+  return Int8Choice::Portable;
+}
+
+Bf16Choice bf16_choice() {
+  if (simd_level() != SimdLevel::AVX512 or !features().avx512bw)
+    return Bf16Choice::Portable;
+  return features().avx512bf16 ? Bf16Choice::Avx512Bf16 : Bf16Choice::Avx512;
+}
+
+Int8Kernel int8_kernel() {
+  switch (int8_choice()) {
+#if defined(ALGEBRA_QUANTIZED_X86)
+    case Int8Choice::Avx512Vnni:
+      return int8_avx512_vnni;
+    case Int8Choice::AvxVnni:
+      return int8_avx_vnni;
+#endif
+    default:
+      return int8_portable;
+  }
+}
+
+Bf16Kernel bf16_kernel() {
+  switch (bf16_choice()) {
+#if defined(ALGEBRA_QUANTIZED_X86)
+    case Bf16Choice::Avx512Bf16:
+      return bf16_avx512_bf16;
+    case Bf16Choice::Avx512:
+      return bf16_avx512;
+#endif
+    default:
+      return bf16_portable;
+  }
+}
+
+// C(m x n) = A(m x k) * Bt(n x k)^T, tile by tile over the thread pool.
+// compute(a, mr, bt, nb, acc, ldc, j0) fills an mr x nb block of
+// accumulators, finish(i, j, acc) turns one of them into the result.
+// Every element is computed by one task, in the same order whatever the
+// thread count.
+template <typename Acc, typename Compute, typename Finish>
+void quantized_product(std::size_t m, std::size_t n, std::size_t k,
+                       std::size_t element_bytes, Compute compute,
+                       Finish finish) {
+  const std::size_t panel = std::min(
+      n, std::max(NR, PANEL_BYTES / std::max<std::size_t>(k * element_bytes,
+                                                           1) /
+                          NR * NR));
+  const std::size_t row_tiles = (m + ROW_TILE - 1) / ROW_TILE;
+  const std::size_t col_tiles = (n + panel - 1) / panel;
+  const std::size_t tasks = row_tiles * col_tiles;
+  // products too small to pay for the pool run as one task
+  const std::size_t grain = m * n * k < gemm_blocked_min_ops() ? tasks : 1;
+  parallel_for(tasks, grain, [&](std::size_t begin, std::size_t end) {
+    std::vector<Acc> acc(MR * panel);
+    for (std::size_t t = begin; t < end; t++) {
+      const std::size_t i0 = (t % row_tiles) * ROW_TILE;
+      const std::size_t j0 = (t / row_tiles) * panel;
+      const std::size_t nb = std::min(panel, n - j0);
+      for (std::size_t i = i0; i < std::min(m, i0 + ROW_TILE); i += MR) {
+        const std::size_t mr = std::min(MR, m - i);
+        compute(i, mr, j0, nb, acc.data(), panel);
+        for (std::size_t r = 0; r < mr; r++)
+          for (std::size_t j = 0; j < nb; j++)
+            finish(i + r, j0 + j, acc[r * panel + j]);
+      }
+    }
+  });
+}
+
+void check_product(std::size_t a_rows, std::size_t a_cols,
+                   std::size_t bt_rows, std::size_t bt_cols) {
+  if (a_rows == 0 or a_cols == 0 or bt_rows == 0 or bt_cols == 0)
+    throw std::logic_error("Matrix is empty.");
+  if (a_cols != bt_cols)
+    throw std::logic_error("Matrix dimensions do not match.");
+}
+}  // namespace
+
+BFloat16Matrix::BFloat16Matrix(std::size_t rows, std::size_t cols)
+    : rows_(rows), cols_(cols), data_(rows * cols) {
+  if ((rows == 0) != (cols == 0)) {
+    throw std::logic_error("The matrix dimension must be larger than 0.");
+  }
+}
+
+Matrix<float> QuantizedMatrix::to_matrix() const {
+  Matrix<float> res(rows_, cols_);
+  for (std::size_t i = 0; i < rows_; i++)
+    for (std::size_t j = 0; j < cols_; j++) res(i, j) = value(i, j);
+  return res;
+}
+
+QuantizedMatrix QuantizedMatrix::transposed() const {
+  if (mode_ == QuantScale::PerRow and rows_ > 1) {
+    throw std::logic_error(
+        "A matrix with a scale per row cannot be transposed.");
+  }
+  QuantizedMatrix res;
+  res.rows_ = cols_;
+  res.cols_ = rows_;
+  res.mode_ = QuantScale::PerTensor;
+  res.scales_ = scales_;
+  res.data_.resize(data_.size());
+  transpose_blocked(rows_, cols_, data(), cols_, res.data_.data(), rows_);
+  return res;
+}
+
+Matrix<float> BFloat16Matrix::to_matrix() const {
+  Matrix<float> res(rows_, cols_);
+  for (std::size_t i = 0; i < rows_; i++)
+    for (std::size_t j = 0; j < cols_; j++) res(i, j) = float((*this)(i, j));
+  return res;
+}
+
+BFloat16Matrix BFloat16Matrix::transposed() const {
+  BFloat16Matrix res(cols_, rows_);
+  transpose_blocked(rows_, cols_, data(), cols_, res.data(), rows_);
+  return res;
+}
+
+Matrix<float> multiply_transposed(const QuantizedMatrix& a,
+                                  const QuantizedMatrix& bt) {
+  check_product(a.rows(), a.cols(), bt.rows(), bt.cols());
+  const std::size_t m = a.rows(), n = bt.rows(), k = a.cols();
+  std::vector<std::int32_t> bsum(n, 0);
+  for (std::size_t j = 0; j < n; j++)
+    for (std::size_t p = 0; p < k; p++) bsum[j] += bt(j, p);
+
+  const Int8Kernel kernel = int8_kernel();
+  Matrix<float> res(m, n);
+  quantized_product<std::int32_t>(
+      m, n, k, sizeof(std::int8_t),
+      [&](std::size_t i, std::size_t mr, std::size_t j0, std::size_t nb,
+          std::int32_t* acc, std::size_t ldc) {
+        kernel(a.row(i), mr, bt.row(j0), nb, k, bsum.data() + j0, acc, ldc);
+      },
+      [&](std::size_t i, std::size_t j, std::int32_t acc) {
+        res(i, j) = float(acc) * (a.scale(i) * bt.scale(j));
+      });
+  return res;
+}
+
+Matrix<float> multiply(const QuantizedMatrix& a, const QuantizedMatrix& b) {
+  check_product(a.rows(), a.cols(), b.cols(), b.rows());
+  if (b.scale_mode() == QuantScale::PerRow and b.rows() > 1) {
+    throw std::logic_error(
+        "The right operand must have a per-tensor scale.");
+  }
+  return multiply_transposed(a, b.transposed());
+}
+
+Matrix<float> multiply_transposed(const BFloat16Matrix& a,
+                                  const BFloat16Matrix& bt) {
+  check_product(a.rows(), a.cols(), bt.rows(), bt.cols());
+  const std::size_t m = a.rows(), n = bt.rows(), k = a.cols();
+  const Bf16Kernel kernel = bf16_kernel();
+  Matrix<float> res(m, n);
+  quantized_product<float>(
+      m, n, k, sizeof(BFloat16),
+      [&](std::size_t i, std::size_t mr, std::size_t j0, std::size_t nb,
+          float* acc, std::size_t ldc) {
+        kernel(a.row(i), mr, bt.row(j0), nb, k, acc, ldc);
+      },
+      [&](std::size_t i, std::size_t j, float acc) { res(i, j) = acc; });
+  return res;
+}
+
+Matrix<float> multiply(const BFloat16Matrix& a, const BFloat16Matrix& b) {
+  check_product(a.rows(), a.cols(), b.cols(), b.rows());
+  return multiply_transposed(a, b.transposed());
+}
+
+const char* int8_kernel_name() {
+  switch (int8_choice()) {
+    case Int8Choice::Avx512Vnni:
+      return "avx512-vnni";
+    case Int8Choice::AvxVnni:
+      return "avx-vnni";
+    default:
+      return "portable";
+  }
+}
+
+const char* bf16_kernel_name() {
+  switch (bf16_choice()) {
+    case Bf16Choice::Avx512Bf16:
+      return "avx512-bf16";
+    case Bf16Choice::Avx512:
+      return "avx512";
+    default:
+      return "portable";
+  }
+}
+
+}  // namespace algebra
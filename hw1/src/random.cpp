@@ -0,0 +1,163 @@
+#include "random.h"
+
+#include <atomic>
+#include <cstring>
+#include <random>
+#include <utility>
+
+#include "simd.h"
+
+namespace algebra {
+namespace {
+constexpr std::uint32_t PHILOX_M0 = 0xD2511F53;
+constexpr std::uint32_t PHILOX_M1 = 0xCD9E8D57;
+constexpr std::uint32_t PHILOX_W0 = 0x9E3779B9;
+constexpr std::uint32_t PHILOX_W1 = 0xBB67AE85;
+
+// Blocks block, block + 1, ... for `seed`; block b has the counter
+// (low32(b), high32(b), 0, 0) and writes out[2 * b], out[2 * b + 1].
+// The blocks are independent and overlap well as scalar code: below
+// AVX-512 there is no 64-bit lane multiply, and the vector kernel is no
+// faster than this one.
+void philox_baseline(std::uint64_t seed, std::uint64_t block,
+                     std::size_t count, std::uint64_t* out) {
+  for (std::size_t b = 0; b < count; b++) {
+    const std::uint64_t c = block + b;
+    const auto r = philox4x32(
+        {std::uint32_t(c), std::uint32_t(c >> 32), 0, 0},
+        {std::uint32_t(seed), std::uint32_t(seed >> 32)});
+    out[2 * b] = r[0] | std::uint64_t(r[1]) << 32;
+    out[2 * b + 1] = r[2] | std::uint64_t(r[3]) << 32;
+  }
+}
+
+// Same with vectors of `Bytes` bytes. Each lane keeps a 32-bit word in 64
+// bits, so that the 32 x 32 -> 64 bit products stay within the lane. U is a
+// parameter only so that GCC treats the vector type as dependent and keeps
+// its vector_size.
+template <std::size_t Bytes, typename U = std::uint64_t>
+[[gnu::always_inline]] inline void philox_blocks(std::uint64_t seed,
+                                                 std::uint64_t block,
+                                                 std::size_t count,
+                                                 std::uint64_t* out) {
+  using V [[gnu::vector_size(Bytes)]] = U;
+  constexpr std::size_t L = Bytes / sizeof(std::uint64_t);
+  // a round is a chain of dependent multiplies; G independent vectors in
+  // flight keep the multiplier busy
+  constexpr std::size_t G = 4;
+  constexpr std::uint64_t mask = 0xFFFFFFFF;
+  V lane;
+  for (std::size_t l = 0; l < L; l++) lane[l] = l;
+  std::size_t b = 0;
+  for (; b + G * L <= count; b += G * L) {
+    V c0[G], c1[G], c2[G], c3[G];
+    for (std::size_t g = 0; g < G; g++) {
+      const V counter = lane + (block + b + g * L);
+      c0[g] = counter & mask, c1[g] = counter >> 32, c2[g] = c3[g] = V{};
+    }
+    std::uint64_t k0 = seed & mask, k1 = seed >> 32;
+    for (int round = 0; round < 10; round++) {
+      for (std::size_t g = 0; g < G; g++) {
+        const V p0 = c0[g] * PHILOX_M0;
+        const V p1 = c2[g] * PHILOX_M1;
+        c0[g] = ((p1 >> 32) ^ c1[g] ^ k0) & mask;
+        c2[g] = ((p0 >> 32) ^ c3[g] ^ k1) & mask;
+        c1[g] = p1 & mask;
+        c3[g] = p0 & mask;
+      }
+      k0 = (k0 + PHILOX_W0) & mask;
+      k1 = (k1 + PHILOX_W1) & mask;
+    }
+    // interleave: block b + l gives values 2 * (b + l) and 2 * (b + l) + 1
+    for (std::size_t g = 0; g < G; g++) {
+      const V lo = c0[g] | (c1[g] << 32), hi = c2[g] | (c3[g] << 32);
+      std::uint64_t* dst = out + 2 * (b + g * L);
+      [&]<std::size_t... I>(std::index_sequence<I...>) {
+        const V first =
+            __builtin_shufflevector(lo, hi, (I / 2 + I % 2 * L)...);
+        const V second =
+            __builtin_shufflevector(lo, hi, (L / 2 + I / 2 + I % 2 * L)...);
+        std::memcpy(dst, &first, Bytes);
+        std::memcpy(dst + L, &second, Bytes);
+      }(std::make_index_sequence<L>());
+    }
+  }
+  philox_baseline(seed, block + b, count - b, out + 2 * b);
+}
+
+using BlocksKernel = void (*)(std::uint64_t, std::uint64_t, std::size_t,
+                              std::uint64_t*);
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ALGEBRA_RANDOM_X86 1
+
+[[gnu::target("avx512f")]] void philox_avx512(std::uint64_t seed,
+                                              std::uint64_t block,
+                                              std::size_t count,
+                                              std::uint64_t* out) {
+  philox_blocks<64>(seed, block, count, out);
+}
+#endif
+
+BlocksKernel philox_kernel() {
+  switch (simd_level()) {
+#if defined(ALGEBRA_RANDOM_X86)
+    case SimdLevel::AVX512:
+      return philox_avx512;
+#endif
+    default:
+      return philox_baseline;
+  }
+}
+
+std::uint64_t splitmix64(std::uint64_t x) {
+  x += 0x9E3779B97F4A7C15;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EB;
+  return x ^ (x >> 31);
+}
+}  // namespace
+
+std::array<std::uint32_t, 4> philox4x32(std::array<std::uint32_t, 4> counter,
+                                        std::array<std::uint32_t, 2> key) {
+  for (int round = 0; round < 10; round++) {
+    const std::uint64_t p0 = std::uint64_t(PHILOX_M0) * counter[0];
+    const std::uint64_t p1 = std::uint64_t(PHILOX_M1) * counter[2];
+    counter = {std::uint32_t(p1 >> 32) ^ counter[1] ^ key[0],
+               std::uint32_t(p1),
+               std::uint32_t(p0 >> 32) ^ counter[3] ^ key[1],
+               std::uint32_t(p0)};
+    key[0] += PHILOX_W0;
+    key[1] += PHILOX_W1;
+  }
+  return counter;
+}
+
+void philox_fill(std::uint64_t seed, std::uint64_t first, std::size_t count,
+                 std::uint64_t* out) {
+  if (count == 0) return;
+  // an odd first value or an odd last value uses half of a block
+  std::uint64_t pair[2];
+  if (first % 2) {
+    philox_baseline(seed, first / 2, 1, pair);
+    *out++ = pair[1];
+    first++;
+    count--;
+  }
+  philox_kernel()(seed, first / 2, count / 2, out);
+  if (count % 2) {
+    philox_baseline(seed, (first + count) / 2, 1, pair);
+    out[count - 1] = pair[0];
+  }
+}
+
+std::uint64_t random_seed() {
+  static const std::uint64_t base = [] {
+    std::random_device rd;
+    return std::uint64_t(rd()) << 32 | rd();
+  }();
+  static std::atomic<std::uint64_t> calls{0};
+  return splitmix64(base + calls.fetch_add(1, std::memory_order_relaxed));
+}
+
+}  // namespace algebra
@@ -0,0 +1,595 @@
+#include "simd.h"
+
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace algebra {
+namespace {
+// Kernel bodies, written once against GCC vector types of `Bytes` bytes.
+// They are always inlined into the per-ISA wrappers below, so each copy is
+// compiled with that wrapper's target options. Vectors never cross a
+// function boundary, which keeps the calling convention ISA independent.
+enum class Op { Add, Sub, Mul };
+
+template <std::size_t Bytes, Op op, typename T>
+[[gnu::always_inline]] inline void binary(const T* a, const T* b, T* out,
+                                          std::size_t n) {
+  using V [[gnu::vector_size(Bytes)]] = T;
+  constexpr std::size_t L = Bytes / sizeof(T);
+  std::size_t i = 0;
+  for (; i + L <= n; i += L) {
+    V x, y;
+    std::memcpy(&x, a + i, Bytes);
+    std::memcpy(&y, b + i, Bytes);
+    if constexpr (op == Op::Add) x += y;
+    if constexpr (op == Op::Sub) x -= y;
+    if constexpr (op == Op::Mul) x *= y;
+    std::memcpy(out + i, &x, Bytes);
+  }
+  for (; i < n; i++) {
+    if constexpr (op == Op::Add) out[i] = a[i] + b[i];
+    if constexpr (op == Op::Sub) out[i] = a[i] - b[i];
+    if constexpr (op == Op::Mul) out[i] = a[i] * b[i];
+  }
+}
+
+template <std::size_t Bytes, typename T>
+[[gnu::always_inline]] inline void scale(const T* a, T scalar, T* out,
+                                         std::size_t n) {
+  using V [[gnu::vector_size(Bytes)]] = T;
+  constexpr std::size_t L = Bytes / sizeof(T);
+  std::size_t i = 0;
+  for (; i + L <= n; i += L) {
+    V x;
+    std::memcpy(&x, a + i, Bytes);
+    x *= scalar;
+    std::memcpy(out + i, &x, Bytes);
+  }
+  for (; i < n; i++) out[i] = a[i] * scalar;
+}
+
+template <std::size_t Bytes, typename T>
+[[gnu::always_inline]] inline T sum(const T* a, std::size_t n) {
+  // two independent accumulators hide the add latency
+  using V [[gnu::vector_size(Bytes)]] = T;
+  constexpr std::size_t L = Bytes / sizeof(T);
+  V acc0 = {}, acc1 = {};
+  std::size_t i = 0;
+  for (; i + 2 * L <= n; i += 2 * L) {
+    V x0, x1;
+    std::memcpy(&x0, a + i, Bytes);
+    std::memcpy(&x1, a + i + L, Bytes);
+    acc0 += x0;
+    acc1 += x1;
+  }
+  acc0 += acc1;
+  T res = 0;
+  for (std::size_t l = 0; l < L; l++) res += acc0[l];
+  for (; i < n; i++) res += a[i];
+  return res;
+}
+
+template <std::size_t Bytes, typename T>
+[[gnu::always_inline]] inline T strided_sum(const T* a, std::size_t stride,
+                                            std::size_t n) {
+  using V [[gnu::vector_size(Bytes)]] = T;
+  constexpr std::size_t L = Bytes / sizeof(T);
+  V acc = {};
+  std::size_t i = 0;
+  for (; i + L <= n; i += L) {
+    V x;
+    for (std::size_t l = 0; l < L; l++) x[l] = a[(i + l) * stride];
+    acc += x;
+  }
+  T res = 0;
+  for (std::size_t l = 0; l < L; l++) res += acc[l];
+  for (; i < n; i++) res += a[i * stride];
+  return res;
+}
+
+template <std::size_t Bytes, typename T>
+[[gnu::always_inline]] inline T dot(const T* a, const T* b, std::size_t n) {
+  using V [[gnu::vector_size(Bytes)]] = T;
+  constexpr std::size_t L = Bytes / sizeof(T);
+  V acc0 = {}, acc1 = {};
+  std::size_t i = 0;
+  for (; i + 2 * L <= n; i += 2 * L) {
+    V x0, x1, y0, y1;
+    std::memcpy(&x0, a + i, Bytes);
+    std::memcpy(&x1, a + i + L, Bytes);
+    std::memcpy(&y0, b + i, Bytes);
+    std::memcpy(&y1, b + i + L, Bytes);
+    acc0 += x0 * y0;
+    acc1 += x1 * y1;
+  }
+  acc0 += acc1;
+  T res = 0;
+  for (std::size_t l = 0; l < L; l++) res += acc0[l];
+  for (; i < n; i++) res += a[i] * b[i];
+  return res;
+}
+
+// Kahan summation of a[i] (or a[i] * b[i] when Dot) in every lane of two
+// independent accumulators; the lanes and the tail are then folded in with
+// the same compensation
+template <std::size_t Bytes, bool Dot, typename T>
+[[gnu::always_inline]] inline T kahan(const T* a, const T* b, std::size_t n) {
+  using V [[gnu::vector_size(Bytes)]] = T;
+  constexpr std::size_t L = Bytes / sizeof(T);
+  V s0 = {}, s1 = {}, c0 = {}, c1 = {};
+  std::size_t i = 0;
+  for (; i + 2 * L <= n; i += 2 * L) {
+    V x0, x1;
+    std::memcpy(&x0, a + i, Bytes);
+    std::memcpy(&x1, a + i + L, Bytes);
+    if constexpr (Dot) {
+      V z0, z1;
+      std::memcpy(&z0, b + i, Bytes);
+      std::memcpy(&z1, b + i + L, Bytes);
+      x0 *= z0;
+      x1 *= z1;
+    }
+    const V y0 = x0 - c0, y1 = x1 - c1;
+    const V t0 = s0 + y0, t1 = s1 + y1;
+    c0 = (t0 - s0) - y0;
+    c1 = (t1 - s1) - y1;
+    s0 = t0;
+    s1 = t1;
+  }
+  T res = 0, comp = 0;
+  auto add = [&](T x) [[gnu::always_inline]] {
+    const T y = x - comp;
+    const T t = res + y;
+    comp = (t - res) - y;
+    res = t;
+  };
+  for (std::size_t l = 0; l < L; l++) {
+    add(s0[l]);
+    add(s1[l]);
+    add(-c0[l]);
+    add(-c1[l]);
+  }
+  for (; i < n; i++) add(Dot ? a[i] * b[i] : a[i]);
+  return res;
+}
+
+template <std::size_t Bytes, typename T>
+[[gnu::always_inline]] inline void axpy(T alpha, const T* x, T* y,
+                                        std::size_t n) {
+  using V [[gnu::vector_size(Bytes)]] = T;
+  constexpr std::size_t L = Bytes / sizeof(T);
+  std::size_t i = 0;
+  for (; i + L <= n; i += L) {
+    V u, v;
+    std::memcpy(&u, x + i, Bytes);
+    std::memcpy(&v, y + i, Bytes);
+    v += alpha * u;
+    std::memcpy(y + i, &v, Bytes);
+  }
+  // the tail takes the same vector path: a scalar y += alpha * x is not
+  // contracted to an FMA like the vector one, so elements would otherwise
+  // round differently depending on where the range ends
+  if (i < n) {
+    V u{}, v{};
+    std::memcpy(&u, x + i, (n - i) * sizeof(T));
+    std::memcpy(&v, y + i, (n - i) * sizeof(T));
+    v += alpha * u;
+    std::memcpy(y + i, &v, (n - i) * sizeof(T));
+  }
+}
+
+// Columns [j, n) of R consecutive rows of C = A * B; `a` and `c` point at
+// the first of those rows. The R rows share every load of B and give R
+// independent multiply-add chains. Each run of lanes is accumulated in
+// registers over the whole depth; narrower vectors, then scalars, take what
+// is left, so 3- or 4-wide matrices still use the vector unit.
+template <std::size_t Bytes, std::size_t R, typename T>
+[[gnu::always_inline]] inline void small_gemm_rows(const T* a, const T* b,
+                                                   T* c, std::size_t n,
+                                                   std::size_t k,
+                                                   std::size_t j) {
+  if constexpr (Bytes >= 2 * sizeof(T)) {
+    using V [[gnu::vector_size(Bytes)]] = T;
+    constexpr std::size_t L = Bytes / sizeof(T);
+    for (; j + L <= n; j += L) {
+      V acc[R] = {};
+      for (std::size_t p = 0; p < k; p++) {
+        V x;
+        std::memcpy(&x, b + p * n + j, Bytes);
+        for (std::size_t r = 0; r < R; r++) acc[r] += a[r * k + p] * x;
+      }
+      for (std::size_t r = 0; r < R; r++)
+        std::memcpy(c + r * n + j, &acc[r], Bytes);
+    }
+    small_gemm_rows<Bytes / 2, R>(a, b, c, n, k, j);
+  } else {
+    for (; j < n; j++) {
+      T acc[R] = {};
+      for (std::size_t p = 0; p < k; p++)
+        for (std::size_t r = 0; r < R; r++)
+          acc[r] += a[r * k + p] * b[p * n + j];
+      for (std::size_t r = 0; r < R; r++) c[r * n + j] = acc[r];
+    }
+  }
+}
+
+template <std::size_t Bytes, typename T>
+[[gnu::always_inline]] inline void gemm_batched(
+    std::size_t batch, std::size_t m, std::size_t n, std::size_t k,
+    const T* a, std::size_t stride_a, const T* b, std::size_t stride_b, T* c,
+    std::size_t stride_c) {
+  for (std::size_t s = 0; s < batch; s++) {
+    const T* as = a + s * stride_a;
+    const T* bs = b + s * stride_b;
+    T* cs = c + s * stride_c;
+    std::size_t i = 0;
+    for (; i + 4 <= m; i += 4)
+      small_gemm_rows<Bytes, 4>(as + i * k, bs, cs + i * n, n, k, 0);
+    for (; i < m; i++)
+      small_gemm_rows<Bytes, 1>(as + i * k, bs, cs + i * n, n, k, 0);
+  }
+}
+
+// One stage of an L x L in-register transpose: rows i and i + H (bit H of
+// i clear) swap their off-diagonal H-wide halves, which exchanges bit H of
+// the row and the column index. log2(L) stages transpose the tile.
+template <std::size_t L, std::size_t H, typename V, std::size_t... J>
+[[gnu::always_inline]] inline void transpose_stage(
+    V& x, V& y, std::index_sequence<J...>) {
+  const V lo = __builtin_shufflevector(x, y, ((J & H) ? L + J - H : J)...);
+  const V hi = __builtin_shufflevector(x, y, ((J & H) ? L + J : J + H)...);
+  x = lo;
+  y = hi;
+}
+
+template <std::size_t L, std::size_t H, typename V, std::size_t... I>
+[[gnu::always_inline]] inline void transpose_stages(V (&r)[L],
+                                                    std::index_sequence<I...>) {
+  if constexpr (H > 0) {
+    auto pair = [&]<std::size_t P>(std::integral_constant<std::size_t, P>) {
+      if constexpr ((P & H) == 0)
+        transpose_stage<L, H>(r[P], r[P + H], std::index_sequence<I...>());
+    };
+    (pair(std::integral_constant<std::size_t, I>()), ...);
+    transpose_stages<L, H / 2>(r, std::index_sequence<I...>());
+  }
+}
+
+// L x L tile at src into dst, with every loop unrolled so the tile stays in
+// registers
+template <std::size_t Bytes, typename T, std::size_t... I>
+[[gnu::always_inline]] inline void transpose_tile(const T* src,
+                                                  std::size_t src_stride,
+                                                  T* dst,
+                                                  std::size_t dst_stride,
+                                                  std::index_sequence<I...>) {
+  using V [[gnu::vector_size(Bytes)]] = T;
+  constexpr std::size_t L = Bytes / sizeof(T);
+  V r[L];
+  (std::memcpy(&r[I], src + I * src_stride, Bytes), ...);
+  transpose_stages<L, L / 2>(r, std::index_sequence<I...>());
+  (std::memcpy(dst + I * dst_stride, &r[I], Bytes), ...);
+}
+
+template <std::size_t Bytes, typename T>
+[[gnu::always_inline]] inline void transpose(const T* src,
+                                             std::size_t src_stride, T* dst,
+                                             std::size_t dst_stride,
+                                             std::size_t rows,
+                                             std::size_t cols) {
+  constexpr std::size_t L = Bytes / sizeof(T);
+  std::size_t i = 0;
+  for (; i + L <= rows; i += L) {
+    std::size_t j = 0;
+    for (; j + L <= cols; j += L)
+      transpose_tile<Bytes>(src + i * src_stride + j, src_stride,
+                            dst + j * dst_stride + i, dst_stride,
+                            std::make_index_sequence<L>());
+    for (; j < cols; j++)
+      for (std::size_t l = 0; l < L; l++)
+        dst[j * dst_stride + i + l] = src[(i + l) * src_stride + j];
+  }
+  for (; i < rows; i++)
+    for (std::size_t j = 0; j < cols; j++)
+      dst[j * dst_stride + i] = src[i * src_stride + j];
+}
+
+// One table of kernels per element type and instruction set
+template <typename T>
+struct Kernels {
+  void (*add)(const T*, const T*, T*, std::size_t);
+  void (*sub)(const T*, const T*, T*, std::size_t);
+  void (*mul)(const T*, const T*, T*, std::size_t);
+  void (*scale)(const T*, T, T*, std::size_t);
+  T (*sum)(const T*, std::size_t);
+  T (*strided_sum)(const T*, std::size_t, std::size_t);
+  T (*dot)(const T*, const T*, std::size_t);
+  T (*sum_kahan)(const T*, std::size_t);
+  T (*dot_kahan)(const T*, const T*, std::size_t);
+  void (*axpy)(T, const T*, T*, std::size_t);
+  void (*gemm_batched)(std::size_t, std::size_t, std::size_t, std::size_t,
+                       const T*, std::size_t, const T*, std::size_t, T*,
+                       std::size_t);
+  void (*transpose)(const T*, std::size_t, T*, std::size_t, std::size_t,
+                    std::size_t);
+};
+
+template <std::size_t Bytes, typename T>
+constexpr Kernels<T> baseline_kernels() {
+  return {
+      [](const T* a, const T* b, T* out, std::size_t n) {
+        binary<Bytes, Op::Add>(a, b, out, n);
+      },
+      [](const T* a, const T* b, T* out, std::size_t n) {
+        binary<Bytes, Op::Sub>(a, b, out, n);
+      },
+      [](const T* a, const T* b, T* out, std::size_t n) {
+        binary<Bytes, Op::Mul>(a, b, out, n);
+      },
+      [](const T* a, T s, T* out, std::size_t n) {
+        scale<Bytes>(a, s, out, n);
+      },
+      [](const T* a, std::size_t n) { return sum<Bytes>(a, n); },
+      [](const T* a, std::size_t stride, std::size_t n) {
+        return strided_sum<Bytes>(a, stride, n);
+      },
+      [](const T* a, const T* b, std::size_t n) { return dot<Bytes>(a, b, n); },
+      [](const T* a, std::size_t n) {
+        return kahan<Bytes, false>(a, a, n);
+      },
+      [](const T* a, const T* b, std::size_t n) {
+        return kahan<Bytes, true>(a, b, n);
+      },
+      [](T alpha, const T* x, T* y, std::size_t n) {
+        axpy<Bytes>(alpha, x, y, n);
+      },
+      [](std::size_t batch, std::size_t m, std::size_t n, std::size_t k,
+         const T* a, std::size_t sa, const T* b, std::size_t sb, T* c,
+         std::size_t sc) {
+        gemm_batched<Bytes>(batch, m, n, k, a, sa, b, sb, c, sc);
+      },
+      [](const T* src, std::size_t ss, T* dst, std::size_t ds,
+         std::size_t rows, std::size_t cols) {
+        transpose<Bytes>(src, ss, dst, ds, rows, cols);
+      },
+  };
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ALGEBRA_SIMD_X86 1
+
+template <typename T>
+struct Avx2 {
+  [[gnu::target("avx2,fma")]] static void add(const T* a, const T* b, T* out,
+                                              std::size_t n) {
+    binary<32, Op::Add>(a, b, out, n);
+  }
+  [[gnu::target("avx2,fma")]] static void sub(const T* a, const T* b, T* out,
+                                              std::size_t n) {
+    binary<32, Op::Sub>(a, b, out, n);
+  }
+  [[gnu::target("avx2,fma")]] static void mul(const T* a, const T* b, T* out,
+                                              std::size_t n) {
+    binary<32, Op::Mul>(a, b, out, n);
+  }
+  [[gnu::target("avx2,fma")]] static void scale(const T* a, T s, T* out,
+                                                std::size_t n) {
+    algebra::scale<32>(a, s, out, n);
+  }
+  [[gnu::target("avx2,fma")]] static T sum(const T* a, std::size_t n) {
+    return algebra::sum<32>(a, n);
+  }
+  [[gnu::target("avx2,fma")]] static T strided_sum(const T* a,
+                                                   std::size_t stride,
+                                                   std::size_t n) {
+    return algebra::strided_sum<32>(a, stride, n);
+  }
+  [[gnu::target("avx2,fma")]] static T dot(const T* a, const T* b,
+                                           std::size_t n) {
+    return algebra::dot<32>(a, b, n);
+  }
+  [[gnu::target("avx2,fma")]] static T sum_kahan(const T* a,
+                                                 std::size_t n) {
+    return algebra::kahan<32, false>(a, a, n);
+  }
+  [[gnu::target("avx2,fma")]] static T dot_kahan(const T* a, const T* b,
+                                                 std::size_t n) {
+    return algebra::kahan<32, true>(a, b, n);
+  }
+  [[gnu::target("avx2,fma")]] static void axpy(T alpha, const T* x, T* y,
+                                               std::size_t n) {
+    algebra::axpy<32>(alpha, x, y, n);
+  }
+  [[gnu::target("avx2,fma")]] static void gemm_batched(
+      std::size_t batch, std::size_t m, std::size_t n, std::size_t k,
+      const T* a, std::size_t sa, const T* b, std::size_t sb, T* c,
+      std::size_t sc) {
+    algebra::gemm_batched<32>(batch, m, n, k, a, sa, b, sb, c, sc);
+  }
+  [[gnu::target("avx2,fma")]] static void transpose(
+      const T* src, std::size_t ss, T* dst, std::size_t ds, std::size_t rows,
+      std::size_t cols) {
+    algebra::transpose<32>(src, ss, dst, ds, rows, cols);
+  }
+  static constexpr Kernels<T> table{
+      add,       sub,       mul,  scale,        sum,      strided_sum, dot,
+      sum_kahan, dot_kahan, axpy, gemm_batched, transpose};
+};
+
+template <typename T>
+struct Avx512 {
+  [[gnu::target("avx512f,avx512dq")]] static void add(const T* a, const T* b,
+                                                      T* out, std::size_t n) {
+    binary<64, Op::Add>(a, b, out, n);
+  }
+  [[gnu::target("avx512f,avx512dq")]] static void sub(const T* a, const T* b,
+                                                      T* out, std::size_t n) {
+    binary<64, Op::Sub>(a, b, out, n);
+  }
+  [[gnu::target("avx512f,avx512dq")]] static void mul(const T* a, const T* b,
+                                                      T* out, std::size_t n) {
+    binary<64, Op::Mul>(a, b, out, n);
+  }
+  [[gnu::target("avx512f,avx512dq")]] static void scale(const T* a, T s,
+                                                        T* out,
+                                                        std::size_t n) {
+    algebra::scale<64>(a, s, out, n);
+  }
+  [[gnu::target("avx512f,avx512dq")]] static T sum(const T* a,
+                                                   std::size_t n) {
+    return algebra::sum<64>(a, n);
+  }
+  [[gnu::target("avx512f,avx512dq")]] static T strided_sum(
+      const T* a, std::size_t stride, std::size_t n) {
+    return algebra::strided_sum<64>(a, stride, n);
+  }
+  [[gnu::target("avx512f,avx512dq")]] static T dot(const T* a, const T* b,
+                                                   std::size_t n) {
+    return algebra::dot<64>(a, b, n);
+  }
+  [[gnu::target("avx512f,avx512dq")]] static T sum_kahan(const T* a,
+                                                         std::size_t n) {
+    return algebra::kahan<64, false>(a, a, n);
+  }
+  [[gnu::target("avx512f,avx512dq")]] static T dot_kahan(const T* a,
+                                                         const T* b,
+                                                         std::size_t n) {
+    return algebra::kahan<64, true>(a, b, n);
+  }
+  [[gnu::target("avx512f,avx512dq")]] static void axpy(T alpha, const T* x,
+                                                       T* y, std::size_t n) {
+    algebra::axpy<64>(alpha, x, y, n);
+  }
+  [[gnu::target("avx512f,avx512dq")]] static void gemm_batched(
+      std::size_t batch, std::size_t m, std::size_t n, std::size_t k,
+      const T* a, std::size_t sa, const T* b, std::size_t sb, T* c,
+      std::size_t sc) {
+    algebra::gemm_batched<64>(batch, m, n, k, a, sa, b, sb, c, sc);
+  }
+  [[gnu::target("avx512f,avx512dq")]] static void transpose(
+      const T* src, std::size_t ss, T* dst, std::size_t ds, std::size_t rows,
+      std::size_t cols) {
+    algebra::transpose<64>(src, ss, dst, ds, rows, cols);
+  }
+  static constexpr Kernels<T> table{
+      add,       sub,       mul,  scale,        sum,      strided_sum, dot,
+      sum_kahan, dot_kahan, axpy, gemm_batched, transpose};
+};
+#endif
+
+SimdLevel detect() {
+#if defined(ALGEBRA_SIMD_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") and __builtin_cpu_supports("avx512dq"))
+    return SimdLevel::AVX512;
+  if (__builtin_cpu_supports("avx2") and __builtin_cpu_supports("fma"))
+    return SimdLevel::AVX2;
+  return SimdLevel::Scalar;
+#elif defined(__ARM_NEON)
+  return SimdLevel::NEON;
+#else
+  return SimdLevel::Scalar;
+#endif
+}
+
+std::atomic<SimdLevel>& active_level() {
+  static std::atomic<SimdLevel> level{detected_simd_level()};
+  return level;
+}
+
+template <typename T>
+const Kernels<T>& kernels() {
+  // 16-byte vectors are SSE2 on x86-64 and NEON on AArch64
+  static constexpr Kernels<T> baseline = baseline_kernels<16, T>();
+  switch (active_level().load(std::memory_order_relaxed)) {
+#if defined(ALGEBRA_SIMD_X86)
+    case SimdLevel::AVX512:
+      return Avx512<T>::table;
+    case SimdLevel::AVX2:
+      return Avx2<T>::table;
+#endif
+    default:
+      return baseline;
+  }
+}
+}  // namespace
+
+SimdLevel detected_simd_level() {
+  static const SimdLevel level = detect();
+  return level;
+}
+
+SimdLevel simd_level() { return active_level().load(); }
+
+void set_simd_level(SimdLevel level) {
+  if (static_cast<int>(level) > static_cast<int>(detected_simd_level()) or
+      (level == SimdLevel::NEON) != (detected_simd_level() == SimdLevel::NEON))
+    level = detected_simd_level();
+  active_level().store(level);
+}
+
+const char* simd_level_name(SimdLevel level) {
+  switch (level) {
+    case SimdLevel::AVX2:
+      return "avx2";
+    case SimdLevel::AVX512:
+      return "avx512";
+    case SimdLevel::NEON:
+      return "neon";
+    default:
+      return "scalar";
+  }
+}
+
+#define ALGEBRA_SIMD_DEFINE(T)                                           \
+  void simd_add(const T* a, const T* b, T* out, std::size_t n) {         \
+    kernels<T>().add(a, b, out, n);                                      \
+  }                                                                      \
+  void simd_sub(const T* a, const T* b, T* out, std::size_t n) {         \
+    kernels<T>().sub(a, b, out, n);                                      \
+  }                                                                      \
+  void simd_mul(const T* a, const T* b, T* out, std::size_t n) {         \
+    kernels<T>().mul(a, b, out, n);                                      \
+  }                                                                      \
+  void simd_scale(const T* a, T scalar, T* out, std::size_t n) {         \
+    kernels<T>().scale(a, scalar, out, n);                               \
+  }                                                                      \
+  T simd_sum(const T* a, std::size_t n) { return kernels<T>().sum(a, n); } \
+  T simd_strided_sum(const T* a, std::size_t stride, std::size_t n) {    \
+    return kernels<T>().strided_sum(a, stride, n);                       \
+  }                                                                      \
+  T simd_dot(const T* a, const T* b, std::size_t n) {                    \
+    return kernels<T>().dot(a, b, n);                                    \
+  }                                                                      \
+  T simd_sum_kahan(const T* a, std::size_t n) {                          \
+    return kernels<T>().sum_kahan(a, n);                                 \
+  }                                                                      \
+  T simd_dot_kahan(const T* a, const T* b, std::size_t n) {              \
+    return kernels<T>().dot_kahan(a, b, n);                              \
+  }                                                                      \
+  void simd_axpy(T alpha, const T* x, T* y, std::size_t n) {             \
+    kernels<T>().axpy(alpha, x, y, n);                                   \
+  }                                                                      \
+  void simd_gemm_batched(std::size_t batch, std::size_t m, std::size_t n, \
+                         std::size_t k, const T* a, std::size_t stride_a, \
+                         const T* b, std::size_t stride_b, T* c,          \
+                         std::size_t stride_c) {                          \
+    kernels<T>().gemm_batched(batch, m, n, k, a, stride_a, b, stride_b, c, \
+                              stride_c);                                  \
+  }                                                                       \
+  void simd_transpose(const T* src, std::size_t src_stride, T* dst,       \
+                      std::size_t dst_stride, std::size_t rows,           \
+                      std::size_t cols) {                                 \
+    kernels<T>().transpose(src, src_stride, dst, dst_stride, rows, cols); \
+  }
+
+ALGEBRA_SIMD_DEFINE(float)
+ALGEBRA_SIMD_DEFINE(double)
+ALGEBRA_SIMD_DEFINE(std::int32_t)
+ALGEBRA_SIMD_DEFINE(std::int64_t)
+
+#undef ALGEBRA_SIMD_DEFINE
+
+}  // namespace algebra
@@ -0,0 +1,182 @@
+#include "thread_pool.h"
+
+#include <exception>
+#include <stdexcept>
+#include <utility>
+
+namespace algebra {
+namespace {
+// Set on pool workers so nested parallel_for() calls run inline
+thread_local bool inside_pool_task = false;
+
+std::mutex pool_mutex;
+// Replaced by set_num_threads(); loops in flight hold their own reference
+std::shared_ptr<ThreadPool> pool;
+std::size_t configured_threads = 0;
+// Size of `pool` once it exists, so get_num_threads() needs no lock
+std::atomic<std::size_t> pool_threads{0};
+
+// Swap in a new pool under pool_mutex and return the old one, which the
+// caller releases after unlocking: its destructor joins the workers
+std::shared_ptr<ThreadPool> reset_pool(std::size_t num_threads) {
+  std::shared_ptr<ThreadPool> old =
+      std::exchange(pool, std::make_shared<ThreadPool>(num_threads));
+  pool_threads.store(pool->num_threads(), std::memory_order_release);
+  return old;
+}
+
+std::size_t resolve_threads(std::size_t num_threads) {
+  // hardware_concurrency() reads /sys on Linux, far too slow per call
+  static const std::size_t hardware = std::thread::hardware_concurrency();
+  if (num_threads == 0)
+    num_threads = tuning().threads != 0 ? tuning().threads : hardware;
+  return std::max<std::size_t>(num_threads, 1);
+}
+}  // namespace
+
+ThreadPool::ThreadPool(std::size_t num_threads) {
+  num_threads = std::max<std::size_t>(num_threads, 1);
+  for (std::size_t i = 0; i < num_threads; i++)
+    queues_.push_back(std::make_unique<WorkQueue>());
+  for (std::size_t i = 1; i < num_threads; i++)
+    workers_.emplace_back([this, i] { worker_loop(i); });
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto& worker : workers_) worker.join();
+}
+
+void ThreadPool::push(std::size_t queue, Task task) {
+  {
+    std::lock_guard<std::mutex> lock(queues_[queue]->mutex);
+    queues_[queue]->tasks.push_back(std::move(task));
+  }
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    queued_++;
+  }
+  wake_.notify_one();
+}
+
+bool ThreadPool::run_one(std::size_t self) {
+  Task task;
+  for (std::size_t n = 0; n < queues_.size() and !task; n++) {
+    WorkQueue& queue = *queues_[(self + n) % queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) continue;
+    if (n == 0) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    } else {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    }
+  }
+  if (!task) return false;
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    queued_--;
+  }
+  task();
+  return true;
+}
+
+void ThreadPool::worker_loop(std::size_t self) {
+  inside_pool_task = true;
+  while (true) {
+    if (run_one(self)) continue;
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    wake_.wait(lock, [this] { return stop_ or queued_ > 0; });
+    if (stop_ and queued_ == 0) return;
+  }
+}
+
+void ThreadPool::parallel_for(std::size_t count,
+                              const std::function<void(std::size_t)>& body) {
+  if (count == 0) return;
+  if (count == 1 or workers_.empty() or inside_pool_task) {
+    for (std::size_t i = 0; i < count; i++) body(i);
+    return;
+  }
+
+  // `remaining` is only touched under done_mutex, so once the caller sees
+  // zero no task can still be using the locals below
+  std::size_t remaining = count;
+  std::mutex done_mutex;
+  std::condition_variable done;
+  std::exception_ptr error;
+
+  // tasks of a first-use tune() must see the parameters being measured
+  Tuning* const measuring = tuning_in_progress();
+  for (std::size_t i = 0; i < count; i++) {
+    push(i % queues_.size(), [&, i] {
+      Tuning* const outer = std::exchange(tuning_in_progress(), measuring);
+      std::exception_ptr task_error;
+      try {
+        body(i);
+      } catch (...) {
+        task_error = std::current_exception();
+      }
+      tuning_in_progress() = outer;
+      std::lock_guard<std::mutex> lock(done_mutex);
+      if (task_error and !error) error = task_error;
+      if (--remaining == 0) done.notify_all();
+    });
+  }
+
+  // help out until our tasks are finished
+  inside_pool_task = true;
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(done_mutex);
+      if (remaining == 0) break;
+    }
+    if (run_one(0)) continue;
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done.wait(lock, [&] { return remaining == 0; });
+  }
+  inside_pool_task = false;
+
+  if (error) std::rethrow_exception(error);
+}
+
+// tuning() is called before taking the pool lock: its first call may run
+// tune(), which sets the thread count
+
+std::shared_ptr<ThreadPool> thread_pool() {
+  tuning();
+  std::lock_guard<std::mutex> lock(pool_mutex);
+  if (!pool) reset_pool(resolve_threads(configured_threads));
+  return pool;
+}
+
+void set_num_threads(std::size_t num_threads) {
+  // a task would otherwise wait for (or join) the pool it runs on
+  if (inside_pool_task) {
+    throw std::logic_error("set_num_threads() cannot run inside a task.");
+  }
+  tuning();
+  std::shared_ptr<ThreadPool> old;
+  {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    configured_threads = num_threads;
+    if (pool and pool->num_threads() == resolve_threads(num_threads)) return;
+    old = reset_pool(resolve_threads(num_threads));
+  }
+}
+
+std::size_t get_num_threads() {
+  // every parallel_for() asks, so the common case is a single atomic load
+  const std::size_t threads = pool_threads.load(std::memory_order_acquire);
+  if (threads != 0) return threads;
+  tuning();
+  std::lock_guard<std::mutex> lock(pool_mutex);
+  return pool ? pool->num_threads() : resolve_threads(configured_threads);
+}
+
+}  // namespace algebra
@@ -0,0 +1,395 @@
+#include "tune.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gemm.h"
+#include "matrix.h"
+#include "simd.h"
+#include "thread_pool.h"
+#include "transpose.h"
+
+namespace algebra {
+namespace {
+constexpr char HEADER[] = "# algebra tuning v1";
+constexpr std::size_t NEVER = std::numeric_limits<std::size_t>::max();
+
+Tuning current;
+std::atomic<bool> ready{false};
+std::mutex init_mutex;
+
+std::string host_name() {
+  char name[256] = {};
+  if (gethostname(name, sizeof(name) - 1) != 0 or name[0] == '\0')
+    return "localhost";
+  return name;
+}
+
+// The CPU a cache file was measured on
+std::string cpu_stamp() {
+  return std::string(simd_level_name(detected_simd_level())) + " " +
+         std::to_string(std::thread::hardware_concurrency());
+}
+
+bool autotune_requested() {
+  const char* value = std::getenv("ALGEBRA_AUTOTUNE");
+  return value != nullptr and std::string(value) == "1";
+}
+
+// The parameters tune() measures with and tuning() returns on this thread
+Tuning& active() {
+  Tuning* measuring = tuning_in_progress();
+  return measuring != nullptr ? *measuring : current;
+}
+
+// Clears tuning_in_progress() however the first-use tune() ends
+struct MeasuringScope {
+  explicit MeasuringScope(Tuning& tuning) { tuning_in_progress() = &tuning; }
+  ~MeasuringScope() { tuning_in_progress() = nullptr; }
+};
+
+// Other threads wait on init_mutex until the result is published, so none
+// of them sees a half-measured Tuning or the pools tune() keeps replacing
+void initialize() {
+  std::lock_guard<std::mutex> lock(init_mutex);
+  if (ready.load(std::memory_order_acquire)) return;
+  std::optional<Tuning> cached;
+  try {
+    cached = load_tuning(tuning_cache_path());
+  } catch (const std::runtime_error&) {
+    // a broken cache file is measured again (or ignored)
+  }
+  Tuning result = cached.value_or(Tuning{});
+  if (!cached and autotune_requested()) {
+    // tune() and the loops it times see `result` through tuning()
+    const MeasuringScope scope(result);
+    try {
+      tune();
+    } catch (const std::runtime_error&) {
+      // the winners stay in `result` even if the cache cannot be written
+    }
+  }
+  current = result;
+  ready.store(true, std::memory_order_release);
+}
+
+// Fastest of `runs` runs of f, in seconds
+template <typename F>
+double best_time(std::size_t runs, F&& f) {
+  double best = std::numeric_limits<double>::infinity();
+  for (std::size_t r = 0; r < runs; r++) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  return best;
+}
+
+// Coordinate descent from the default blocking: kc, then mc, then nc,
+// each on an n x n x n product
+template <typename T>
+GemmBlocking tune_gemm(std::size_t n, std::size_t runs) {
+  const auto a =
+      create_matrix<Matrix<T>>(n, n, MatrixType::Random, T(-1), T(1), 1);
+  const auto b =
+      create_matrix<Matrix<T>>(n, n, MatrixType::Random, T(-1), T(1), 2);
+  Matrix<T> c(n, n);
+  auto time = [&](GemmBlocking blocking) {
+    return best_time(runs, [&] {
+      gemm_blocked<T>(
+          n, n, n, [&](std::size_t i, std::size_t p) { return a(i, p); },
+          [&](std::size_t p, std::size_t j) { return b(p, j); },
+          [&](std::size_t i, std::size_t j) -> T& { return c(i, j); },
+          blocking);
+    });
+  };
+  GemmBlocking best = GemmTraits<T>::blocking;
+  double best_seconds = time(best);
+  auto consider = [&](GemmBlocking candidate) {
+    if (candidate == best) return;
+    const double seconds = time(candidate);
+    if (seconds < best_seconds) {
+      best = candidate;
+      best_seconds = seconds;
+    }
+  };
+  for (std::size_t kc : {128, 192, 256, 384, 512})
+    consider({best.mc, kc, best.nc});
+  for (std::size_t mc : {48, 72, 96, 128, 192})
+    consider({mc, best.kc, best.nc});
+  for (std::size_t nc : {512, 1024, 2048, 4096})
+    consider({best.mc, best.kc, nc});
+  return best;
+}
+
+std::size_t tune_transpose_leaf(std::size_t n, std::size_t runs) {
+  const auto a = create_matrix<Matrix<double>>(n, n, MatrixType::Random,
+                                               -1.0, 1.0, 3);
+  Matrix<double> t(n, n);
+  std::size_t best = TRANSPOSE_LEAF_BYTES;
+  double best_seconds = std::numeric_limits<double>::infinity();
+  for (std::size_t bytes : {4096, 8192, 16384, 32768, 65536}) {
+    active().transpose_leaf_bytes = bytes;
+    const double seconds = best_time(runs, [&] {
+      transpose_blocked(n, n, a.data(), a.stride(), t.data(), t.stride());
+    });
+    if (seconds < best_seconds) {
+      best = bytes;
+      best_seconds = seconds;
+    }
+  }
+  return best;
+}
+
+std::size_t tune_threads(std::size_t n, std::size_t runs) {
+  const std::size_t hardware =
+      std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+  const auto a = create_matrix<Matrix<double>>(n, n, MatrixType::Random,
+                                               -1.0, 1.0, 4);
+  std::vector<std::size_t> candidates;
+  for (std::size_t t = 1; t < hardware; t *= 2) candidates.push_back(t);
+  candidates.push_back(hardware);
+  std::size_t best = hardware;
+  double best_seconds = std::numeric_limits<double>::infinity();
+  for (std::size_t threads : candidates) {
+    set_num_threads(threads);
+    const double seconds = best_time(runs, [&] { multiply(a, a); });
+    if (seconds < best_seconds) {
+      best = threads;
+      best_seconds = seconds;
+    }
+  }
+  return best;
+}
+
+// Smallest cube from which the blocked kernel beats the plain loop
+std::size_t tune_gemm_cutoff(std::size_t runs) {
+  for (std::size_t n : {8, 12, 16, 24, 32, 48, 64, 96}) {
+    const auto a = create_matrix<Matrix<double>>(n, n, MatrixType::Random,
+                                                 -1.0, 1.0, 5);
+    // enough products per run to time reliably
+    const std::size_t repeat =
+        std::max<std::size_t>(1, (1 << 20) / (n * n * n));
+    auto time = [&](std::size_t min_ops) {
+      active().gemm_min_ops = min_ops;
+      return best_time(runs, [&] {
+        for (std::size_t r = 0; r < repeat; r++) multiply(a, a);
+      });
+    };
+    if (time(1) <= time(NEVER)) return n * n * n;
+  }
+  return 128 * 128 * 128;
+}
+
+// Smallest element count from which an addition is faster on all threads
+std::size_t tune_parallel_cutoff(std::size_t runs) {
+  if (get_num_threads() <= 1) return PARALLEL_MIN_ELEMENTS;
+  constexpr std::size_t cols = 256;
+  for (std::size_t elements = 1 << 12; elements <= 1 << 22; elements *= 2) {
+    const auto a = create_matrix<Matrix<float>>(
+        elements / cols, cols, MatrixType::Random, -1.0f, 1.0f, 6);
+    const std::size_t repeat = std::max<std::size_t>(1, (1 << 22) / elements);
+    auto time = [&](std::size_t min_elements) {
+      active().parallel_min_elements = min_elements;
+      return best_time(runs, [&] {
+        for (std::size_t r = 0; r < repeat; r++) sum_sub(a, a);
+      });
+    };
+    if (time(1) < time(NEVER)) return elements;
+  }
+  return 1 << 22;
+}
+
+// Largest blocking dimension and thread count a cache file may hold
+constexpr std::size_t MAX_BLOCK = 1 << 16;
+constexpr std::size_t MAX_THREADS = 1024;
+
+// The blocking if the packing can run with it, the default (zero) if not
+template <typename T>
+GemmBlocking checked_blocking(const GemmBlocking& blocking) {
+  const bool valid =
+      blocking.mc != 0 and blocking.kc != 0 and blocking.nc != 0 and
+      blocking.mc <= MAX_BLOCK and blocking.kc <= MAX_BLOCK and
+      blocking.nc <= MAX_BLOCK and blocking.mc % GemmTraits<T>::MR == 0 and
+      blocking.nc % GemmTraits<T>::NR == 0;
+  return valid ? blocking : GemmBlocking{0, 0, 0};
+}
+
+// `value` if it lies in [low, high], the default (zero) otherwise
+std::size_t checked(std::size_t value, std::size_t low, std::size_t high) {
+  return value >= low and value <= high ? value : 0;
+}
+
+// A corrupted or hand-edited file must not hand the kernels parameters
+// they cannot run with, so every loaded value is checked on its own
+Tuning checked_tuning(const Tuning& loaded) {
+  Tuning res = loaded;
+  res.gemm4 = checked_blocking<float>(loaded.gemm4);
+  res.gemm8 = checked_blocking<double>(loaded.gemm8);
+  res.transpose_leaf_bytes =
+      checked(loaded.transpose_leaf_bytes, 256, 16 * 1024 * 1024);
+  res.threads = checked(loaded.threads, 1, MAX_THREADS);
+  return res;
+}
+
+std::size_t parse_number(std::istringstream& line) {
+  std::size_t value;
+  if (!(line >> value)) throw std::runtime_error("Invalid tuning file.");
+  return value;
+}
+}  // namespace
+
+Tuning*& tuning_in_progress() {
+  thread_local Tuning* measuring = nullptr;
+  return measuring;
+}
+
+const Tuning& tuning() {
+  if (ready.load(std::memory_order_acquire)) return current;
+  if (const Tuning* measuring = tuning_in_progress()) return *measuring;
+  initialize();
+  return current;
+}
+
+void set_tuning(const Tuning& tuning) {
+  // make sure a pending first-use load cannot overwrite it later
+  algebra::tuning();
+  current = tuning;
+}
+
+Tuning tune(const TuneOptions& options) {
+  tuning();
+  Tuning& target = active();
+  const Tuning previous = target;
+  const std::size_t runs = options.quick ? 1 : 3;
+  Tuning result;
+  try {
+    // the single-thread parameters first, from the defaults
+    target = Tuning{};
+    set_num_threads(1);
+    result.gemm4 = tune_gemm<float>(options.quick ? 96 : 512, runs);
+    result.gemm8 = tune_gemm<double>(options.quick ? 96 : 512, runs);
+    target.gemm4 = result.gemm4;
+    target.gemm8 = result.gemm8;
+    result.transpose_leaf_bytes =
+        tune_transpose_leaf(options.quick ? 256 : 2048, runs);
+    target.transpose_leaf_bytes = result.transpose_leaf_bytes;
+    // then the cutoffs with the winning thread count
+    result.threads = tune_threads(options.quick ? 128 : 768, runs);
+    target.threads = result.threads;
+    set_num_threads(0);
+    result.gemm_min_ops = tune_gemm_cutoff(runs);
+    target.gemm_min_ops = result.gemm_min_ops;
+    result.parallel_min_elements = tune_parallel_cutoff(runs);
+  } catch (...) {
+    target = previous;
+    set_num_threads(0);
+    throw;
+  }
+  target = result;
+  if (options.save) save_tuning(result, tuning_cache_path());
+  return result;
+}
+
+std::filesystem::path tuning_cache_path() {
+  if (const char* path = std::getenv("ALGEBRA_TUNING_CACHE");
+      path != nullptr and path[0] != '\0')
+    return path;
+  std::filesystem::path dir;
+  if (const char* xdg = std::getenv("XDG_CACHE_HOME");
+      xdg != nullptr and xdg[0] != '\0') {
+    dir = xdg;
+  } else if (const char* home = std::getenv("HOME");
+             home != nullptr and home[0] != '\0') {
+    dir = std::filesystem::path(home) / ".cache";
+  } else {
+    dir = std::filesystem::temp_directory_path();
+  }
+  return dir / "aut_ap_algebra" / ("tuning-" + host_name() + ".txt");
+}
+
+void save_tuning(const Tuning& tuning, const std::filesystem::path& path) {
+  if (path.has_parent_path()) {
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+  }
+  // written next to the target and renamed, so readers never see half a file
+  const std::filesystem::path temporary = path.string() + ".tmp";
+  {
+    std::ofstream file(temporary);
+    if (!file) {
+      throw std::runtime_error("Cannot open " + temporary.string() + ".");
+    }
+    file << HEADER << '\n'
+         << "host " << host_name() << '\n'
+         << "cpu " << cpu_stamp() << '\n'
+         << "gemm4 " << tuning.gemm4.mc << ' ' << tuning.gemm4.kc << ' '
+         << tuning.gemm4.nc << '\n'
+         << "gemm8 " << tuning.gemm8.mc << ' ' << tuning.gemm8.kc << ' '
+         << tuning.gemm8.nc << '\n'
+         << "gemm_min_ops " << tuning.gemm_min_ops << '\n'
+         << "parallel_min_elements " << tuning.parallel_min_elements << '\n'
+         << "transpose_leaf_bytes " << tuning.transpose_leaf_bytes << '\n'
+         << "threads " << tuning.threads << '\n';
+    if (!file) throw std::runtime_error("Writing the tuning file failed.");
+  }
+  std::error_code error;
+  std::filesystem::rename(temporary, path, error);
+  if (error) throw std::runtime_error("Writing the tuning file failed.");
+}
+
+std::optional<Tuning> load_tuning(const std::filesystem::path& path) {
+  std::ifstream file(path);
+  if (!file) return std::nullopt;
+  std::string text;
+  if (!std::getline(file, text) or text != HEADER)
+    throw std::runtime_error("Invalid tuning file.");
+
+  Tuning res;
+  bool same_host = false, same_cpu = false;
+  while (std::getline(file, text)) {
+    std::istringstream line(text);
+    std::string key;
+    if (!(line >> key)) continue;
+    if (key == "host") {
+      std::string host;
+      line >> host;
+      same_host = host == host_name();
+    } else if (key == "cpu") {
+      std::getline(line >> std::ws, text);
+      same_cpu = text == cpu_stamp();
+    } else if (key == "gemm4" or key == "gemm8") {
+      GemmBlocking& blocking = key == "gemm4" ? res.gemm4 : res.gemm8;
+      blocking.mc = parse_number(line);
+      blocking.kc = parse_number(line);
+      blocking.nc = parse_number(line);
+    } else if (key == "gemm_min_ops") {
+      res.gemm_min_ops = parse_number(line);
+    } else if (key == "parallel_min_elements") {
+      res.parallel_min_elements = parse_number(line);
+    } else if (key == "transpose_leaf_bytes") {
+      res.transpose_leaf_bytes = parse_number(line);
+    } else if (key == "threads") {
+      res.threads = parse_number(line);
+    }
+    // unknown keys are skipped so newer files still load
+  }
+  if (!same_host or !same_cpu) return std::nullopt;
+  return checked_tuning(res);
+}
+
+}  // namespace algebra
@@ -1,9 +1,42 @@
 #include "algebra.h"
-
+#include "arena.h"
+#include "batched.h"
+#include "chain.h"
+#include "cholesky.h"
+#include "expr.h"
+#include "fixed_matrix.h"
+#include "fused.h"
+#include "gemv.h"
+#include "lu.h"
+#include "matrix.h"
+#include "matrix_io.h"
+#include "out_of_core.h"
+#include "qr.h"
+#include "quantized.h"
+#include "random.h"
+#include "reduce.h"
+#include "simd.h"
+#include "sparse.h"
+#include "strassen.h"
+#include "structured.h"
+#include "view.h"
+#include "thread_pool.h"
+#include "transpose.h"
+#include "tune.h"
+
+#include <array>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
 #include <gtest/gtest.h>
 #include <iostream>
 #include <limits>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unistd.h>
 
 using namespace algebra;
 
@@ -508,3 +541,1917 @@ TEST(AutAp2024SpringHW1, inverse_EmptyMatrix) {
 	EXPECT_ANY_THROW(inverse(mat))
 		<< "Inverse calculation should throw an error for an empty matrix.";
 }
+
+// "============================================="
+// "                  Matrix Tests               "
+// "============================================="
+
+// Test that rows are stored contiguously with an aligned stride
+TEST(AutAp2024SpringHW1, Matrix_AlignedContiguousStorage) {
+	Matrix<double> mat(3, 5);
+	EXPECT_EQ(mat.rows(), 3u);
+	EXPECT_EQ(mat.cols(), 5u);
+	EXPECT_GE(mat.stride(), mat.cols());
+	EXPECT_EQ(reinterpret_cast<std::uintptr_t>(mat.data()) % MATRIX_ALIGNMENT,
+			  0u);
+	EXPECT_EQ(mat.row(2), mat.data() + 2 * mat.stride());
+	for (size_t i = 0; i < 3; ++i)
+		for (size_t j = 0; j < 5; ++j)
+			EXPECT_EQ(mat(i, j), 0.0) << "New matrices are zero-filled.";
+}
+
+// Test round trip between the legacy and the contiguous representation
+TEST(AutAp2024SpringHW1, Matrix_LegacyConversionRoundTrip) {
+	MATRIX<int> legacy = {{1, 2, 3}, {4, 5, 6}};
+	Matrix<int> mat = to_matrix(legacy);
+	EXPECT_EQ(mat(1, 2), 6);
+	EXPECT_EQ(to_legacy(mat), legacy);
+
+	MATRIX<int> ragged = {{1, 2}, {3}};
+	EXPECT_ANY_THROW(to_matrix(ragged));
+}
+
+// Test create_matrix for the contiguous type
+TEST(AutAp2024SpringHW1, Matrix_CreateMatrix) {
+	auto identity = create_matrix<Matrix<float>>(4, 4, MatrixType::Identity);
+	EXPECT_EQ(identity.to_legacy(),
+			  create_matrix<float>(4, 4, MatrixType::Identity));
+
+	auto random =
+		create_matrix<Matrix<double>>(3, 3, MatrixType::Random, -1.0, 1.0);
+	for (size_t i = 0; i < 3; ++i) {
+		for (size_t j = 0; j < 3; ++j) {
+			EXPECT_GE(random(i, j), -1.0);
+			EXPECT_LE(random(i, j), 1.0);
+		}
+	}
+
+	EXPECT_ANY_THROW(create_matrix<Matrix<int>>(0, 5));
+	EXPECT_ANY_THROW(create_matrix<Matrix<int>>(3, 2, MatrixType::Identity));
+	EXPECT_ANY_THROW(create_matrix<Matrix<int>>(2, 2, MatrixType::Random, 5, 4));
+	EXPECT_TRUE(create_matrix<Matrix<int>>(0, 0).empty());
+}
+
+// Test that the operations agree with the legacy implementation
+TEST(AutAp2024SpringHW1, Matrix_OperationsMatchLegacy) {
+	MATRIX<int> a = {{1, 2, 3}, {4, 5, 6}};
+	MATRIX<int> b = {{7, 8, 9}, {10, 11, 12}};
+	MATRIX<int> c = {{7, 8}, {9, 10}, {11, 12}};
+	Matrix<int> ma(a), mb(b), mc(c);
+
+	EXPECT_EQ(sum_sub(ma, mb).to_legacy(), sum_sub(a, b));
+	EXPECT_EQ(sum_sub(ma, mb, "sub").to_legacy(), sum_sub(a, b, "sub"));
+	EXPECT_EQ(multiply(ma, 3).to_legacy(), multiply(a, 3));
+	EXPECT_EQ(multiply(ma, mc).to_legacy(), multiply(a, c));
+	EXPECT_EQ(hadamard_product(ma, mb).to_legacy(), hadamard_product(a, b));
+	EXPECT_EQ(transpose(ma).to_legacy(), transpose(a));
+	EXPECT_EQ(trace(multiply(ma, mc)), trace(multiply(a, c)));
+	EXPECT_EQ(matrix_size(ma), matrix_size(a));
+
+	EXPECT_ANY_THROW(sum_sub(ma, mc));
+	EXPECT_ANY_THROW(multiply(ma, mb));
+	EXPECT_ANY_THROW(hadamard_product(ma, mc));
+	EXPECT_ANY_THROW(trace(ma));
+	EXPECT_ANY_THROW(multiply(Matrix<int>(), Matrix<int>()));
+}
+
+// Test transpose of a matrix larger than one tile
+TEST(AutAp2024SpringHW1, Matrix_TransposeLarge) {
+	auto mat = create_matrix<Matrix<int>>(70, 45, MatrixType::Random, -100, 100);
+	auto res = transpose(mat);
+	ASSERT_EQ(matrix_size(res), std::make_pair(size_t{45}, size_t{70}));
+	for (size_t i = 0; i < 70; ++i)
+		for (size_t j = 0; j < 45; ++j) EXPECT_EQ(res(j, i), mat(i, j));
+}
+
+// "============================================="
+// "                   gemm Tests                "
+// "============================================="
+
+// Reference i-k-j product used to check the optimized kernels
+template <typename T>
+MATRIX<T> naive_multiply(const MATRIX<T> &a, const MATRIX<T> &b) {
+	MATRIX<T> res(a.size(), std::vector<T>(b[0].size(), T(0)));
+	for (size_t i = 0; i < a.size(); ++i)
+		for (size_t k = 0; k < b.size(); ++k)
+			for (size_t j = 0; j < b[0].size(); ++j)
+				res[i][j] += a[i][k] * b[k][j];
+	return res;
+}
+
+// Test that the blocked kernel is exact for integers, edge tiles included
+TEST(AutAp2024SpringHW1, gemm_BlockedIntegerMatchesNaive) {
+	auto a = create_matrix<int>(67, 53, MatrixType::Random, -50, 50);
+	auto b = create_matrix<int>(53, 71, MatrixType::Random, -50, 50);
+	MATRIX<int> c(67, std::vector<int>(71, 0));
+	gemm_blocked<int>(
+		67, 71, 53, [&](size_t i, size_t k) { return a[i][k]; },
+		[&](size_t k, size_t j) { return b[k][j]; },
+		[&](size_t i, size_t j) -> int & { return c[i][j]; },
+		GemmBlocking{16, 20, 24});
+	EXPECT_EQ(c, naive_multiply(a, b));
+}
+
+// Test that multiply switches to the blocked kernel for large operands
+TEST(AutAp2024SpringHW1, gemm_LargeMultiplyMatchesNaive) {
+	auto a = create_matrix<double>(130, 150, MatrixType::Random, -1.0, 1.0);
+	auto b = create_matrix<double>(150, 97, MatrixType::Random, -1.0, 1.0);
+	auto expected = naive_multiply(a, b);
+	auto result = multiply(a, b);
+	auto contiguous = multiply(to_matrix(a), to_matrix(b));
+	for (size_t i = 0; i < 130; ++i) {
+		for (size_t j = 0; j < 97; ++j) {
+			EXPECT_NEAR(result[i][j], expected[i][j], 1e-12);
+			EXPECT_NEAR(contiguous(i, j), expected[i][j], 1e-12);
+		}
+	}
+
+	auto fa = create_matrix<float>(100, 300, MatrixType::Random, -1.0f, 1.0f);
+	auto fb = create_matrix<float>(300, 80, MatrixType::Random, -1.0f, 1.0f);
+	auto fexpected = naive_multiply(fa, fb);
+	auto fresult = multiply(fa, fb);
+	for (size_t i = 0; i < 100; ++i)
+		for (size_t j = 0; j < 80; ++j)
+			EXPECT_NEAR(fresult[i][j], fexpected[i][j], 1e-4f);
+}
+
+// "============================================="
+// "                thread pool Tests            "
+// "============================================="
+
+// Test that parallel_for visits every index exactly once
+TEST(AutAp2024SpringHW1, thread_pool_ParallelForCoversRange) {
+	ThreadPool pool(4);
+	std::vector<std::atomic<int>> hits(1000);
+	pool.parallel_for(hits.size(), [&](size_t i) { hits[i]++; });
+	for (const auto &hit : hits) EXPECT_EQ(hit.load(), 1);
+
+	EXPECT_ANY_THROW(pool.parallel_for(10, [](size_t i) {
+		if (i == 7) throw std::runtime_error("task failed");
+	})) << "Exceptions thrown by tasks should reach the caller.";
+}
+
+// Test that the thread count can be configured
+TEST(AutAp2024SpringHW1, thread_pool_SetNumThreads) {
+	set_num_threads(3);
+	EXPECT_EQ(get_num_threads(), 3u);
+	set_num_threads(1);
+	EXPECT_EQ(get_num_threads(), 1u);
+	set_num_threads(0);
+	EXPECT_GE(get_num_threads(), 1u);
+}
+
+// Test that the pool can be resized while another thread runs loops on it,
+// and that tasks cannot resize it
+TEST(AutAp2024SpringHW1, thread_pool_ResizeWhileRunning) {
+	std::atomic<bool> stop{false};
+	std::atomic<std::size_t> visited{0};
+	std::thread runner([&] {
+		while (!stop)
+			parallel_for(64, 1, [&](size_t begin, size_t end) {
+				visited += end - begin;
+			});
+	});
+	for (int i = 0; i < 200; i++) set_num_threads(i % 2 ? 2 : 4);
+	stop = true;
+	runner.join();
+	EXPECT_EQ(visited % 64, 0u);
+
+	set_num_threads(4);
+	std::atomic<int> rejected{0};
+	parallel_for(8, 1, [&](size_t, size_t) {
+		try {
+			set_num_threads(2);
+		} catch (const std::logic_error &) {
+			rejected++;
+		}
+	});
+	EXPECT_EQ(rejected, 8);
+	EXPECT_EQ(get_num_threads(), 4u);
+	set_num_threads(0);
+}
+
+// Test that multithreaded results are bit-identical to sequential ones
+TEST(AutAp2024SpringHW1, thread_pool_ParallelResultsMatchSequential) {
+	auto a = create_matrix<int>(300, 280, MatrixType::Random, -100, 100);
+	auto b = create_matrix<int>(280, 310, MatrixType::Random, -100, 100);
+	auto c = create_matrix<int>(300, 280, MatrixType::Random, -100, 100);
+	auto da = create_matrix<double>(200, 150, MatrixType::Random, -1.0, 1.0);
+	auto db = create_matrix<double>(150, 170, MatrixType::Random, -1.0, 1.0);
+
+	set_num_threads(1);
+	auto product = multiply(a, b);
+	auto sum = sum_sub(a, c);
+	auto hadamard = hadamard_product(a, c);
+	auto transposed = transpose(a);
+	auto contiguous = multiply(to_matrix(a), to_matrix(b));
+	auto dproduct = multiply(da, db);
+
+	set_num_threads(4);
+	EXPECT_EQ(multiply(a, b), product);
+	EXPECT_EQ(sum_sub(a, c), sum);
+	EXPECT_EQ(hadamard_product(a, c), hadamard);
+	EXPECT_EQ(transpose(a), transposed);
+	EXPECT_EQ(multiply(to_matrix(a), to_matrix(b)), contiguous);
+	EXPECT_EQ(transpose(to_matrix(a)).to_legacy(), transposed);
+	EXPECT_EQ(multiply(da, db), dproduct);
+	set_num_threads(0);
+}
+
+// "============================================="
+// "                   simd Tests                "
+// "============================================="
+
+// Test every available instruction set against plain loops
+TEST(AutAp2024SpringHW1, simd_KernelsMatchScalarLoops) {
+	const size_t n = 103; // not a multiple of any vector width
+	auto a = create_matrix<double>(1, n, MatrixType::Random, -10.0, 10.0)[0];
+	auto b = create_matrix<double>(1, n, MatrixType::Random, -10.0, 10.0)[0];
+	auto ia = create_matrix<int>(1, n, MatrixType::Random, -1000, 1000)[0];
+	auto ib = create_matrix<int>(1, n, MatrixType::Random, -1000, 1000)[0];
+
+	for (auto level : {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512,
+					   SimdLevel::NEON}) {
+		set_simd_level(level);
+		std::vector<double> out(n);
+		std::vector<int> iout(n);
+
+		simd_add(a.data(), b.data(), out.data(), n);
+		for (size_t i = 0; i < n; ++i) EXPECT_EQ(out[i], a[i] + b[i]);
+		simd_sub(ia.data(), ib.data(), iout.data(), n);
+		for (size_t i = 0; i < n; ++i) EXPECT_EQ(iout[i], ia[i] - ib[i]);
+		simd_mul(a.data(), b.data(), out.data(), n);
+		for (size_t i = 0; i < n; ++i) EXPECT_EQ(out[i], a[i] * b[i]);
+		simd_scale(ia.data(), -3, iout.data(), n);
+		for (size_t i = 0; i < n; ++i) EXPECT_EQ(iout[i], ia[i] * -3);
+
+		int isum = 0, istrided = 0;
+		for (size_t i = 0; i < n; ++i) isum += ia[i];
+		for (size_t i = 0; i < n; i += 3) istrided += ia[i];
+		EXPECT_EQ(simd_sum(ia.data(), n), isum);
+		EXPECT_EQ(simd_strided_sum(ia.data(), 3, (n + 2) / 3), istrided);
+		double sum = 0;
+		for (size_t i = 0; i < n; ++i) sum += a[i];
+		EXPECT_NEAR(simd_sum(a.data(), n), sum, 1e-9);
+	}
+	set_simd_level(detected_simd_level());
+	EXPECT_EQ(simd_level(), detected_simd_level());
+}
+
+// Test that the matrix operations give the same results at every level
+TEST(AutAp2024SpringHW1, simd_MatrixOperationsAcrossLevels) {
+	auto a = create_matrix<int>(37, 45, MatrixType::Random, -100, 100);
+	auto b = create_matrix<int>(37, 45, MatrixType::Random, -100, 100);
+	Matrix<int> ma(a), mb(b);
+
+	set_simd_level(SimdLevel::Scalar);
+	auto sum = sum_sub(a, b);
+	auto sub = sum_sub(ma, mb, "sub");
+	auto had = hadamard_product(a, b);
+	auto scaled = multiply(ma, 7);
+	auto tr = trace(to_matrix(multiply(a, transpose(b))));
+
+	set_simd_level(detected_simd_level());
+	EXPECT_EQ(sum_sub(a, b), sum);
+	EXPECT_EQ(sum_sub(ma, mb, "sub"), sub);
+	EXPECT_EQ(hadamard_product(a, b), had);
+	EXPECT_EQ(multiply(ma, 7), scaled);
+	EXPECT_EQ(trace(to_matrix(multiply(a, transpose(b)))), tr);
+	EXPECT_EQ(tr, trace(multiply(a, transpose(b))));
+}
+
+// "============================================="
+// "            expression template Tests        "
+// "============================================="
+
+// Test that a fused element-wise chain matches the eager functions
+TEST(AutAp2024SpringHW1, expr_FusedChainMatchesEager) {
+	auto a = create_matrix<Matrix<double>>(20, 30, MatrixType::Random, -5.0, 5.0);
+	auto b = create_matrix<Matrix<double>>(20, 30, MatrixType::Random, -5.0, 5.0);
+	auto c = create_matrix<Matrix<double>>(20, 30, MatrixType::Random, -5.0, 5.0);
+
+	Matrix<double> fused = a * 2.0 + hadamard_product(b - c, a) - (-b);
+	auto eager = sum_sub(sum_sub(multiply(a, 2.0),
+								 hadamard_product(sum_sub(b, c, "sub"), a)),
+						 multiply(b, -1.0), "sub");
+	for (size_t i = 0; i < 20; ++i)
+		for (size_t j = 0; j < 30; ++j)
+			EXPECT_DOUBLE_EQ(fused(i, j), eager(i, j));
+}
+
+// Test lazy transposes and legacy operands
+TEST(AutAp2024SpringHW1, expr_TransposeAndLegacyOperands) {
+	MATRIX<int> a = {{1, 2, 3}, {4, 5, 6}};
+	MATRIX<int> b = {{1, 0}, {0, 1}, {2, 2}};
+
+	auto expr = transpose(lazy(a)) * 3 + lazy(b);
+	EXPECT_EQ(expr.rows(), 3u);
+	EXPECT_EQ(expr.cols(), 2u);
+	EXPECT_EQ(to_legacy(expr), sum_sub(multiply(transpose(a), 3), b));
+	EXPECT_EQ(evaluate(expr).to_legacy(), to_legacy(expr));
+
+	EXPECT_ANY_THROW(lazy(a) + lazy(b))
+		<< "Dimension mismatches are reported when the expression is built.";
+}
+
+// Test that assigning an expression that reads its destination is safe
+TEST(AutAp2024SpringHW1, expr_AssignmentWithAliasing) {
+	Matrix<int> m = {{1, 2}, {3, 4}};
+	m = m + m;
+	EXPECT_EQ(m, (Matrix<int>{{2, 4}, {6, 8}}));
+	m = transpose(lazy(m)) - m;
+	EXPECT_EQ(m, (Matrix<int>{{0, 2}, {-2, 0}}));
+
+	Matrix<int> r = {{1, 2, 3}};
+	r = transpose(lazy(r)) * 2;
+	EXPECT_EQ(r, (Matrix<int>{{2}, {4}, {6}}));
+}
+
+// "============================================="
+// "                   view Tests                "
+// "============================================="
+
+// Test slicing without copying
+TEST(AutAp2024SpringHW1, view_SlicesShareStorage) {
+	Matrix<int> mat = {{1, 2, 3, 4}, {5, 6, 7, 8}, {9, 10, 11, 12}};
+	MatrixView<int> v = view(mat);
+
+	auto rows = v.row_range(1, 3);
+	EXPECT_EQ(matrix_size(rows), std::make_pair(size_t{2}, size_t{4}));
+	EXPECT_EQ(rows(0, 0), 5);
+	EXPECT_EQ(&rows(0, 0), &mat(1, 0));
+
+	auto cols = v.col_range(2, 4);
+	EXPECT_EQ(cols(2, 1), 12);
+
+	auto block = v.block(1, 1, 2, 2);
+	EXPECT_EQ(to_matrix(block), (Matrix<int>{{6, 7}, {10, 11}}));
+	EXPECT_EQ(to_matrix(block.transposed()), (Matrix<int>{{6, 10}, {7, 11}}));
+	EXPECT_EQ(transpose(v), transpose(mat));
+	EXPECT_THROW(v.block(2, 2, 2, 2), std::out_of_range);
+
+	MatrixSpan<int> s = span(mat);
+	s.block(0, 0, 2, 2).transposed()(0, 1) = 42;
+	EXPECT_EQ(mat(1, 0), 42) << "Spans write through to the matrix.";
+}
+
+// Test that the algebra operations accept views
+TEST(AutAp2024SpringHW1, view_OperationsAcceptViews) {
+	auto big = create_matrix<Matrix<int>>(90, 90, MatrixType::Random, -9, 9);
+	auto v = view(big);
+	auto a = v.block(0, 0, 60, 70);
+	auto b = v.block(10, 20, 70, 60);
+	auto c = v.block(30, 5, 60, 70);
+
+	auto la = to_legacy(to_matrix(a));
+	auto lb = to_legacy(to_matrix(b));
+	auto lc = to_legacy(to_matrix(c));
+
+	EXPECT_EQ(multiply(a, b).to_legacy(), multiply(la, lb));
+	EXPECT_EQ(multiply(a, to_matrix(b)).to_legacy(), multiply(la, lb));
+	EXPECT_EQ(multiply(b.transposed(), c.transposed()).to_legacy(),
+			  multiply(transpose(lb), transpose(lc)));
+	EXPECT_EQ(sum_sub(a, c).to_legacy(), sum_sub(la, lc));
+	EXPECT_EQ(sum_sub(a, c.transposed().transposed(), "sub").to_legacy(),
+			  sum_sub(la, lc, "sub"));
+	EXPECT_EQ(hadamard_product(a, b.transposed()).to_legacy(),
+			  hadamard_product(la, transpose(lb)));
+	EXPECT_EQ(multiply(a, 3).to_legacy(), multiply(la, 3));
+	EXPECT_EQ(trace(v.block(5, 7, 40, 40)),
+			  trace(to_matrix(v.block(5, 7, 40, 40))));
+	EXPECT_ANY_THROW(sum_sub(a, b));
+	EXPECT_ANY_THROW(multiply(a, c));
+
+	Matrix<int> fused = a * 2 + c;
+	EXPECT_EQ(fused.to_legacy(), sum_sub(multiply(la, 2), lc));
+	fused = v.block(1, 1, 60, 70) - fused;
+	EXPECT_EQ(fused.to_legacy(),
+			  sum_sub(to_legacy(to_matrix(v.block(1, 1, 60, 70))),
+					  sum_sub(multiply(la, 2), lc), "sub"));
+}
+
+// Test copying into a sub-block of another matrix
+TEST(AutAp2024SpringHW1, view_CopyIntoBlock) {
+	Matrix<double> dst(4, 4);
+	Matrix<double> src = {{1, 2}, {3, 4}};
+	copy(src, span(dst).block(1, 2, 2, 2));
+	EXPECT_EQ(dst(1, 2), 1);
+	EXPECT_EQ(dst(2, 3), 4);
+	EXPECT_EQ(dst(0, 0), 0);
+	EXPECT_ANY_THROW(copy(src, span(dst).block(0, 0, 3, 2)));
+}
+
+// "============================================="
+// "                in-place Tests               "
+// "============================================="
+
+// Test in-place operations against the copying ones
+TEST(AutAp2024SpringHW1, inplace_MatchesCopyingOperations) {
+	MATRIX<int> a = create_matrix<int>(70, 90, MatrixType::Random, -9, 9);
+	MATRIX<int> b = create_matrix<int>(70, 90, MatrixType::Random, -9, 9);
+	MATRIX<int> r = a;
+	add_inplace(r, b);
+	EXPECT_EQ(r, sum_sub(a, b));
+	sub_inplace(r, b);
+	EXPECT_EQ(r, a);
+	scale_inplace(r, 3);
+	EXPECT_EQ(r, multiply(a, 3));
+	hadamard_inplace(r, b);
+	EXPECT_EQ(r, hadamard_product(multiply(a, 3), b));
+	EXPECT_ANY_THROW(add_inplace(r, MATRIX<int>{{1}}));
+	EXPECT_ANY_THROW(hadamard_inplace(r, MATRIX<int>{{1}}));
+
+	Matrix<int> ma = to_matrix(a), mb = to_matrix(b);
+	add_inplace(ma, mb);
+	sub_inplace(ma, to_matrix(a));
+	scale_inplace(ma, -2);
+	hadamard_inplace(ma, mb);
+	EXPECT_EQ(ma.to_legacy(), hadamard_product(multiply(b, -2), b));
+	EXPECT_ANY_THROW(sub_inplace(ma, Matrix<int>(2, 2)));
+}
+
+// Test that rvalue arguments lend their storage to the result
+TEST(AutAp2024SpringHW1, inplace_RvalueOverloadsReuseStorage) {
+	MATRIX<double> a = {{1, 2}, {3, 4}};
+	MATRIX<double> b = {{5, 6}, {7, 8}};
+	MATRIX<double> t = a;
+	const double* p = t[0].data();
+	MATRIX<double> r = sum_sub(std::move(t), b, "sub");
+	EXPECT_EQ(r[0].data(), p);
+	EXPECT_EQ(r, sum_sub(a, b, "sub"));
+	r = sum_sub(a, std::move(r), "sub");
+	EXPECT_EQ(r[0].data(), p);
+	EXPECT_EQ(r, b);
+	r = hadamard_product(a, multiply(std::move(r), 2.0));
+	EXPECT_EQ(r[0].data(), p);
+	EXPECT_EQ(r, hadamard_product(a, multiply(b, 2.0)));
+
+	Matrix<double> ma = to_matrix(a), mb = to_matrix(b);
+	Matrix<double> m = ma;
+	const double* q = m.data();
+	m = sum_sub(ma, multiply(std::move(m), 2.0), "sub");
+	EXPECT_EQ(m.data(), q);
+	EXPECT_EQ(m.to_legacy(), multiply(a, -1.0));
+	m = hadamard_product(sum_sub(std::move(m), mb), mb);
+	EXPECT_EQ(m.data(), q);
+	EXPECT_EQ(m.to_legacy(), hadamard_product(sum_sub(b, a, "sub"), b));
+	EXPECT_ANY_THROW(sum_sub(std::move(m), Matrix<double>(1, 1)));
+}
+
+// "============================================="
+// "               FixedMatrix Tests             "
+// "============================================="
+
+template <typename A, typename B>
+concept fixed_multipliable = requires(A a, B b) { multiply(a, b); };
+
+// Test that fixed matrices work in constant expressions
+TEST(AutAp2024SpringHW1, FixedMatrix_ConstexprOperations) {
+	constexpr FixedMatrix<int, 2, 3> a = {{1, 2, 3}, {4, 5, 6}};
+	constexpr FixedMatrix<int, 3, 2> b = transpose(a);
+	static_assert(b(2, 1) == 6);
+	static_assert(multiply(a, b) == FixedMatrix<int, 2, 2>{{14, 32}, {32, 77}});
+	static_assert(trace(a * b) == 91);
+	static_assert(hadamard_product(a, a)(1, 2) == 36);
+	static_assert(a + a == multiply(a, 2));
+	static_assert(a - a == FixedMatrix<int, 2, 3>{});
+	static_assert(FixedMatrix3<int>::identity() * b == b);
+	static_assert(sizeof(FixedMatrix4<float>) == 16 * sizeof(float));
+	static_assert(fixed_multipliable<FixedMatrix<int, 2, 3>,
+									 FixedMatrix<int, 3, 4>>);
+	static_assert(!fixed_multipliable<FixedMatrix<int, 2, 3>,
+									  FixedMatrix<int, 2, 3>>);
+	EXPECT_EQ(sum_sub(a, a, "sub"), (FixedMatrix<int, 2, 3>{}));
+	EXPECT_ANY_THROW((FixedMatrix<int, 2, 2>{{1, 2}, {3}}));
+}
+
+// Test conversions from and to the dynamic matrix types
+TEST(AutAp2024SpringHW1, FixedMatrix_DynamicInterop) {
+	MATRIX<double> la = create_matrix<double>(4, 4, MatrixType::Random, -5, 5);
+	MATRIX<double> lb = create_matrix<double>(4, 4, MatrixType::Random, -5, 5);
+	FixedMatrix4<double> a(la);
+	FixedMatrix4<double> b(to_matrix(lb));
+	EXPECT_EQ(a.to_legacy(), la);
+	EXPECT_EQ(to_legacy(multiply(a, b)), multiply(la, lb));
+	EXPECT_EQ(to_matrix(transpose(a)).to_legacy(), transpose(la));
+	EXPECT_DOUBLE_EQ(trace(a), trace(la));
+	EXPECT_EQ(to_legacy(multiply(view(a), view(b).transposed())),
+			  multiply(la, transpose(lb)));
+	copy(view(b), span(a));
+	EXPECT_EQ(a, b);
+	EXPECT_ANY_THROW(FixedMatrix3<double>{la});
+	EXPECT_ANY_THROW(FixedMatrix3<double>(Matrix<double>(3, 4)));
+	// a ragged row after a well-sized first one
+	la[3].resize(5);
+	EXPECT_ANY_THROW(FixedMatrix4<double>{la});
+	la[3].resize(3);
+	EXPECT_ANY_THROW(FixedMatrix4<double>{la});
+}
+
+// "============================================="
+// "                strassen Tests               "
+// "============================================="
+
+// Largest |x - y| over all elements
+template <typename T, typename U>
+double max_abs_diff(const Matrix<T> &x, const Matrix<U> &y) {
+	double res = 0;
+	for (size_t i = 0; i < x.rows(); i++)
+		for (size_t j = 0; j < x.cols(); j++)
+			res = std::max(res, std::abs(double(x(i, j)) - double(y(i, j))));
+	return res;
+}
+
+// Test exact results on integers, including odd and rectangular shapes
+TEST(AutAp2024SpringHW1, strassen_IntegerMatchesClassical) {
+	const StrassenOptions options{.crossover = 16};
+	for (auto [m, k, n] : {std::tuple<size_t, size_t, size_t>{128, 128, 128},
+						   {129, 131, 127}, {70, 200, 90}, {5, 300, 5}}) {
+		auto a = create_matrix<Matrix<int64_t>>(m, k, MatrixType::Random, -50, 50);
+		auto b = create_matrix<Matrix<int64_t>>(k, n, MatrixType::Random, -50, 50);
+		EXPECT_EQ(multiply_strassen(a, b, options), multiply(a, b));
+	}
+	MATRIX<int> la = create_matrix<int>(67, 67, MatrixType::Random, -9, 9);
+	EXPECT_EQ(multiply_strassen(la, la, options), multiply(la, la));
+	EXPECT_ANY_THROW(multiply_strassen(Matrix<int>(3, 4), Matrix<int>(3, 4)));
+	EXPECT_ANY_THROW(multiply_strassen(MATRIX<int>{}, la));
+}
+
+// Test that the extra rounding error stays within a bounded factor of the
+// classical product's error (reference computed in double)
+TEST(AutAp2024SpringHW1, strassen_ErrorBoundedAgainstClassical) {
+	const size_t n = 512;
+	auto a = create_matrix<Matrix<float>>(n, n, MatrixType::Random, -1, 1);
+	auto b = create_matrix<Matrix<float>>(n, n, MatrixType::Random, -1, 1);
+	Matrix<double> exact =
+		multiply(Matrix<double>(lazy(a) * 1.0), Matrix<double>(lazy(b) * 1.0));
+	const double classical = max_abs_diff(multiply(a, b), exact);
+	// each recursion level may add at most a factor of 4
+	for (auto [crossover, levels] : {std::pair<size_t, int>{256, 1}, {64, 3},
+									 {32, 4}}) {
+		const double error =
+			max_abs_diff(multiply_strassen(a, b, {.crossover = crossover}), exact);
+		EXPECT_LE(error, std::pow(4, levels) * classical) << crossover;
+	}
+}
+
+// Test that the scratch budget limits the recursion depth
+TEST(AutAp2024SpringHW1, strassen_ScratchBudget) {
+	const size_t n = 256;
+	auto a = create_matrix<Matrix<double>>(n, n, MatrixType::Random, -1, 1);
+	auto b = create_matrix<Matrix<double>>(n, n, MatrixType::Random, -1, 1);
+	EXPECT_EQ(strassen_scratch_bytes<double>(n, n, n, 64),
+			  (3 * 128 * 128 + 3 * 64 * 64) * sizeof(double));
+	// no room for a single level: plain blocked GEMM
+	EXPECT_EQ(multiply_strassen(a, b, {.crossover = 64, .scratch_bytes = 0}),
+			  multiply(a, b));
+	// room for the first level only
+	const auto one_level = multiply_strassen(
+		a, b, {.crossover = 64, .scratch_bytes = 3 * 128 * 128 * sizeof(double)});
+	EXPECT_EQ(one_level, multiply_strassen(a, b, {.crossover = 128}));
+	EXPECT_LT(max_abs_diff(one_level, multiply(a, b)), 1e-10);
+}
+
+// "============================================="
+// "                 sparse Tests                "
+// "============================================="
+
+// Random matrix where about one element in `every` is non-zero
+template <typename T>
+MATRIX<T> sparse_random_matrix(size_t rows, size_t cols, int every) {
+	MATRIX<T> m = create_matrix<T>(rows, cols, MatrixType::Random, -9, 9);
+	MATRIX<int> keep = create_matrix<int>(rows, cols, MatrixType::Random, 1, every);
+	for (size_t i = 0; i < rows; i++)
+		for (size_t j = 0; j < cols; j++)
+			if (keep[i][j] != 1) m[i][j] = 0;
+	return m;
+}
+
+// Test conversions between the dense and the three sparse formats
+TEST(AutAp2024SpringHW1, sparse_Conversions) {
+	MATRIX<int> dense = {{0, 2, 0}, {0, 0, 0}, {3, 0, 4}, {0, 5, 0}};
+	CsrMatrix<int> csr(dense);
+	EXPECT_EQ(csr.nnz(), 4);
+	EXPECT_EQ(csr.row_ptr(), (std::vector<size_t>{0, 1, 1, 3, 4}));
+	EXPECT_EQ(csr.col_indices(), (std::vector<size_t>{1, 0, 2, 1}));
+	EXPECT_EQ(csr(2, 2), 4);
+	EXPECT_EQ(csr(1, 1), 0);
+	EXPECT_EQ(csr.to_legacy(), dense);
+	EXPECT_EQ(CsrMatrix<int>(to_matrix(dense)).to_matrix().to_legacy(), dense);
+
+	CscMatrix<int> csc(csr);
+	EXPECT_EQ(csc.col_ptr(), (std::vector<size_t>{0, 1, 3, 4}));
+	EXPECT_EQ(csc.row_indices(), (std::vector<size_t>{2, 0, 3, 2}));
+	EXPECT_EQ(csc(3, 1), 5);
+	EXPECT_EQ(csc.to_legacy(), dense);
+	EXPECT_EQ(CsrMatrix<int>(csc).to_legacy(), dense);
+
+	CooMatrix<int> coo(4, 3);
+	coo.insert(3, 1, 5);
+	coo.insert(2, 2, 1);
+	coo.insert(0, 1, 2);
+	coo.insert(2, 0, 3);
+	coo.insert(2, 2, 3);
+	EXPECT_EQ(coo.to_legacy(), dense);
+	EXPECT_EQ(CsrMatrix<int>(coo).nnz(), 4);
+	EXPECT_EQ(CsrMatrix<int>(coo).to_legacy(), dense);
+	EXPECT_EQ(CooMatrix<int>(dense).to_legacy(), dense);
+	EXPECT_ANY_THROW(coo.insert(4, 0, 1));
+	EXPECT_ANY_THROW(CsrMatrix<int>(2, 2, {0, 1, 1}, {2}, {1}));
+	EXPECT_ANY_THROW(CsrMatrix<int>(2, 2, {0, 2, 2}, {1, 0}, {1, 1}));
+	// ragged rows, longer with zeros or shorter than the first
+	const MATRIX<int> longer{{1, 2}, {0, 0, 0, 0, 3}};
+	const MATRIX<int> shorter{{1, 2, 3}, {4}};
+	EXPECT_ANY_THROW(CsrMatrix<int>{longer});
+	EXPECT_ANY_THROW(CscMatrix<int>{shorter});
+	EXPECT_ANY_THROW(CooMatrix<int>{longer});
+}
+
+// Test sparse x dense and sparse x sparse products against dense ones
+TEST(AutAp2024SpringHW1, sparse_Multiply) {
+	MATRIX<int> a = sparse_random_matrix<int>(300, 200, 20);
+	MATRIX<int> b = sparse_random_matrix<int>(200, 250, 20);
+	MATRIX<int> dense_b = create_matrix<int>(200, 40, MatrixType::Random, -9, 9);
+	CsrMatrix<int> sa(a), sb(b);
+	EXPECT_EQ(multiply(sa, dense_b), multiply(a, dense_b));
+	EXPECT_EQ(multiply(sa, to_matrix(dense_b)).to_legacy(), multiply(a, dense_b));
+	EXPECT_EQ(multiply(sa, sb).to_legacy(), multiply(a, b));
+	EXPECT_EQ(multiply(sa, 3).to_legacy(), multiply(a, 3));
+	EXPECT_ANY_THROW(multiply(sa, sa));
+	EXPECT_ANY_THROW(multiply(sa, MATRIX<int>{}));
+
+	for (size_t threads : {1, 4}) {
+		set_num_threads(threads);
+		MATRIX<double> c = sparse_random_matrix<double>(1000, 1000, 50);
+		CsrMatrix<double> sc(c);
+		EXPECT_EQ(multiply(sc, sc).to_legacy(),
+				  multiply(sc, to_matrix(c)).to_legacy());
+	}
+	set_num_threads(0);
+}
+
+// Test transpose, addition and trace
+TEST(AutAp2024SpringHW1, sparse_TransposeSumTrace) {
+	MATRIX<double> a = sparse_random_matrix<double>(120, 120, 10);
+	MATRIX<double> b = sparse_random_matrix<double>(120, 120, 10);
+	CsrMatrix<double> sa(a), sb(b);
+	EXPECT_EQ(transpose(sa).to_legacy(), transpose(a));
+	EXPECT_EQ(sum_sub(sa, sb).to_legacy(), sum_sub(a, b));
+	EXPECT_EQ(sum_sub(sa, sb, "sub").to_legacy(), sum_sub(a, b, "sub"));
+	EXPECT_DOUBLE_EQ(trace(sa), trace(a));
+	EXPECT_ANY_THROW(sum_sub(sa, CsrMatrix<double>(120, 3)));
+	EXPECT_ANY_THROW(trace(CsrMatrix<double>(2, 3)));
+	EXPECT_ANY_THROW(trace(CsrMatrix<double>()));
+}
+
+/*
+// "=============================================="
+// "                 random Tests                 "
+// "=============================================="
+*/
+
+// Test the Philox4x32-10 block against the Random123 known-answer vectors
+TEST(AutAp2024SpringHW1, random_PhiloxKnownAnswers) {
+	using Block = std::array<std::uint32_t, 4>;
+	EXPECT_EQ(philox4x32({0, 0, 0, 0}, {0, 0}),
+			  (Block{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+	EXPECT_EQ(philox4x32({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+						 {0xffffffff, 0xffffffff}),
+			  (Block{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}));
+	EXPECT_EQ(philox4x32({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344},
+						 {0xa4093822, 0x299f31d0}),
+			  (Block{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+}
+
+// Test that every SIMD level and every offset give the same stream
+TEST(AutAp2024SpringHW1, random_StreamIndependentOfLevelAndOffset) {
+	const std::uint64_t seed = 0x0123456789abcdef;
+	std::vector<std::uint64_t> expected(301);
+	for (size_t b = 0; b < expected.size() / 2 + 1; b++) {
+		auto r = philox4x32({std::uint32_t(b), 0, 0, 0},
+							{std::uint32_t(seed), std::uint32_t(seed >> 32)});
+		if (2 * b < expected.size())
+			expected[2 * b] = r[0] | std::uint64_t(r[1]) << 32;
+		if (2 * b + 1 < expected.size())
+			expected[2 * b + 1] = r[2] | std::uint64_t(r[3]) << 32;
+	}
+	for (auto level : {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512,
+					   SimdLevel::NEON}) {
+		set_simd_level(level);
+		for (size_t first : {0, 1, 2, 7}) {
+			for (size_t count : {0, 1, 2, 5, 64, 290}) {
+				std::vector<std::uint64_t> out(count);
+				philox_fill(seed, first, count, out.data());
+				for (size_t i = 0; i < count; i++)
+					ASSERT_EQ(out[i], expected[first + i]);
+			}
+		}
+	}
+	set_simd_level(detected_simd_level());
+}
+
+// Test that a seed fixes a random matrix, whatever the storage or threads
+TEST(AutAp2024SpringHW1, random_SeededMatricesReproducible) {
+	auto a = create_matrix<double>(123, 77, MatrixType::Random, -5, 5, 42);
+	EXPECT_EQ(create_matrix<double>(123, 77, MatrixType::Random, -5, 5, 42), a);
+	EXPECT_EQ((create_matrix<Matrix<double>>(123, 77, MatrixType::Random, -5, 5,
+											 42)
+				   .to_legacy()),
+			  a);
+	EXPECT_NE(create_matrix<double>(123, 77, MatrixType::Random, -5, 5, 43), a);
+	EXPECT_NE(create_matrix<double>(123, 77, MatrixType::Random, -5, 5), a);
+
+	set_num_threads(1);
+	auto serial = create_matrix<int>(500, 300, MatrixType::Random, -3, 3, 7);
+	set_num_threads(4);
+	EXPECT_EQ(create_matrix<int>(500, 300, MatrixType::Random, -3, 3, 7), serial);
+	set_num_threads(0);
+}
+
+// Test the ranges and a rough uniformity of the generated values
+TEST(AutAp2024SpringHW1, random_ValuesUniformInRange) {
+	auto ints = create_matrix<int>(400, 250, MatrixType::Random, -2, 2, 1);
+	std::array<size_t, 5> counts{};
+	for (const auto& row : ints)
+		for (int v : row) {
+			ASSERT_TRUE(v >= -2 and v <= 2);
+			counts[v + 2]++;
+		}
+	for (size_t c : counts) EXPECT_NEAR(c, 20000.0, 600.0);
+
+	auto reals = create_matrix<float>(300, 300, MatrixType::Random, 1, 3, 2);
+	double mean = 0;
+	for (const auto& row : reals)
+		for (float v : row) {
+			ASSERT_TRUE(v >= 1 and v < 3);
+			mean += v;
+		}
+	EXPECT_NEAR(mean / (300 * 300), 2.0, 0.01);
+
+	auto full = create_matrix<std::int64_t>(
+		10, 10, MatrixType::Random, std::numeric_limits<std::int64_t>::min(),
+		std::numeric_limits<std::int64_t>::max(), 3);
+	EXPECT_NE(full[0][0], full[0][1]);
+}
+
+/*
+// "=============================================="
+// "               matrix file Tests              "
+// "=============================================="
+*/
+
+// Path of a scratch file in the temporary directory
+std::string temp_matrix_path(const std::string& name) {
+	return (std::filesystem::temp_directory_path() /
+			("aut_ap_hw1_" + std::to_string(::getpid()) + "_" + name))
+		.string();
+}
+
+// Test that saved matrices come back unchanged, mapped or copied
+TEST(AutAp2024SpringHW1, matrix_file_RoundTrip) {
+	const std::string path = temp_matrix_path("round_trip.mat");
+	auto a = create_matrix<Matrix<double>>(37, 53, MatrixType::Random, -5, 5, 1);
+	save_matrix(path, a);
+	{
+		MappedMatrix<double> mapped(path, true);
+		EXPECT_EQ(mapped.rows(), 37u);
+		EXPECT_EQ(mapped.cols(), 53u);
+		EXPECT_EQ(mapped.header().dtype, DType::Float64);
+		EXPECT_EQ(mapped.header().data_offset % MATRIX_ALIGNMENT, 0u);
+		EXPECT_EQ(to_matrix(mapped.view()), a);
+	}
+	EXPECT_EQ(load_matrix<double>(path), a);
+
+	// padded rows start on the alignment; transposed views are written too
+	save_matrix(path, view(a).transposed(), {.alignment = 32, .pad_rows = true});
+	MappedMatrix<double> mapped(path, true);
+	EXPECT_EQ(mapped.header().row_stride, 40u);
+	EXPECT_EQ(reinterpret_cast<std::uintptr_t>(mapped.view().row(1)) % 32, 0u);
+	EXPECT_EQ(to_matrix(mapped.view()), transpose(a));
+
+	MATRIX<std::int8_t> small = {{1, -2, 3}, {4, 5, -6}, {7, 8, 9}};
+	save_matrix(path, small, {.checksum = false});
+	EXPECT_EQ(load_matrix<std::int8_t>(path).to_legacy(), small);
+	save_matrix(path, Matrix<int>());
+	EXPECT_TRUE(load_matrix<int>(path).empty());
+	std::filesystem::remove(path);
+}
+
+// Test row-by-row writing and the rejection of incomplete files
+TEST(AutAp2024SpringHW1, matrix_file_StreamingWriter) {
+	const std::string path = temp_matrix_path("streaming.mat");
+	{
+		MatrixWriter<int> writer(path, 100, 7);
+		std::vector<int> row(7);
+		for (int i = 0; i < 100; i++) {
+			for (int j = 0; j < 7; j++) row[j] = i * 7 + j;
+			writer.write_row(row.data());
+		}
+		EXPECT_ANY_THROW(writer.write_row(row.data()));
+		writer.finish();
+	}
+	Matrix<int> loaded = load_matrix<int>(path);
+	EXPECT_EQ(loaded(99, 6), 99 * 7 + 6);
+	EXPECT_EQ(read_matrix_header(path).rows, 100u);
+
+	{
+		MatrixWriter<int> writer(path, 3, 3);
+		writer.write_rows(view(Matrix<int>(2, 3, 1)));
+		EXPECT_ANY_THROW(writer.finish());
+	}
+	EXPECT_ANY_THROW(MappedMatrix<int>{path});
+	EXPECT_ANY_THROW(load_matrix<int>(temp_matrix_path("missing.mat")));
+	std::filesystem::remove(path);
+}
+
+// Test that dtype mismatches, truncation and corruption are detected
+TEST(AutAp2024SpringHW1, matrix_file_Validation) {
+	const std::string path = temp_matrix_path("validation.mat");
+	save_matrix(path, Matrix<float>(16, 16, 2.5f));
+	EXPECT_ANY_THROW(MappedMatrix<double>{path});
+	EXPECT_ANY_THROW(load_matrix<int>(path));
+
+	{
+		std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+		file.seekp(read_matrix_header(path).data_offset + 100);
+		file.put(0x55);
+	}
+	EXPECT_NO_THROW(MappedMatrix<float>(path, false));
+	EXPECT_ANY_THROW(MappedMatrix<float>(path, true));
+
+	std::filesystem::resize_file(path, 200);
+	EXPECT_ANY_THROW(read_matrix_header(path));
+	EXPECT_ANY_THROW(MappedMatrix<float>{path});
+	std::filesystem::remove(path);
+}
+
+/*
+// "=============================================="
+// "              out-of-core Tests               "
+// "=============================================="
+*/
+
+// Test the tiling against the memory budget
+TEST(AutAp2024SpringHW1, out_of_core_PlanFitsBudget) {
+	OutOfCoreOptions options{.memory_bytes = 1 << 20, .inner_tile = 64};
+	OutOfCorePlan plan = plan_out_of_core<double>(5000, 3000, 700, options);
+	EXPECT_LE(plan.bytes, options.memory_bytes);
+	EXPECT_EQ(plan.inner_tile, 64u);
+	EXPECT_GT(plan.panel_rows, 1u);
+	EXPECT_LT(plan.panel_rows, 5000u);
+
+	// a small budget shrinks the inner tile before giving up
+	plan = plan_out_of_core<double>(5000, 3000, 700, {.memory_bytes = 40000});
+	EXPECT_LE(plan.bytes, 40000u);
+	EXPECT_LT(plan.inner_tile, 256u);
+	EXPECT_ANY_THROW(plan_out_of_core<double>(10, 10, 1000, {.memory_bytes = 100}));
+	EXPECT_EQ(plan_out_of_core<float>(8, 8, 8).panel_rows, 8u);
+}
+
+// Test that streamed products match the in-memory multiply
+TEST(AutAp2024SpringHW1, out_of_core_MatchesInMemory) {
+	const std::string pa = temp_matrix_path("ooc_a.mat");
+	const std::string pb = temp_matrix_path("ooc_b.mat");
+	const std::string pc = temp_matrix_path("ooc_c.mat");
+	auto a = create_matrix<Matrix<int>>(157, 203, MatrixType::Random, -9, 9, 1);
+	auto b = create_matrix<Matrix<int>>(203, 91, MatrixType::Random, -9, 9, 2);
+	save_matrix(pa, a);
+	save_matrix(pb, view(b), {.pad_rows = true});
+	// two row panels of seven inner slices each
+	multiply_out_of_core<int>(pa, pb, pc,
+							  {.memory_bytes = 100000, .inner_tile = 32});
+	EXPECT_EQ(load_matrix<int>(pc), multiply(a, b));
+
+	auto da = create_matrix<Matrix<double>>(120, 80, MatrixType::Random, -1, 1, 3);
+	auto db = create_matrix<Matrix<double>>(80, 60, MatrixType::Random, -1, 1, 4);
+	save_matrix(pa, da);
+	save_matrix(pb, db);
+	multiply_out_of_core<double>(pa, pb, pc, {.memory_bytes = 60000});
+	EXPECT_LT(max_abs_diff(load_matrix<double>(pc), multiply(da, db)), 1e-12);
+
+	EXPECT_ANY_THROW(multiply_out_of_core<double>(pa, pa, pc));
+	EXPECT_ANY_THROW(multiply_out_of_core<int>(pa, pb, pc));
+	for (const auto& path : {pa, pb, pc}) std::filesystem::remove(path);
+}
+
+/*
+// "=============================================="
+// "                   LU Tests                   "
+// "=============================================="
+*/
+
+// Random matrix with a heavy diagonal, so that it is well conditioned
+Matrix<double> well_conditioned(size_t n, std::uint64_t seed) {
+	auto a = create_matrix<Matrix<double>>(n, n, MatrixType::Random, -1, 1, seed);
+	for (size_t i = 0; i < n; i++) a(i, i) += double(n) / 4;
+	return a;
+}
+
+// Test that the blocked factors reproduce P * A, whatever the block size
+TEST(AutAp2024SpringHW1, lu_FactorsReproduceMatrix) {
+	const size_t n = 203;
+	auto a = create_matrix<Matrix<double>>(n, n, MatrixType::Random, -1, 1, 5);
+	for (size_t block : {1, 16, 64, 500}) {
+		Matrix<double> f = a;
+		std::vector<size_t> pivots;
+		ASSERT_TRUE(lu_factorize(span(f), pivots, block));
+		Matrix<double> l(n, n), u(n, n), pa = a;
+		for (size_t i = 0; i < n; i++) {
+			if (pivots[i] != i)
+				std::swap_ranges(pa.row(i), pa.row(i) + n, pa.row(pivots[i]));
+			for (size_t j = 0; j < n; j++) {
+				if (j < i) l(i, j) = f(i, j);
+				else u(i, j) = f(i, j);
+			}
+			l(i, i) = 1;
+		}
+		EXPECT_LT(max_abs_diff(multiply(l, u), pa), 1e-12) << "block " << block;
+	}
+}
+
+// Test solve, inverse and determinant against known results
+TEST(AutAp2024SpringHW1, lu_SolveInverseDeterminant) {
+	const size_t n = 150;
+	Matrix<double> a = well_conditioned(n, 6);
+	auto b = create_matrix<Matrix<double>>(n, 9, MatrixType::Random, -1, 1, 7);
+	LU<double> f = lu(a);
+	Matrix<double> x = f.solve(b);
+	EXPECT_LT(max_abs_diff(multiply(a, x), b), 1e-12);
+	// the factorization is reused for another right-hand side
+	EXPECT_LT(max_abs_diff(multiply(a, f.solve(a)), a), 1e-12);
+
+	Matrix<double> identity = create_matrix<Matrix<double>>(n, n, MatrixType::Identity);
+	EXPECT_LT(max_abs_diff(multiply(a, inverse(a)), identity), 1e-12);
+	EXPECT_LT(max_abs_diff(to_matrix(solve(a.to_legacy(), b.to_legacy())), x),
+			  1e-12);
+
+	// small enough for the determinants to stay finite
+	Matrix<double> d = well_conditioned(40, 8), e = well_conditioned(40, 9);
+	const double det = determinant(multiply(d, e));
+	EXPECT_NEAR(det / (determinant(d) * determinant(e)), 1.0, 1e-9);
+	EXPECT_DOUBLE_EQ(determinant(Matrix<double>{{0, 2}, {3, 0}}), -6.0);
+	EXPECT_DOUBLE_EQ(determinant(MATRIX<float>{{2, 1}, {4, 2}}), 0.0f);
+
+	LU<double> singular = lu(Matrix<double>{{1, 2, 3}, {2, 4, 6}, {1, 0, 1}});
+	EXPECT_TRUE(singular.singular());
+	EXPECT_ANY_THROW(singular.solve(b));
+	EXPECT_ANY_THROW(f.solve(Matrix<double>(n + 1, 1)));
+}
+
+// Test that the parallel factorization does not depend on the thread count
+TEST(AutAp2024SpringHW1, lu_IndependentOfThreadCount) {
+	Matrix<double> a = well_conditioned(300, 9);
+	set_num_threads(1);
+	LU<double> serial = lu(a);
+	set_num_threads(4);
+	LU<double> parallel = lu(a);
+	set_num_threads(0);
+	EXPECT_EQ(serial.factors(), parallel.factors());
+	EXPECT_EQ(serial.pivots(), parallel.pivots());
+}
+
+/*
+// "=============================================="
+// "                Cholesky Tests                "
+// "=============================================="
+*/
+
+// Test that L * L^T reproduces an SPD matrix whatever the block size, and
+// that the in-place variant leaves the upper triangle alone
+TEST(AutAp2024SpringHW1, cholesky_FactorsReproduceMatrix) {
+	const size_t n = 181;
+	auto g = create_matrix<Matrix<double>>(n, n, MatrixType::Random, -1, 1, 10);
+	Matrix<double> a = multiply(g, transpose(g));
+	for (size_t i = 0; i < n; i++) a(i, i) += double(n);
+	for (size_t block : {1, 16, 64, 500}) {
+		Matrix<double> f = a;
+		cholesky_inplace(span(f), block);
+		for (size_t i = 0; i < n; i++)
+			for (size_t j = i + 1; j < n; j++) ASSERT_EQ(f(i, j), a(i, j));
+		for (size_t i = 0; i < n; i++)
+			for (size_t j = i + 1; j < n; j++) f(i, j) = 0;
+		EXPECT_LT(max_abs_diff(multiply(f, transpose(f)), a), 1e-10) << block;
+	}
+	EXPECT_EQ(cholesky(a), to_matrix(cholesky(a.to_legacy())));
+}
+
+TEST(AutAp2024SpringHW1, cholesky_SolveAndErrors) {
+	const size_t n = 120;
+	auto g = create_matrix<Matrix<double>>(n, n, MatrixType::Random, -1, 1, 11);
+	Matrix<double> a = multiply(g, transpose(g));
+	for (size_t i = 0; i < n; i++) a(i, i) += double(n);
+	auto b = create_matrix<Matrix<double>>(n, 7, MatrixType::Random, -1, 1, 12);
+	Matrix<double> x = cholesky_solve(cholesky(a), b);
+	EXPECT_LT(max_abs_diff(multiply(a, x), b), 1e-12);
+
+	Matrix<double> indefinite = a;
+	indefinite(70, 70) = -1;
+	EXPECT_ANY_THROW(cholesky(indefinite));
+	EXPECT_ANY_THROW(cholesky(Matrix<double>(3, 4)));
+	EXPECT_ANY_THROW(cholesky_solve(cholesky(a), Matrix<double>(n + 1, 1)));
+}
+
+/*
+// "=============================================="
+// "                   QR Tests                   "
+// "=============================================="
+*/
+
+// Test Q * R = A and Q^T * Q = I for tall, square and wide matrices
+TEST(AutAp2024SpringHW1, qr_FactorsReproduceMatrix) {
+	for (auto [m, n] : {std::pair<size_t, size_t>{150, 90}, {77, 77}, {40, 95}}) {
+		auto a = create_matrix<Matrix<double>>(m, n, MatrixType::Random, -1, 1, m);
+		for (size_t block : {1, 8, 32, 200}) {
+			Matrix<double> f = a;
+			std::vector<double> tau;
+			qr_inplace(span(f), tau, block);
+			EXPECT_EQ(tau.size(), std::min(m, n));
+		}
+		QR<double> f = qr(a);
+		Matrix<double> q = f.q(), r = f.r();
+		for (size_t i = 0; i < r.rows(); i++)
+			for (size_t j = 0; j < std::min(i, n); j++) ASSERT_EQ(r(i, j), 0);
+		EXPECT_LT(max_abs_diff(multiply(q, r), a), 1e-12) << m << "x" << n;
+		Matrix<double> identity = create_matrix<Matrix<double>>(
+			q.cols(), q.cols(), MatrixType::Identity);
+		EXPECT_LT(max_abs_diff(multiply(transpose(q), q), identity), 1e-12);
+		// the blocked reflectors match the unblocked ones
+		Matrix<double> unblocked = a;
+		std::vector<double> tau;
+		qr_inplace(span(unblocked), tau, 1);
+		EXPECT_LT(max_abs_diff(unblocked, f.factors()), 1e-12);
+	}
+}
+
+// Test that the least-squares residual is orthogonal to the columns of A
+TEST(AutAp2024SpringHW1, qr_LeastSquares) {
+	const size_t m = 200, n = 60;
+	auto a = create_matrix<Matrix<double>>(m, n, MatrixType::Random, -1, 1, 13);
+	auto b = create_matrix<Matrix<double>>(m, 3, MatrixType::Random, -1, 1, 14);
+	Matrix<double> x = least_squares(a, b);
+	Matrix<double> residual = multiply(a, x);
+	for (size_t i = 0; i < m; i++)
+		for (size_t j = 0; j < 3; j++) residual(i, j) -= b(i, j);
+	EXPECT_LT(max_abs_diff(multiply(transpose(a), residual), Matrix<double>(n, 3)),
+			  1e-11);
+
+	QR<double> f = qr(a);
+	EXPECT_LT(max_abs_diff(f.apply_q(f.apply_qt(b)), b), 1e-12);
+	EXPECT_LT(max_abs_diff(to_matrix(least_squares(a.to_legacy(), b.to_legacy())),
+						   x), 1e-12);
+
+	Matrix<double> deficient = a;
+	for (size_t i = 0; i < m; i++) deficient(i, 5) = 0;
+	EXPECT_ANY_THROW(least_squares(deficient, b));
+	EXPECT_ANY_THROW(least_squares(transpose(a), b));
+}
+
+TEST(AutAp2024SpringHW1, qr_IndependentOfThreadCount) {
+	auto a = create_matrix<Matrix<double>>(400, 250, MatrixType::Random, -1, 1, 15);
+	set_num_threads(1);
+	QR<double> serial = qr(a);
+	set_num_threads(4);
+	QR<double> parallel = qr(a);
+	set_num_threads(0);
+	EXPECT_EQ(serial.factors(), parallel.factors());
+	EXPECT_EQ(serial.tau(), parallel.tau());
+}
+
+/*
+// "=============================================="
+// "                  GEMV Tests                  "
+// "=============================================="
+*/
+
+// Test A * x and x^T * A against the matrix product, at every SIMD level
+// and for strided operands
+TEST(AutAp2024SpringHW1, gemv_MatchesMultiply) {
+	const size_t m = 301, n = 77;
+	auto a = create_matrix<Matrix<double>>(m, n, MatrixType::Random, -1, 1, 16);
+	auto xv = create_matrix<Matrix<double>>(n, 1, MatrixType::Random, -1, 1, 17);
+	auto xh = create_matrix<Matrix<double>>(1, m, MatrixType::Random, -1, 1, 18);
+	std::vector<double> x(n), xt(m);
+	for (size_t i = 0; i < n; i++) x[i] = xv(i, 0);
+	for (size_t i = 0; i < m; i++) xt[i] = xh(0, i);
+	const Matrix<double> ax = multiply(a, xv), xa = multiply(xh, a);
+
+	for (auto level : {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512,
+					   SimdLevel::NEON}) {
+		set_simd_level(level);
+		std::vector<double> y = gemv(a, x), yt = gevm(xt, a);
+		for (size_t i = 0; i < m; i++) EXPECT_NEAR(y[i], ax(i, 0), 1e-12);
+		for (size_t j = 0; j < n; j++) EXPECT_NEAR(yt[j], xa(0, j), 1e-12);
+		// the transposed view swaps the two kernels
+		EXPECT_EQ(gemv(view(a).transposed(), xt), yt);
+		EXPECT_EQ(gevm(x, view(a).transposed()), y);
+		EXPECT_EQ(gemv(a.to_legacy(), x), y);
+		EXPECT_EQ(gevm(xt, a.to_legacy()), yt);
+	}
+	set_simd_level(detected_simd_level());
+
+	// y = 2 * A * x - y on every other column
+	std::vector<double> y(m, 1.0);
+	gemv_into(view(a).col_range(0, n / 2), x.data(), y.data(), 2.0, -1.0);
+	for (size_t i = 0; i < m; i++) {
+		double dot = 0;
+		for (size_t j = 0; j < n / 2; j++) dot += a(i, j) * x[j];
+		EXPECT_NEAR(y[i], 2 * dot - 1, 1e-12);
+	}
+	EXPECT_ANY_THROW(gemv(a, xt));
+	EXPECT_ANY_THROW(gevm(x, a));
+}
+
+TEST(AutAp2024SpringHW1, gemv_IndependentOfThreadCount) {
+	auto a = create_matrix<Matrix<float>>(3000, 1500, MatrixType::Random, -1, 1, 19);
+	std::vector<float> x(1500, 0.5f), xt(3000, -0.25f);
+	// odd widths put the chunk boundaries off the vector lanes
+	const auto d =
+		create_matrix<Matrix<double>>(300, 5001, MatrixType::Random, -1, 1, 20);
+	const auto legacy =
+		create_matrix<double>(301, 4093, MatrixType::Random, -1, 1, 21);
+	std::vector<double> xd(300), xl(301);
+	random_uniform<double>(22, 0, xd.size(), -1, 1, xd.data());
+	random_uniform<double>(23, 0, xl.size(), -1, 1, xl.data());
+	set_num_threads(1);
+	const auto y = gemv(a, x);
+	const auto yt = gevm(xt, a);
+	const auto yd = gevm(xd, d);
+	const auto yl = gevm(xl, legacy);
+	for (const std::size_t threads : {2, 3, 4}) {
+		SCOPED_TRACE(threads);
+		set_num_threads(threads);
+		EXPECT_EQ(gemv(a, x), y);
+		EXPECT_EQ(gevm(xt, a), yt);
+		EXPECT_EQ(gevm(xd, d), yd);
+		EXPECT_EQ(gevm(xl, legacy), yl);
+	}
+	set_num_threads(0);
+}
+
+/*
+// "=============================================="
+// "            batched multiply Tests            "
+// "=============================================="
+*/
+
+// Test every product of a batch against the fixed-size multiply, and the
+// run-time shape kernel against both at every SIMD level
+TEST(AutAp2024SpringHW1, batched_MatchesFixedMultiply) {
+	const size_t batch = 5000;
+	std::vector<float> fa(batch * 12), fb(batch * 20), fc(batch * 15);
+	random_uniform<float>(20, 0, fa.size(), -1, 1, fa.data());
+	random_uniform<float>(21, 0, fb.size(), -1, 1, fb.data());
+	std::vector<FixedMatrix<float, 3, 4>> a(batch);
+	std::vector<FixedMatrix<float, 4, 5>> b(batch);
+	for (size_t s = 0; s < batch; s++) {
+		std::copy_n(fa.data() + 12 * s, 12, a[s].data());
+		std::copy_n(fb.data() + 20 * s, 20, b[s].data());
+	}
+	auto c = multiply_batched(a, b);
+	auto shared = multiply_batched(a, b[7]);
+	ASSERT_EQ(c.size(), batch);
+	for (size_t s = 0; s < batch; s++) {
+		ASSERT_EQ(c[s], multiply(a[s], b[s]));
+		ASSERT_EQ(shared[s], multiply(a[s], b[7]));
+	}
+	for (auto level : {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512,
+					   SimdLevel::NEON}) {
+		set_simd_level(level);
+		multiply_batched(batch, 3, 5, 4, fa.data(), fb.data(), fc.data());
+		for (size_t s = 0; s < batch; s++)
+			for (size_t e = 0; e < 15; e++)
+				EXPECT_NEAR(fc[15 * s + e], c[s].data()[e], 1e-5);
+	}
+	set_simd_level(detected_simd_level());
+	EXPECT_ANY_THROW(multiply_batched(a, std::vector<FixedMatrix<float, 4, 5>>(3)));
+	EXPECT_TRUE(multiply_batched(decltype(a)(), decltype(b)()).empty());
+}
+
+// Test the strided interface on wider matrices, whose rows span several
+// vectors, and on integers
+TEST(AutAp2024SpringHW1, batched_StridedOperands) {
+	const size_t batch = 64, m = 6, n = 37, k = 9;
+	std::vector<long> a(batch * (m * k + 3)), b(k * n), c(batch * m * n);
+	for (size_t i = 0; i < a.size(); i++) a[i] = long(i % 17) - 8;
+	for (size_t i = 0; i < b.size(); i++) b[i] = long(i % 13) - 6;
+	// A_i padded by three elements, B shared
+	multiply_batched<long>(batch, m, n, k, a.data(), m * k + 3, b.data(), 0,
+						   c.data(), m * n);
+	for (size_t s = 0; s < batch; s++)
+		for (size_t i = 0; i < m; i++)
+			for (size_t j = 0; j < n; j++) {
+				long ref = 0;
+				for (size_t p = 0; p < k; p++)
+					ref += a[s * (m * k + 3) + i * k + p] * b[p * n + j];
+				ASSERT_EQ(c[s * m * n + i * n + j], ref);
+			}
+}
+
+/*
+// "=============================================="
+// "             blocked transpose Tests          "
+// "=============================================="
+*/
+
+// Test the cache-oblivious transpose against element-wise indexing, for
+// shapes around the tile sizes and at every SIMD level
+TEST(AutAp2024SpringHW1, transpose_BlockedMatchesElementwise) {
+	auto check = [](auto value) {
+		using T = decltype(value);
+		for (auto [r, c] : {std::pair<size_t, size_t>{1, 1}, {5, 300}, {300, 5},
+							{64, 64}, {257, 129}, {600, 333}}) {
+			auto a = create_matrix<Matrix<T>>(r, c, MatrixType::Random, T(-100),
+											  T(100), r * c);
+			Matrix<T> res = transpose(a);
+			ASSERT_EQ(matrix_size(res), std::make_pair(c, r));
+			for (size_t i = 0; i < r; i++)
+				for (size_t j = 0; j < c; j++) ASSERT_EQ(res(j, i), a(i, j));
+			// a transposed view is copied through the same kernel
+			EXPECT_EQ(to_matrix(view(a).transposed()), res);
+			EXPECT_EQ(transpose(a.to_legacy()), res.to_legacy());
+		}
+	};
+	for (auto level : {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512,
+					   SimdLevel::NEON}) {
+		set_simd_level(level);
+		check(float());
+		check(double());
+		check(int());
+		check(std::int64_t());
+		check(short());
+	}
+	set_simd_level(detected_simd_level());
+}
+
+TEST(AutAp2024SpringHW1, transpose_InPlaceSquare) {
+	for (size_t n : {1, 7, 63, 64, 65, 300}) {
+		auto a = create_matrix<Matrix<double>>(n, n, MatrixType::Random, -1, 1, n);
+		Matrix<double> b = a;
+		transpose_inplace(b);
+		EXPECT_EQ(b, transpose(a)) << n;
+		transpose_inplace(b);
+		EXPECT_EQ(b, a) << n;
+	}
+	Matrix<int> rectangle(3, 4);
+	EXPECT_ANY_THROW(transpose_inplace(rectangle));
+}
+
+// Test the cycle-following transpose of dense arrays, with element types
+// that are moved rather than copied
+TEST(AutAp2024SpringHW1, transpose_DenseInPlace) {
+	for (auto [r, c] : {std::pair<size_t, size_t>{1, 9}, {9, 1}, {2, 3},
+						{37, 101}, {128, 64}, {500, 333}}) {
+		std::vector<long> a(r * c), t(r * c);
+		for (size_t i = 0; i < a.size(); i++) a[i] = long(i * 7919 % 1009);
+		for (size_t i = 0; i < r; i++)
+			for (size_t j = 0; j < c; j++) t[j * r + i] = a[i * c + j];
+		transpose_dense_inplace(r, c, a.data());
+		EXPECT_EQ(a, t) << r << "x" << c;
+	}
+	std::vector<std::string> words = {"a", "b", "c", "d", "e", "f"};
+	transpose_dense_inplace(2, 3, words.data());
+	EXPECT_EQ(words, (std::vector<std::string>{"a", "d", "b", "e", "c", "f"}));
+}
+
+/*
+// "=============================================="
+// "             structured matrix Tests          "
+// "=============================================="
+*/
+
+// Dense copy of `m` with the elements outside keep(i, j) zeroed
+template <typename T, typename F>
+MATRIX<T> structured_mask(MATRIX<T> m, F keep) {
+	for (size_t i = 0; i < m.size(); i++)
+		for (size_t j = 0; j < m[i].size(); j++)
+			if (!keep(i, j)) m[i][j] = 0;
+	return m;
+}
+
+// Test conversions and element access of the four storage types
+TEST(AutAp2024SpringHW1, structured_Conversions) {
+	MATRIX<int> a = create_matrix<int>(6, 6, MatrixType::Random, 1, 9);
+	auto band = [](size_t i, size_t j) { return j + 1 >= i and j <= i + 2; };
+
+	DiagonalMatrix<int> d(a);
+	EXPECT_EQ(d.nnz(), 6);
+	EXPECT_EQ(d.to_legacy(), structured_mask(a, std::equal_to<size_t>{}));
+	EXPECT_EQ(d(2, 3), 0);
+	EXPECT_ANY_THROW(d.at(2, 3));
+	d.at(2, 2) = 100;
+	EXPECT_EQ(d(2, 2), 100);
+
+	TriangularMatrix<int> l(a), u(to_matrix(a), Triangle::Upper);
+	EXPECT_EQ(l.nnz(), 21);
+	EXPECT_EQ(l.to_legacy(), structured_mask(a, std::greater_equal<size_t>{}));
+	EXPECT_EQ(u.to_matrix().to_legacy(),
+			  structured_mask(a, std::less_equal<size_t>{}));
+	EXPECT_EQ(u(5, 0), 0);
+	EXPECT_EQ(u(0, 5), a[0][5]);
+	EXPECT_ANY_THROW(u.at(5, 0));
+	EXPECT_ANY_THROW(u.at(0, 6));
+
+	// only the lower triangle is read
+	SymmetricMatrix<int> s(a);
+	EXPECT_EQ(s(1, 4), a[4][1]);
+	s.at(1, 4) = -1;
+	EXPECT_EQ(s(4, 1), -1);
+	MATRIX<int> sym = s.to_legacy();
+	EXPECT_EQ(sym, transpose(sym));
+	EXPECT_EQ(s.to_matrix().to_legacy(), sym);
+
+	BandMatrix<int> b(a, 1, 2);
+	EXPECT_EQ(b.nnz(), 6 * 4);
+	EXPECT_EQ(b.to_legacy(), structured_mask(a, band));
+	EXPECT_EQ(b.to_matrix().to_legacy(), structured_mask(a, band));
+	EXPECT_ANY_THROW(b.at(0, 3));
+	EXPECT_EQ(BandMatrix<int>(3, 2, 10, 10).lower_bandwidth(), 2);
+	EXPECT_EQ(BandMatrix<int>(3, 2, 10, 10).upper_bandwidth(), 1);
+	EXPECT_ANY_THROW(TriangularMatrix<int>(MATRIX<int>(2, std::vector<int>(3))));
+	// ragged rows, shorter or longer than the first
+	const MATRIX<int> shorter{{1, 2, 3}, {4}, {5, 6, 7}};
+	const MATRIX<int> longer{{1, 2}, {3, 4, 0, 0}};
+	EXPECT_ANY_THROW(DiagonalMatrix<int>{shorter});
+	EXPECT_ANY_THROW(TriangularMatrix<int>(shorter, Triangle::Upper));
+	EXPECT_ANY_THROW(SymmetricMatrix<int>{longer});
+	EXPECT_ANY_THROW(BandMatrix<int>(longer, 1, 1));
+}
+
+// Test structured x dense and structure-preserving products against dense
+// ones
+TEST(AutAp2024SpringHW1, structured_Multiply) {
+	for (size_t threads : {1, 4}) {
+		set_num_threads(threads);
+		MATRIX<int> a = create_matrix<int>(150, 150, MatrixType::Random, -9, 9);
+		MATRIX<int> c = create_matrix<int>(150, 150, MatrixType::Random, -9, 9);
+		MATRIX<int> b = create_matrix<int>(150, 70, MatrixType::Random, -9, 9);
+		const Matrix<int> mb = to_matrix(b);
+
+		DiagonalMatrix<int> d(a);
+		TriangularMatrix<int> l(a), u(a, Triangle::Upper);
+		SymmetricMatrix<int> s(a);
+		BandMatrix<int> band(a, 3, 1);
+		EXPECT_EQ(multiply(d, b), multiply(d.to_legacy(), b));
+		EXPECT_EQ(multiply(l, mb).to_legacy(), multiply(l.to_legacy(), b));
+		EXPECT_EQ(multiply(u, b), multiply(u.to_legacy(), b));
+		EXPECT_EQ(multiply(s, mb).to_legacy(), multiply(s.to_legacy(), b));
+		EXPECT_EQ(multiply(s, b), multiply(s.to_legacy(), b));
+		EXPECT_EQ(multiply(band, mb).to_legacy(), multiply(band.to_legacy(), b));
+
+		DiagonalMatrix<int> d2(c);
+		EXPECT_EQ(multiply(d, d2).to_legacy(),
+				  multiply(d.to_legacy(), d2.to_legacy()));
+		for (Triangle t : {Triangle::Lower, Triangle::Upper}) {
+			TriangularMatrix<int> ta(a, t), tc(c, t);
+			EXPECT_EQ(multiply(ta, tc).to_legacy(),
+					  multiply(ta.to_legacy(), tc.to_legacy()));
+		}
+		// rectangular bands: 150 x 120 times 120 x 90
+		MATRIX<int> r1 = create_matrix<int>(150, 120, MatrixType::Random, -9, 9);
+		MATRIX<int> r2 = create_matrix<int>(120, 90, MatrixType::Random, -9, 9);
+		BandMatrix<int> b1(r1, 2, 5), b2(r2, 4, 0);
+		BandMatrix<int> p = multiply(b1, b2);
+		EXPECT_EQ(p.lower_bandwidth(), 6);
+		EXPECT_EQ(p.upper_bandwidth(), 5);
+		EXPECT_EQ(p.to_legacy(), multiply(b1.to_legacy(), b2.to_legacy()));
+	}
+	set_num_threads(0);
+	MATRIX<int> a = create_matrix<int>(4, 4, MatrixType::Random, -9, 9);
+	EXPECT_ANY_THROW(multiply(TriangularMatrix<int>(a),
+							  TriangularMatrix<int>(a, Triangle::Upper)));
+	EXPECT_ANY_THROW(multiply(BandMatrix<int>(a, 1, 1), MATRIX<int>(3, {1})));
+	EXPECT_ANY_THROW(multiply(DiagonalMatrix<int>(3), DiagonalMatrix<int>(4)));
+	const MATRIX<int> ragged{{1, 2, 3}, {4}, {5, 6, 7}};
+	EXPECT_ANY_THROW(multiply(TriangularMatrix<int>(3), ragged));
+	EXPECT_ANY_THROW(multiply(SymmetricMatrix<int>(3), ragged));
+}
+
+// Test transpose, trace and triangular solves
+TEST(AutAp2024SpringHW1, structured_TransposeTraceSolve) {
+	MATRIX<double> a = create_matrix<double>(200, 200, MatrixType::Random, 1, 2);
+	TriangularMatrix<double> l(a), u(a, Triangle::Upper);
+	BandMatrix<double> band(a, 2, 4);
+	EXPECT_EQ(transpose(l).triangle(), Triangle::Upper);
+	EXPECT_EQ(transpose(l).to_legacy(), transpose(l.to_legacy()));
+	EXPECT_EQ(transpose(u).to_legacy(), transpose(u.to_legacy()));
+	EXPECT_EQ(transpose(band).to_legacy(), transpose(band.to_legacy()));
+	EXPECT_EQ(transpose(SymmetricMatrix<double>(a)).to_legacy(),
+			  SymmetricMatrix<double>(a).to_legacy());
+	EXPECT_DOUBLE_EQ(trace(l), trace(a));
+	EXPECT_DOUBLE_EQ(trace(band), trace(a));
+	EXPECT_DOUBLE_EQ(trace(DiagonalMatrix<double>(a)), trace(a));
+	EXPECT_DOUBLE_EQ(trace(SymmetricMatrix<double>(a)), trace(a));
+	EXPECT_ANY_THROW(trace(BandMatrix<double>(3, 4, 1, 1)));
+
+	// make the diagonal dominant so the substitutions stay accurate
+	for (size_t i = 0; i < a.size(); i++) a[i][i] = 300;
+	const Matrix<double> b =
+		create_matrix<Matrix<double>>(200, 90, MatrixType::Random, -1, 1, 5);
+	auto check = [&](const auto& m) {
+		const Matrix<double> x = solve(m, b);
+		EXPECT_LT(max_abs_diff(multiply(m, x), b), 1e-12);
+	};
+	check(TriangularMatrix<double>(a));
+	check(TriangularMatrix<double>(a, Triangle::Upper));
+	check(DiagonalMatrix<double>(a));
+	check(BandMatrix<double>(a, 3, 0));
+	check(BandMatrix<double>(a, 0, 5));
+	set_num_threads(1);
+	const Matrix<double> serial = solve(TriangularMatrix<double>(a), b);
+	set_num_threads(4);
+	EXPECT_EQ(solve(TriangularMatrix<double>(a), b), serial);
+	set_num_threads(0);
+	EXPECT_ANY_THROW(solve(BandMatrix<double>(a, 1, 1), b));
+	EXPECT_ANY_THROW(solve(TriangularMatrix<double>(200), b));
+	EXPECT_ANY_THROW(solve(TriangularMatrix<double>(a), Matrix<double>(3, 3)));
+}
+
+/*
+// "=============================================="
+// "              matrix chain Tests              "
+// "=============================================="
+*/
+
+// Test the planner on the textbook chain and with a custom cost model
+TEST(AutAp2024SpringHW1, chain_Plan) {
+	const ChainPlan plan = plan_chain({30, 35, 15, 5, 10, 20, 25});
+	EXPECT_EQ(plan.to_string(), "((0 (1 2)) ((3 4) 5))");
+	EXPECT_DOUBLE_EQ(plan.cost, 2 * 15125);
+	EXPECT_EQ(plan_chain({4, 7}).to_string(), "0");
+	EXPECT_DOUBLE_EQ(plan_chain({4, 7}).cost, 0);
+	// a measured model in which wide results are cheap flips the order
+	const ChainPlan measured =
+		plan_chain({10, 1000, 10, 1000}, [](size_t m, size_t k, size_t n) {
+			return n == 1000 ? 1.0 : chain_flops(m, k, n);
+		});
+	EXPECT_EQ(measured.to_string(), "(0 (1 2))");
+	EXPECT_DOUBLE_EQ(measured.cost, 2);
+	EXPECT_EQ(plan_chain({10, 1000, 10, 1000}).to_string(), "((0 1) 2)");
+	EXPECT_ANY_THROW(plan_chain({3}));
+}
+
+// Test that the planned product equals the left-to-right one
+TEST(AutAp2024SpringHW1, chain_MultiplyMatchesLeftToRight) {
+	MATRIX<int> a = create_matrix<int>(40, 300, MatrixType::Random, -3, 3);
+	MATRIX<int> b = create_matrix<int>(300, 5, MatrixType::Random, -3, 3);
+	MATRIX<int> c = create_matrix<int>(5, 200, MatrixType::Random, -3, 3);
+	MATRIX<int> d = create_matrix<int>(200, 2, MatrixType::Random, -3, 3);
+	const MATRIX<int> expected = multiply(multiply(multiply(a, b), c), d);
+	EXPECT_EQ(multiply_chain(std::vector<MATRIX<int>>{a, b, c, d}), expected);
+
+	const Matrix<int> ma = to_matrix(a), mb = to_matrix(b), mc = to_matrix(c);
+	const Matrix<int> dt = to_matrix(transpose(d));
+	EXPECT_EQ(multiply_chain(ma, mb, mc, view(dt).transposed()).to_legacy(),
+			  expected);
+	EXPECT_EQ(multiply_chain(std::vector<MatrixView<int>>{view(ma)}), ma);
+	EXPECT_ANY_THROW(multiply_chain(ma, mc));
+	EXPECT_ANY_THROW(multiply_chain(std::vector<MATRIX<int>>{a, c}));
+	EXPECT_ANY_THROW(multiply_chain(std::vector<MATRIX<int>>{}));
+}
+
+/*
+// "=============================================="
+// "                 tuning Tests                 "
+// "=============================================="
+*/
+
+// Test that tuning files round-trip and only load on the host that wrote
+// them
+TEST(AutAp2024SpringHW1, tune_CacheFile) {
+	const std::string path = temp_matrix_path("tuning.txt");
+	const Tuning t{.gemm4 = {64, 256, 1024},
+				   .gemm8 = {48, 128, 512},
+				   .gemm_min_ops = 4096,
+				   .parallel_min_elements = 1 << 14,
+				   .transpose_leaf_bytes = 8192,
+				   .threads = 2};
+	save_tuning(t, path);
+	EXPECT_EQ(load_tuning(path), t);
+
+	std::ifstream in(path);
+	std::string text, line;
+	while (std::getline(in, line))
+		text += (line.starts_with("host ") ? "host elsewhere" : line) + "\n";
+	in.close();
+	std::ofstream(path) << text;
+	EXPECT_EQ(load_tuning(path), std::nullopt);
+
+	// values the kernels cannot use load as the defaults
+	const Tuning bad{.gemm4 = {0, 256, 1024},
+					 .gemm8 = {50, 128, 513},
+					 .gemm_min_ops = 4096,
+					 .parallel_min_elements = 1 << 14,
+					 .transpose_leaf_bytes = 1,
+					 .threads = 1 << 20};
+	save_tuning(bad, path);
+	EXPECT_EQ(load_tuning(path), (Tuning{.gemm_min_ops = 4096,
+										 .parallel_min_elements = 1 << 14}));
+
+	std::ofstream(path) << "gemm4 1 2 3\n";
+	EXPECT_ANY_THROW(load_tuning(path));
+	std::filesystem::remove(path);
+	EXPECT_EQ(load_tuning(path), std::nullopt);
+}
+
+// Test that the kernels dispatch through the current tuning and that any
+// tuning gives the same results
+TEST(AutAp2024SpringHW1, tune_Dispatch) {
+	const MATRIX<int> a = create_matrix<int>(70, 90, MatrixType::Random, -9, 9);
+	const MATRIX<int> b = create_matrix<int>(90, 60, MatrixType::Random, -9, 9);
+	const MATRIX<int> expected = multiply(a, b);
+	const auto d =
+		create_matrix<Matrix<double>>(300, 200, MatrixType::Random, -1, 1, 7);
+
+	set_tuning({.gemm4 = {8, 16, 32},
+				.gemm8 = {4, 8, 16},
+				.gemm_min_ops = 1,
+				.parallel_min_elements = 64,
+				.transpose_leaf_bytes = 256,
+				.threads = 3});
+	set_num_threads(0);
+	EXPECT_EQ(get_num_threads(), 3);
+	EXPECT_EQ(gemm_blocking<float>(), (GemmBlocking{8, 16, 32}));
+	EXPECT_EQ(gemm_blocking<short>(), GemmTraits<short>::blocking);
+	EXPECT_EQ(parallel_min_elements(), 64);
+	EXPECT_EQ(multiply(a, b), expected);
+	EXPECT_EQ(multiply(to_matrix(a), to_matrix(b)).to_legacy(), expected);
+	EXPECT_EQ(transpose(d), to_matrix(view(d).transposed()));
+
+	const Tuning measured = tune({.save = false, .quick = true});
+	EXPECT_EQ(tuning(), measured);
+	EXPECT_NE(measured.gemm4.mc * measured.gemm8.kc * measured.gemm8.nc, 0);
+	EXPECT_NE(measured.gemm_min_ops * measured.parallel_min_elements, 0);
+	EXPECT_NE(measured.transpose_leaf_bytes * measured.threads, 0);
+	EXPECT_EQ(get_num_threads(), measured.threads);
+	EXPECT_EQ(multiply(a, b), expected);
+
+	set_tuning({});
+	set_num_threads(0);
+	EXPECT_EQ(parallel_min_elements(), PARALLEL_MIN_ELEMENTS);
+}
+
+/*
+// "=============================================="
+// "                 arena Tests                  "
+// "=============================================="
+*/
+
+// Test that temporaries made inside a scope come from the arena and that
+// the arena rewinds and reuses its chunks once they are gone
+TEST(AutAp2024SpringHW1, arena_ScopeReusesMemory) {
+	const auto a =
+		create_matrix<Matrix<double>>(40, 30, MatrixType::Random, -1, 1, 3);
+	const auto b =
+		create_matrix<Matrix<double>>(30, 20, MatrixType::Random, -1, 1, 4);
+	const Matrix<double> expected = sum_sub(multiply(a, b), multiply(a, b));
+
+	MatrixArena arena(4096);
+	std::size_t chunks = 0;
+	for (int iteration = 0; iteration < 3; iteration++) {
+		ArenaScope scope(arena);
+		const Matrix<double> p = multiply(a, b);
+		const Matrix<double> q = transpose(transpose(p));
+		const Matrix<double> r = sum_sub(p, q);
+		EXPECT_EQ(p.arena(), &arena);
+		EXPECT_EQ(r.arena(), &arena);
+		EXPECT_EQ(reinterpret_cast<std::uintptr_t>(r.data()) % 64, 0);
+		EXPECT_EQ(r, expected);
+		if (iteration == 0) chunks = arena.stats().chunks;
+	}
+	EXPECT_EQ(Matrix<double>(2, 2).arena(), nullptr);
+
+	const ArenaStats stats = arena.stats();
+	EXPECT_EQ(stats.chunks, chunks);
+	EXPECT_EQ(stats.live_bytes, 0);
+	EXPECT_EQ(stats.rewinds, 3);
+	EXPECT_GE(stats.allocations, 9);
+	EXPECT_GE(stats.bytes_reused * 3, stats.bytes_allocated * 2);
+	EXPECT_GE(stats.peak_bytes, 3 * 40 * 24 * sizeof(double));
+	EXPECT_GE(stats.bytes_reserved, stats.peak_bytes);
+
+	arena.reset_stats();
+	EXPECT_EQ(arena.stats().allocations, 0);
+	arena.release();
+	EXPECT_EQ(arena.stats().bytes_reserved, 0);
+}
+
+// Test that matrices keep the arena they were allocated from across moves,
+// that copies and nested scopes pick the current one, and that release()
+// refuses while matrices are alive
+TEST(AutAp2024SpringHW1, arena_OwnershipAndScopes) {
+	MatrixArena outer, inner;
+	Matrix<int> kept;
+	{
+		ArenaScope scope(outer);
+		Matrix<int> m{{1, 2}, {3, 4}};
+		{
+			ArenaScope nested(inner);
+			EXPECT_EQ(current_arena(), &inner);
+			const Matrix<int> copy(m);
+			EXPECT_EQ(copy.arena(), &inner);
+			EXPECT_EQ(copy, m);
+		}
+		EXPECT_EQ(current_arena(), &outer);
+		EXPECT_EQ(inner.stats().live_bytes, 0);
+		kept = std::move(m);
+	}
+	EXPECT_EQ(current_arena(), nullptr);
+	EXPECT_EQ(kept.arena(), &outer);
+	EXPECT_EQ(kept, (Matrix<int>{{1, 2}, {3, 4}}));
+	EXPECT_ANY_THROW(outer.release());
+
+	Matrix<int> heap(kept);
+	EXPECT_EQ(heap.arena(), nullptr);
+	kept = Matrix<int>();
+	EXPECT_EQ(outer.stats().live_bytes, 0);
+	EXPECT_NO_THROW(outer.release());
+	EXPECT_EQ(heap, (Matrix<int>{{1, 2}, {3, 4}}));
+}
+
+/*
+// "=============================================="
+// "                 fused Tests                  "
+// "=============================================="
+*/
+
+// Test gemm() against the unfused sequence on both the small and the
+// blocked path, with a positional epilogue and on views and legacy matrices
+TEST(AutAp2024SpringHW1, fused_GemmMatchesUnfused) {
+	for (const std::size_t n : {5, 70}) {
+		const auto a =
+			create_matrix<Matrix<int>>(n, n + 20, MatrixType::Random, -9, 9, 1);
+		const auto b =
+			create_matrix<Matrix<int>>(n + 20, n - 2, MatrixType::Random, -9, 9, 2);
+		const auto c0 =
+			create_matrix<Matrix<int>>(n, n - 2, MatrixType::Random, -9, 9, 3);
+		const auto relu_bias = [](int v, std::size_t i, std::size_t j) {
+			return std::max(v + int(i) - int(j), 0);
+		};
+		Matrix<int> expected =
+			sum_sub(multiply(multiply(a, b), 3), multiply(c0, -2));
+		for (std::size_t i = 0; i < expected.rows(); i++)
+			for (std::size_t j = 0; j < expected.cols(); j++)
+				expected(i, j) = relu_bias(expected(i, j), i, j);
+
+		Matrix<int> c = c0;
+		gemm(3, a, b, -2, c, relu_bias);
+		EXPECT_EQ(c, expected);
+
+		// A read through a transposed view, C through a strided block
+		const Matrix<int> at = transpose(a);
+		Matrix<int> wide(n, 2 * n);
+		copy(c0, span(wide).col_range(n, 2 * n - 2));
+		gemm(3, view(at).transposed(), b, -2, span(wide).col_range(n, 2 * n - 2),
+			 relu_bias);
+		EXPECT_EQ(to_matrix(view(wide).col_range(n, 2 * n - 2)), expected);
+
+		MATRIX<int> legacy = c0.to_legacy();
+		gemm(3, a.to_legacy(), b.to_legacy(), -2, legacy, relu_bias);
+		EXPECT_EQ(legacy, expected.to_legacy());
+	}
+}
+
+// Test the floating-point paths, that C is not read when beta is 0 and the
+// argument checks
+TEST(AutAp2024SpringHW1, fused_GemmBetaAndErrors) {
+	const auto a =
+		create_matrix<Matrix<double>>(90, 60, MatrixType::Random, -1, 1, 4);
+	const auto b =
+		create_matrix<Matrix<double>>(60, 80, MatrixType::Random, -1, 1, 5);
+	const Matrix<double> ab = multiply(a, b);
+	for (const int threads : {1, 4}) {
+		set_num_threads(threads);
+		Matrix<double> c(90, 80, std::numeric_limits<double>::quiet_NaN());
+		gemm(0.5, a, b, 0.0, c, [](double v) { return std::tanh(v); });
+		for (std::size_t i = 0; i < c.rows(); i++)
+			for (std::size_t j = 0; j < c.cols(); j++)
+				EXPECT_NEAR(c(i, j), std::tanh(0.5 * ab(i, j)), 1e-12);
+
+		Matrix<double> d = ab;
+		gemm(1.0, a, b, -1.0, d);
+		for (std::size_t i = 0; i < d.rows(); i++)
+			for (std::size_t j = 0; j < d.cols(); j++)
+				EXPECT_NEAR(d(i, j), 0.0, 1e-12);
+	}
+	set_num_threads(0);
+
+	Matrix<double> c(90, 80);
+	EXPECT_ANY_THROW(gemm(1.0, a, a, 0.0, c));
+	Matrix<double> small(80, 90);
+	EXPECT_ANY_THROW(gemm(1.0, a, b, 0.0, small));
+	EXPECT_ANY_THROW(gemm(1.0, Matrix<double>(), b, 0.0, c));
+}
+
+/*
+// "=============================================="
+// "             low precision Tests              "
+// "=============================================="
+*/
+
+// Test bfloat16 rounding and the int8 scales of both granularities
+TEST(AutAp2024SpringHW1, quantized_Conversions) {
+	EXPECT_EQ(float(BFloat16(-2.5f)), -2.5f);
+	EXPECT_EQ(float(BFloat16(1 + 0x1p-8f)), 1.0f);  // tie to even
+	EXPECT_EQ(float(BFloat16(1 + 0x3p-8f)), 1 + 0x1p-6f);
+	EXPECT_EQ(BFloat16(-0x1.fep127f).bits, 0xff7f);
+	EXPECT_TRUE(std::isnan(float(BFloat16(std::nanf("")))));
+	EXPECT_TRUE(std::isinf(float(BFloat16(HUGE_VALF))));
+
+	const MATRIX<double> m{{1.0, -0.5, 0.25}, {100.0, 20.0, -50.0}};
+	const BFloat16Matrix h(m);
+	EXPECT_EQ(h.to_legacy<double>(), m);
+
+	const QuantizedMatrix rows(m);
+	EXPECT_FLOAT_EQ(rows.scale(0), 1.0f / 127);
+	EXPECT_FLOAT_EQ(rows.scale(1), 100.0f / 127);
+	EXPECT_EQ(rows(0, 0), 127);
+	EXPECT_EQ(rows(1, 2), -64);
+	const QuantizedMatrix tensor(to_matrix(m), QuantScale::PerTensor);
+	EXPECT_EQ(tensor(0, 0), 1);
+	EXPECT_EQ(tensor(1, 0), 127);
+	for (std::size_t i = 0; i < 2; i++)
+		for (std::size_t j = 0; j < 3; j++) {
+			EXPECT_NEAR(rows.value(i, j), m[i][j], rows.scale(i) / 2);
+			EXPECT_NEAR(tensor.value(i, j), m[i][j], tensor.scale(i) / 2);
+			EXPECT_EQ(tensor.transposed()(j, i), tensor(i, j));
+		}
+	EXPECT_ANY_THROW(rows.transposed());
+}
+
+// Test that every int8 kernel gives the exact int32 product, scaled once
+TEST(AutAp2024SpringHW1, quantized_Int8Multiply) {
+	const auto a =
+		create_matrix<Matrix<float>>(37, 70, MatrixType::Random, -3, 3, 1);
+	const auto b =
+		create_matrix<Matrix<float>>(70, 29, MatrixType::Random, -2, 2, 2);
+	const QuantizedMatrix qa(a), qb(b, QuantScale::PerTensor);
+	const QuantizedMatrix qbt(transpose(b));  // a scale per output column
+	Matrix<float> expected(37, 29), expected_t(37, 29);
+	for (std::size_t i = 0; i < 37; i++)
+		for (std::size_t j = 0; j < 29; j++) {
+			std::int32_t dot = 0, dot_t = 0;
+			for (std::size_t p = 0; p < 70; p++) {
+				dot += qa(i, p) * qb(p, j);
+				dot_t += qa(i, p) * qbt(j, p);
+			}
+			expected(i, j) = float(dot) * (qa.scale(i) * qb.scale(0));
+			expected_t(i, j) = float(dot_t) * (qa.scale(i) * qbt.scale(j));
+		}
+	const Matrix<float> exact = multiply(a, b);
+
+	for (const SimdLevel level :
+		 {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512}) {
+		set_simd_level(level);
+		SCOPED_TRACE(int8_kernel_name());
+		EXPECT_EQ(multiply(qa, qb), expected);
+		const Matrix<float> c = multiply_transposed(qa, qbt);
+		EXPECT_EQ(c, expected_t);
+		for (std::size_t i = 0; i < 37; i++)
+			for (std::size_t j = 0; j < 29; j++)
+				EXPECT_NEAR(c(i, j), exact(i, j), 0.5);
+	}
+	set_simd_level(detected_simd_level());
+
+	// several tiles and panels over the pool
+	const auto big =
+		create_matrix<Matrix<float>>(150, 1100, MatrixType::Random, -1, 1, 3);
+	const QuantizedMatrix qbig(big);
+	const QuantizedMatrix qbig_t(transpose(big), QuantScale::PerTensor);
+	set_num_threads(1);
+	const Matrix<float> one = multiply(qbig, qbig_t);
+	set_num_threads(4);
+	EXPECT_EQ(multiply(qbig, qbig_t), one);
+	set_num_threads(0);
+
+	EXPECT_ANY_THROW(multiply(qa, qa));
+	EXPECT_ANY_THROW(multiply(qa, QuantizedMatrix(b)));
+}
+
+// Test the bf16 kernels against a double product of the same bf16 values
+TEST(AutAp2024SpringHW1, quantized_Bf16Multiply) {
+	const auto a =
+		create_matrix<Matrix<double>>(45, 333, MatrixType::Random, -1, 1, 4);
+	const auto b =
+		create_matrix<Matrix<double>>(333, 21, MatrixType::Random, -1, 1, 5);
+	const BFloat16Matrix ha(a), hb(b);
+	for (const SimdLevel level :
+		 {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512}) {
+		set_simd_level(level);
+		SCOPED_TRACE(bf16_kernel_name());
+		const Matrix<float> c = multiply(ha, hb);
+		EXPECT_EQ(multiply_transposed(ha, hb.transposed()), c);
+		for (std::size_t i = 0; i < 45; i++)
+			for (std::size_t j = 0; j < 21; j++) {
+				double dot = 0;
+				for (std::size_t p = 0; p < 333; p++)
+					dot += double(float(ha(i, p))) * double(float(hb(p, j)));
+				EXPECT_NEAR(c(i, j), dot, 1e-4);
+			}
+	}
+	set_simd_level(detected_simd_level());
+	EXPECT_ANY_THROW(multiply(ha, ha));
+}
+
+/*
+// "=============================================="
+// "               reduction Tests                "
+// "=============================================="
+*/
+
+// Test every reduction on a small matrix in each storage and summation
+TEST(AutAp2024SpringHW1, reduction_SumsAndNorms) {
+	const MATRIX<double> legacy{{1, -2, 3}, {-4, 5, -6}};
+	const Matrix<double> m(legacy);
+	const MatrixView<double> t = view(m).transposed();
+	for (const Summation mode :
+		 {Summation::Plain, Summation::Pairwise, Summation::Kahan}) {
+		EXPECT_EQ(sum(legacy, mode), -3);
+		EXPECT_EQ(sum(m, mode), -3);
+		EXPECT_EQ(sum(t, mode), -3);
+		EXPECT_EQ(row_sums(m, mode), (std::vector<double>{2, -5}));
+		EXPECT_EQ(col_sums(legacy, mode), (std::vector<double>{-3, 3, -3}));
+		EXPECT_EQ(row_sums(t, mode), (std::vector<double>{-3, 3, -3}));
+		EXPECT_EQ(col_sums(t, mode), (std::vector<double>{2, -5}));
+		EXPECT_EQ(norm_1(m, mode), 9);
+		EXPECT_EQ(norm_inf(m, mode), 15);
+		EXPECT_EQ(norm_1(t, mode), 15);
+		EXPECT_EQ(dot(m, legacy, mode), 91);
+		EXPECT_EQ(dot(t, t, mode), 91);
+		EXPECT_DOUBLE_EQ(frobenius_norm(view(m).block(0, 1, 2, 2), mode),
+						 std::sqrt(4.0 + 9 + 25 + 36));
+		EXPECT_EQ(trace(view(m).block(0, 1, 2, 2), mode), -8);
+	}
+	const Matrix<int> ints{{3, 4}};
+	EXPECT_EQ(sum(ints), 7);
+	EXPECT_DOUBLE_EQ(frobenius_norm(ints), 5);
+
+	EXPECT_ANY_THROW(sum(Matrix<double>()));
+	EXPECT_ANY_THROW(norm_1(MATRIX<double>{}));
+	EXPECT_ANY_THROW(dot(m, t));
+	EXPECT_ANY_THROW(trace(m, Summation::Kahan));
+}
+
+// Test the compensated modes on a long sum, and that no mode depends on the
+// thread count
+TEST(AutAp2024SpringHW1, reduction_CompensationAndThreads) {
+	const auto m =
+		create_matrix<Matrix<float>>(1500, 700, MatrixType::Random, 0, 1, 7);
+	double exact = 0, exact_squares = 0;
+	std::vector<double> exact_cols(700, 0);
+	for (std::size_t i = 0; i < 1500; i++)
+		for (std::size_t j = 0; j < 700; j++) {
+			exact += m(i, j);
+			exact_squares += double(m(i, j)) * m(i, j);
+			exact_cols[j] += m(i, j);
+		}
+	for (const SimdLevel level :
+		 {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512}) {
+		set_simd_level(level);
+		EXPECT_LT(std::abs(sum(m, Summation::Kahan) - exact), 1e-7 * exact);
+		EXPECT_LT(std::abs(dot(m, m, Summation::Kahan) - exact_squares),
+				  1e-7 * exact_squares);
+	}
+	set_simd_level(detected_simd_level());
+	EXPECT_LT(std::abs(sum(m, Summation::Pairwise) - exact), 1e-6 * exact);
+	const std::vector<float> cols = col_sums(m, Summation::Kahan);
+	for (std::size_t j = 0; j < 700; j++)
+		EXPECT_NEAR(cols[j], exact_cols[j], 1e-6 * exact_cols[j]);
+
+	const MatrixView<float> t = view(m).transposed();
+	for (const Summation mode :
+		 {Summation::Plain, Summation::Pairwise, Summation::Kahan}) {
+		set_num_threads(1);
+		const float s = sum(m, mode), d = dot(m, t.transposed(), mode);
+		const std::vector<float> rs = row_sums(m, mode), cs = col_sums(m, mode);
+		const float n1 = norm_1(t, mode);
+		set_num_threads(4);
+		EXPECT_EQ(sum(m, mode), s);
+		EXPECT_EQ(dot(m, t.transposed(), mode), d);
+		EXPECT_EQ(row_sums(m, mode), rs);
+		EXPECT_EQ(col_sums(m, mode), cs);
+		EXPECT_EQ(norm_1(t, mode), n1);
+		EXPECT_EQ(row_sums(t, mode), cs);
+	}
+	set_num_threads(0);
+}
+
+// Test the positions of the extremes, with ties and NaNs
+TEST(AutAp2024SpringHW1, reduction_MinMax) {
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+	const Matrix<double> m{{nan, 2, -1}, {7, -1, 7}};
+	EXPECT_EQ(matrix_min(m), (MatrixExtremum<double>{-1, 0, 2}));
+	EXPECT_EQ(matrix_max(m), (MatrixExtremum<double>{7, 1, 0}));
+	EXPECT_EQ(matrix_max(view(m).transposed()),
+			  (MatrixExtremum<double>{7, 0, 1}));
+	EXPECT_EQ(matrix_min(MATRIX<int>{{4, 2}, {2, 9}}),
+			  (MatrixExtremum<int>{2, 0, 1}));
+	EXPECT_TRUE(std::isnan(matrix_min(Matrix<double>{{nan}}).value));
+
+	auto big = create_matrix<Matrix<float>>(900, 300, MatrixType::Random, -1,
+											1, 8);
+	big(811, 17) = 5;
+	big(601, 250) = -5;
+	EXPECT_EQ(matrix_max(big), (MatrixExtremum<float>{5, 811, 17}));
+	EXPECT_EQ(matrix_min(big), (MatrixExtremum<float>{-5, 601, 250}));
+	EXPECT_ANY_THROW(matrix_max(Matrix<float>()));
+}